@@ -0,0 +1,65 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "benchutils.h"
+#include "pv.h"
+#include "quality.h"
+
+#define SAMPLERATE 48000
+#define SECONDS 6
+#define BLOCK 256
+
+/**
+ * Harmonic tone with vibrato, a slow sweep, and a decaying burst every half
+ * second.
+ */
+static void make_input(std::vector<double> *in, int L) {
+    bench_make_tones(in, L, SAMPLERATE);
+
+    for (int n = 0; n < L; ++n) {
+        double t = n / (double)SAMPLERATE;
+
+        if (n % (SAMPLERATE / 2) < 200) {
+            (*in)[n] += 0.3 * sin(2 * M_PI * 3000 * t) *
+                        (1 - (n % (SAMPLERATE / 2)) / 200.0);
+        }
+    }
+}
+
+static void report(const char *name, const pv_config_t &config,
+                   double stretch, const std::vector<double> &input) {
+    pv_t                pv(stretch, 1, BLOCK, config);
+    std::vector<double> output;
+
+    pv.set_stretch(stretch);
+    bench_pull_all(&pv, input, stretch, BLOCK, &output);
+
+    printf("%-12s %6.2f  %8.1f  %8.2f\n", name, stretch,
+           1e3 * pv.get_latency() / SAMPLERATE,
+           spectral_convergence(input, output, stretch, pv.get_latency()));
+}
+
+int main() {
+    std::vector<double> input;
+    make_input(&input, SECONDS * SAMPLERATE);
+
+    pv_config_t centered;
+    pv_config_t causal;
+    pv_config_t r4 = pv_config_redundancy(4);
+    pv_config_t r4causal = r4;
+
+    causal.causal = true;
+    r4causal.causal = true;
+
+    printf("%-12s %6s  %8s  %8s\n", "", "stretch", "lat ms", "SC dB");
+
+    for (double stretch : {0.8, 1.25, 1.5, 2.0}) {
+        report("centered", centered, stretch, input);
+        report("causal", causal, stretch, input);
+        report("R4 centered", r4, stretch, input);
+        report("R4 causal", r4causal, stretch, input);
+    }
+
+    return 0;
+}
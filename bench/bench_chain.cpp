@@ -0,0 +1,229 @@
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <vector>
+
+#include "benchutils.h"
+#include "pv.h"
+#include "spectral_chain.h"
+
+#define SAMPLERATE 48000
+#define SECONDS 10
+#define BLOCK 1024
+#define NUM_CHANS 2
+#define STRETCH 1.5
+#define FFTLEN 8192
+#define FRAMES 20000
+
+using cpx = std::complex<double>;
+
+/**
+ * The same stages as separate callbacks, each one pass over the frame into
+ * its own buffer, the way they would be chained without spectral_chain_t.
+ */
+struct callback_chain_t {
+    struct stage_t {
+        rtdgtreal_processor_callback *callback;
+        void                         *userdata;
+    };
+
+    std::vector<stage_t> stages;
+    std::vector<cpx>     bufs[2];
+
+    static void callback(void *userdata, const cpx *in, int M2, int W,
+                         cpx *out) {
+        auto       chain = static_cast<callback_chain_t *>(userdata);
+        const cpx *src = in;
+        size_t     n = chain->stages.size();
+
+        for (size_t ii = 0; ii < n; ++ii) {
+            cpx *dst = ii + 1 == n ? out : chain->bufs[ii % 2].data();
+            chain->stages[ii].callback(chain->stages[ii].userdata, src, M2, W,
+                                       dst);
+            src = dst;
+        }
+    }
+};
+
+static void gain_callback(void *userdata, const cpx *in, int M2, int W,
+                          cpx *out) {
+    auto gain = static_cast<spectral_gain_t *>(userdata);
+    for (int ii = 0; ii < M2 * W; ++ii) out[ii] = gain->bin(0, 0, in[ii]);
+}
+
+static void mask_callback(void *userdata, const cpx *in, int M2, int W,
+                          cpx *out) {
+    auto mask = static_cast<spectral_mask_t *>(userdata);
+    for (int w = 0; w < W; ++w) {
+        for (int m = 0; m < M2; ++m) {
+            out[w * M2 + m] = mask->bin(w, m, in[w * M2 + m]);
+        }
+    }
+}
+
+static void gate_callback(void *userdata, const cpx *in, int M2, int W,
+                          cpx *out) {
+    auto gate = static_cast<spectral_gate_t *>(userdata);
+    for (int ii = 0; ii < M2 * W; ++ii) out[ii] = gate->bin(0, 0, in[ii]);
+}
+
+static void phase_callback(void *userdata, const cpx *in, int, int,
+                           cpx *out) {
+    static_cast<pv_t *>(userdata)->reconstruct_phase(in, out);
+}
+
+static void make_input(std::vector<double> *in, int L) {
+    in->resize(L);
+    for (int n = 0; n < L; ++n) {
+        double t = n / (double)SAMPLERATE;
+        (*in)[n] = 0.3 * std::sin(2 * M_PI * 220 * t) +
+                   0.2 * std::sin(2 * M_PI * 1375 * t * (1 + 0.01 * t));
+    }
+}
+
+static spectral_mask_t make_mask() {
+    spectral_mask_t mask(FFTLEN);
+
+    // Gentle high shelf
+    for (int m = 0; m <= FFTLEN / 2; ++m) {
+        mask.set_gain(m, 1.0 / (1.0 + m / 1024.0));
+    }
+    return mask;
+}
+
+/**
+ * Stretch the input, returns the CPU ms per second of output.
+ */
+static double run(pv_t *pv, const std::vector<double> &input) {
+    std::vector<double> outbuf(NUM_CHANS * BLOCK);
+    const double       *in[NUM_CHANS];
+    double             *out[NUM_CHANS];
+    size_t              pos = 0;
+    long                outLen = 0;
+
+    for (int w = 0; w < NUM_CHANS; ++w) out[w] = &outbuf[w * BLOCK];
+
+    double t0 = bench_cpu_seconds();
+
+    while (true) {
+        int Lin = pv->next_inlen(BLOCK);
+        if (pos + Lin > input.size()) break;
+
+        for (int w = 0; w < NUM_CHANS; ++w) in[w] = &input[pos];
+
+        pv->execute(in, Lin, NUM_CHANS, STRETCH, BLOCK, out);
+        bench_escape(outbuf.data());
+        pos += Lin;
+        outLen += BLOCK;
+    }
+
+    double secs = bench_cpu_seconds() - t0;
+
+    return 1e3 * secs / (outLen / (double)SAMPLERATE);
+}
+
+/**
+ * Time the effect stages alone on a synthetic frame, in microseconds per
+ * frame, and store their output.
+ */
+template <typename F>
+static double time_frames(F process, std::vector<cpx> *out) {
+    const int        M2 = FFTLEN / 2 + 1;
+    std::vector<cpx> in(M2 * NUM_CHANS);
+
+    out->resize(M2 * NUM_CHANS);
+
+    for (size_t ii = 0; ii < in.size(); ++ii) {
+        in[ii] = std::polar(1.0 / (1 + ii % M2), 0.1 * ii);
+    }
+
+    double t0 = bench_cpu_seconds();
+
+    for (int f = 0; f < FRAMES; ++f) {
+        process(in.data(), M2, NUM_CHANS, out->data());
+        bench_escape(out->data());
+    }
+
+    return 1e6 * (bench_cpu_seconds() - t0) / FRAMES;
+}
+
+int main() {
+    std::vector<double> input;
+    make_input(&input, SECONDS * SAMPLERATE);
+
+    const spectral_gain_t gain = {0.5};
+    const spectral_mask_t mask = make_mask();
+    const spectral_gate_t gate = {1e-4};
+
+    printf("%d s, %d channels, stretch %.2f, gain, mask and gate stages\n",
+           SECONDS, NUM_CHANS, STRETCH);
+
+    // Effect stages alone
+    {
+        spectral_chain_t chain(FFTLEN, NUM_CHANS, gain, mask, gate);
+
+        callback_chain_t cbchain;
+        spectral_gain_t  g = gain;
+        spectral_mask_t  k = mask;
+        spectral_gate_t  t = gate;
+
+        cbchain.stages = {{gain_callback, &g},
+                          {mask_callback, &k},
+                          {gate_callback, &t}};
+        for (auto &buf : cbchain.bufs) buf.resize((FFTLEN / 2 + 1) * NUM_CHANS);
+
+        std::vector<cpx> separate, fused;
+
+        double us1 = time_frames(
+            [&](const cpx *in, int M2, int W, cpx *out) {
+                callback_chain_t::callback(&cbchain, in, M2, W, out);
+            },
+            &separate);
+        double us2 = time_frames(
+            [&](const cpx *in, int M2, int W, cpx *out) {
+                decltype(chain)::callback(&chain, in, M2, W, out);
+            },
+            &fused);
+
+        printf("effects only   %6.1f us/frame  fused %6.1f  %.2fx  (%s)\n",
+               us1, us2, us1 / us2,
+               separate == fused ? "same output" : "OUTPUT DIFFERS");
+    }
+
+    // Whole processing, with the phase reconstruction as the last stage
+    double msRef, msSeparate, msFused;
+    {
+        pv_t pv(STRETCH, NUM_CHANS, BLOCK);
+        msRef = run(&pv, input);
+    }
+    {
+        pv_t             pv(STRETCH, NUM_CHANS, BLOCK);
+        callback_chain_t cbchain;
+        spectral_gain_t  g = gain;
+        spectral_mask_t  k = mask;
+        spectral_gate_t  t = gate;
+
+        cbchain.stages = {{gain_callback, &g},
+                          {mask_callback, &k},
+                          {gate_callback, &t},
+                          {phase_callback, &pv}};
+        for (auto &buf : cbchain.bufs) buf.resize((FFTLEN / 2 + 1) * NUM_CHANS);
+
+        pv.set_frame_callback(callback_chain_t::callback, &cbchain);
+        msSeparate = run(&pv, input);
+    }
+    {
+        pv_t             pv(STRETCH, NUM_CHANS, BLOCK);
+        spectral_chain_t chain(FFTLEN, NUM_CHANS, gain, mask, gate,
+                               spectral_pv_phase_t(&pv));
+
+        pv.set_frame_callback(decltype(chain)::callback, &chain);
+        msFused = run(&pv, input);
+    }
+
+    printf("phase only     %6.2f ms per s\n", msRef);
+    printf("callbacks      %6.2f ms per s\n", msSeparate);
+    printf("fused          %6.2f ms per s\n", msFused);
+
+    return 0;
+}
@@ -0,0 +1,392 @@
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "benchutils.h"
+#include "pv.h"
+
+#define LOAD_BUF_LEN (4 << 20)  // Doubles per load thread, 32 MiB
+
+using bench_clock = std::chrono::steady_clock;
+
+struct options_t {
+    int         samplerate = 48000;
+    int         period = 256;
+    int         chans = 2;
+    double      seconds = 10;
+    double      stretchLo = 1.5;
+    double      stretchHi = 1.5;
+    double      modPeriod = 4;  //!< Of the stretch automation, seconds
+    int         loadThreads = 0;
+    int         redundancy = 8;
+    bool        flush = false;
+    bool        paced = true;
+    bool        fifo = false;
+    const char *csv = nullptr;
+};
+
+/**
+ * Test signal, one second long and read in a loop: a chord, a noise burst
+ * and a short silence, so that the frames see tonal, noisy and (nearly)
+ * silent input.
+ */
+struct source_t {
+    std::vector<double> signal;
+    size_t              pos;
+};
+
+static void make_signal(source_t *src, int samplerate) {
+    uint32_t state = 1;
+
+    src->signal.resize(samplerate);
+    src->pos = 0;
+
+    for (int n = 0; n < samplerate; ++n) {
+        double t = n / (double)samplerate;
+        double v = 0;
+
+        for (double f : {196.0, 246.9, 293.7, 392.0}) {
+            v += 0.15 * std::sin(2 * M_PI * f * t);
+        }
+
+        state = state * 1664525u + 1013904223u;
+        if (t > 0.5 && t < 0.6) v += 0.3 * ((state >> 8) / 8388608.0 - 1);
+        if (t > 0.85) v = 0;
+
+        src->signal[n] = v;
+    }
+}
+
+static int read_source(void *userdata, double *buf[], int len, int chan) {
+    source_t *src = static_cast<source_t *>(userdata);
+
+    for (int ii = 0; ii < len; ++ii) {
+        double v = src->signal[src->pos];
+
+        for (int w = 0; w < chan; ++w) buf[w][ii] = v;
+        src->pos = (src->pos + 1) % src->signal.size();
+    }
+    return len;
+}
+
+/**
+ * Phase reconstruction of the pv_t, counting the frames.
+ */
+struct frame_counter_t {
+    pv_t *pv;
+    int   frames;
+};
+
+static void count_frame(void *userdata, const std::complex<double> *in,
+                        int, int, std::complex<double> *out) {
+    frame_counter_t *counter = static_cast<frame_counter_t *>(userdata);
+
+    counter->pv->reconstruct_phase(in, out);
+    ++counter->frames;
+}
+
+/**
+ * Background load: streams through a buffer larger than the caches, so
+ * that it competes for the memory bandwidth and evicts the pv_t state.
+ */
+static void load_thread(std::atomic<bool> *stop) {
+    std::vector<double> buf(LOAD_BUF_LEN, 1.0);
+
+    while (!stop->load(std::memory_order_relaxed)) {
+        for (size_t ii = 0; ii < buf.size(); ++ii) {
+            buf[ii] = buf[ii] * 1.0000001 + 1e-9;
+        }
+        bench_escape(buf.data());
+    }
+}
+
+static double stretch_at(const options_t &opt, double t) {
+    double mid = 0.5 * (opt.stretchLo + opt.stretchHi);
+    double depth = 0.5 * (opt.stretchHi - opt.stretchLo);
+
+    return mid + depth * std::sin(2 * M_PI * t / opt.modPeriod);
+}
+
+static double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) return NAN;
+
+    size_t idx = (size_t)std::ceil(p / 100 * sorted.size());
+    return sorted[std::clamp<size_t>(idx, 1, sorted.size()) - 1];
+}
+
+static void print_stats(const char *name, std::vector<double> times,
+                        double periodUs) {
+    if (times.empty()) {
+        printf("%-14s %8d callbacks\n", name, 0);
+        return;
+    }
+
+    std::sort(times.begin(), times.end());
+
+    double sum = 0;
+    for (double t : times) sum += t;
+
+    printf("%-14s %8zu callbacks  mean %7.1f  p50 %7.1f  p99 %7.1f  "
+           "p99.9 %7.1f  p99.99 %7.1f  max %7.1f us (%.0f%% of period)\n",
+           name, times.size(), sum / times.size(), percentile(times, 50),
+           percentile(times, 99), percentile(times, 99.9),
+           percentile(times, 99.99), times.back(),
+           100 * times.back() / periodUs);
+}
+
+/**
+ * Histogram of the execution times in fractions of the period, with
+ * power-of-two bins.
+ */
+static void print_histogram(const std::vector<double> &times,
+                            const std::vector<int> &frames,
+                            double periodUs) {
+    const double edges[] = {1 / 64.0, 1 / 32.0, 1 / 16.0, 1 / 8.0, 1 / 4.0,
+                            1 / 2.0,  1.0,      2.0,      INFINITY};
+    const int    numBins = sizeof(edges) / sizeof(edges[0]);
+
+    size_t all[numBins] = {}, withFrames[numBins] = {};
+    size_t peak = 1;
+
+    for (size_t ii = 0; ii < times.size(); ++ii) {
+        int bin = 0;
+        while (times[ii] > edges[bin] * periodUs) ++bin;
+
+        ++all[bin];
+        if (frames[ii] > 0) ++withFrames[bin];
+    }
+    for (size_t n : all) peak = std::max(peak, n);
+
+    printf("\n  time / period   callbacks   with frames\n");
+    for (int bin = 0; bin < numBins; ++bin) {
+        char label[32];
+        int  bar = (int)std::ceil(40.0 * all[bin] / peak);
+
+        if (std::isinf(edges[bin])) {
+            snprintf(label, sizeof(label), "> %g", edges[bin - 1]);
+        } else {
+            snprintf(label, sizeof(label), "<= %.4g", edges[bin]);
+        }
+        printf("  %-12s %12zu  %12zu  %.*s\n", label, all[bin],
+               withFrames[bin], bar,
+               "########################################");
+    }
+}
+
+static void set_realtime_priority() {
+    sched_param param = {};
+
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO) - 1;
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+
+    if (err) {
+        fprintf(stderr, "SCHED_FIFO not available (%s), running without\n",
+                strerror(err));
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "\n"
+            "Drive pv_t from a simulated audio callback and report the\n"
+            "execution time of every callback against its deadline, the\n"
+            "period.\n"
+            "\n"
+            "  -r rate      Sample rate (48000)\n"
+            "  -p period    Period in samples (256)\n"
+            "  -c chans     Channels (2)\n"
+            "  -d seconds   Simulated duration (10)\n"
+            "  -s lo[,hi]   Stretch, or sine automation between lo and hi\n"
+            "               (1.5)\n"
+            "  -m seconds   Period of the stretch automation (4)\n"
+            "  -R r         Redundancy of the configuration, 8, 4 or 2 (8)\n"
+            "  -l threads   Background load threads (0)\n"
+            "  -F           Flush denormals\n"
+            "  -P           Run the callback thread with SCHED_FIFO\n"
+            "  -n           Do not wait for the periods, run back to back\n"
+            "  -o file      Write every callback to a CSV file\n",
+            prog);
+}
+
+static bool parse_options(int argc, char **argv, options_t *opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (!strcmp(arg, "-F")) {
+            opt->flush = true;
+        } else if (!strcmp(arg, "-P")) {
+            opt->fifo = true;
+        } else if (!strcmp(arg, "-n")) {
+            opt->paced = false;
+        } else if (!val) {
+            return false;
+        } else if (!strcmp(arg, "-r")) {
+            opt->samplerate = atoi(argv[++i]);
+        } else if (!strcmp(arg, "-p")) {
+            opt->period = atoi(argv[++i]);
+        } else if (!strcmp(arg, "-c")) {
+            opt->chans = atoi(argv[++i]);
+        } else if (!strcmp(arg, "-d")) {
+            opt->seconds = atof(argv[++i]);
+        } else if (!strcmp(arg, "-s")) {
+            char *end;
+            opt->stretchLo = strtod(argv[++i], &end);
+            opt->stretchHi =
+                *end == ',' ? strtod(end + 1, nullptr) : opt->stretchLo;
+        } else if (!strcmp(arg, "-m")) {
+            opt->modPeriod = atof(argv[++i]);
+        } else if (!strcmp(arg, "-R")) {
+            opt->redundancy = atoi(argv[++i]);
+        } else if (!strcmp(arg, "-l")) {
+            opt->loadThreads = atoi(argv[++i]);
+        } else if (!strcmp(arg, "-o")) {
+            opt->csv = argv[++i];
+        } else {
+            return false;
+        }
+    }
+
+    return opt->samplerate > 0 && opt->period > 0 && opt->chans > 0 &&
+           opt->seconds > 0 && opt->stretchLo > 0 &&
+           opt->stretchHi >= opt->stretchLo && opt->modPeriod > 0 &&
+           (opt->redundancy == 8 || opt->redundancy == 4 ||
+            opt->redundancy == 2);
+}
+
+int main(int argc, char **argv) {
+    options_t opt;
+
+    if (!parse_options(argc, argv, &opt)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const int    numCallbacks = opt.seconds * opt.samplerate / opt.period;
+    const double periodUs = 1e6 * opt.period / opt.samplerate;
+    const auto   periodDur = std::chrono::duration_cast<bench_clock::duration>(
+        std::chrono::duration<double>(opt.period / (double)opt.samplerate));
+
+    pv_t            pv(opt.stretchHi, opt.chans, opt.period,
+                       pv_config_redundancy(opt.redundancy));
+    frame_counter_t counter = {&pv, 0};
+    source_t        src;
+
+    make_signal(&src, opt.samplerate);
+    pv.set_flush_denormals(opt.flush);
+    pv.set_frame_callback(count_frame, &counter);
+
+    // Everything the callback touches is allocated up front
+    std::vector<double>   outbuf(opt.chans * opt.period);
+    std::vector<double *> out(opt.chans);
+    std::vector<double>   execUs(numCallbacks);
+    std::vector<double>   lateUs(numCallbacks);
+    std::vector<int>      frames(numCallbacks);
+    std::vector<double>   stretches(numCallbacks);
+
+    for (int w = 0; w < opt.chans; ++w) out[w] = &outbuf[w * opt.period];
+
+    std::atomic<bool>        stop(false);
+    std::vector<std::thread> load;
+
+    for (int ii = 0; ii < opt.loadThreads; ++ii) {
+        load.emplace_back(load_thread, &stop);
+    }
+
+    if (opt.fifo) set_realtime_priority();
+
+    printf("%d Hz, period %d (%.0f us), %d channels, stretch %g to %g, "
+           "redundancy %d, %d load threads, %s\n",
+           opt.samplerate, opt.period, periodUs, opt.chans, opt.stretchLo,
+           opt.stretchHi, opt.redundancy, opt.loadThreads,
+           opt.paced ? "paced" : "back to back");
+
+    bench_clock::time_point start = bench_clock::now();
+
+    for (int k = 0; k < numCallbacks; ++k) {
+        bench_clock::time_point due = start + k * periodDur;
+
+        if (opt.paced) std::this_thread::sleep_until(due);
+
+        double stretch =
+            stretch_at(opt, k * opt.period / (double)opt.samplerate);
+
+        counter.frames = 0;
+
+        bench_clock::time_point t0 = bench_clock::now();
+        pv.pull(out.data(), opt.period, opt.chans, stretch, read_source,
+                &src);
+        bench_clock::time_point t1 = bench_clock::now();
+
+        bench_escape(outbuf.data());
+
+        execUs[k] = std::chrono::duration<double, std::micro>(t1 - t0).count();
+        lateUs[k] = std::chrono::duration<double, std::micro>(
+                        t1 - (due + periodDur))
+                        .count();
+        frames[k] = counter.frames;
+        stretches[k] = stretch;
+    }
+
+    stop = true;
+    for (std::thread &t : load) t.join();
+
+    // Deadline misses: the callback itself took longer than the period,
+    // and, when paced, the buffer was done after the end of its period
+    // (wake-up latency included)
+    int    missed = 0, late = 0, maxFrames = 0;
+    double maxLate = -INFINITY;
+
+    std::vector<double> withFrames, withoutFrames;
+
+    for (int k = 0; k < numCallbacks; ++k) {
+        missed += execUs[k] > periodUs;
+        late += lateUs[k] > 0;
+        maxLate = std::max(maxLate, lateUs[k]);
+        maxFrames = std::max(maxFrames, frames[k]);
+        (frames[k] > 0 ? withFrames : withoutFrames).push_back(execUs[k]);
+    }
+
+    printf("\n");
+    print_stats("all", execUs, periodUs);
+    print_stats("with frames", withFrames, periodUs);
+    print_stats("without", withoutFrames, periodUs);
+
+    print_histogram(execUs, frames, periodUs);
+
+    printf("\n%d of %d callbacks over the period", missed, numCallbacks);
+    if (opt.paced) {
+        printf(", %d finished after their deadline (latest by %.1f us)", late,
+               std::max(maxLate, 0.0));
+    }
+    printf("\nUp to %d frames in one callback\n", maxFrames);
+
+    if (opt.csv) {
+        FILE *f = fopen(opt.csv, "w");
+
+        if (!f) {
+            fprintf(stderr, "Cannot write %s\n", opt.csv);
+            return 1;
+        }
+
+        fprintf(f, "callback,stretch,frames,exec_us,late_us\n");
+        for (int k = 0; k < numCallbacks; ++k) {
+            fprintf(f, "%d,%.6f,%d,%.3f,%.3f\n", k, stretches[k], frames[k],
+                    execUs[k], lateUs[k]);
+        }
+        fclose(f);
+    }
+
+    return missed > 0;
+}
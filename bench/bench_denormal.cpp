@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "benchutils.h"
+#include "pv.h"
+
+#define SAMPLERATE 48000
+#define SECONDS 20
+#define BLOCK 256
+#define NUM_CHANS 2
+#define STRETCH 1.25
+
+/**
+ * Decaying chord: the envelope goes from 1 down to about 1e-320 over the
+ * whole signal, so the later part of the stream is in the subnormal range,
+ * like the tail of a reverb or a fade to digital silence.
+ */
+static void make_input(std::vector<double> *in, int L) {
+    const double freqs[] = {220.0, 277.2, 329.6, 440.0};
+    const double decay = std::log(1e-320) / L;
+
+    in->resize(L);
+    for (int n = 0; n < L; ++n) {
+        double t = n / (double)SAMPLERATE;
+        double x = 0;
+        for (double f : freqs) x += 0.25 * std::sin(2 * M_PI * f * t);
+        (*in)[n] = x * std::exp(decay * n);
+    }
+}
+
+/**
+ * Time each execute() call over the input, return the ticks of every call.
+ */
+static std::vector<uint64_t> run(const std::vector<double> &input,
+                                 bool flush) {
+    const int bufLenMax = std::ceil(BLOCK / STRETCH) + 1;
+    pv_t      pv(STRETCH, NUM_CHANS, bufLenMax);
+
+    std::vector<double>   outbuf(NUM_CHANS * BLOCK);
+    std::vector<uint64_t> ticks;
+    const double         *in[NUM_CHANS];
+    double               *out[NUM_CHANS];
+
+    pv.set_flush_denormals(flush);
+    for (int w = 0; w < NUM_CHANS; ++w) out[w] = &outbuf[w * BLOCK];
+
+    size_t pos = 0;
+    while (true) {
+        int Lin = std::min<int>(pv.next_inlen(BLOCK), bufLenMax);
+        if (pos + Lin > input.size()) break;
+
+        for (int w = 0; w < NUM_CHANS; ++w) in[w] = &input[pos];
+
+        uint64_t t0 = bench_ticks();
+        pv.execute(in, Lin, NUM_CHANS, STRETCH, BLOCK, out);
+        ticks.push_back(bench_ticks() - t0);
+
+        bench_escape(outbuf.data());
+        pos += Lin;
+    }
+
+    return ticks;
+}
+
+static void report(const char *name, std::vector<uint64_t> ticks) {
+    double sum = 0;
+    for (uint64_t t : ticks) sum += t;
+
+    std::sort(ticks.begin(), ticks.end());
+
+    printf("%-16s mean %10.0f  p99 %10llu  max %10llu %ss/block\n", name,
+           sum / ticks.size(),
+           (unsigned long long)ticks[ticks.size() * 99 / 100],
+           (unsigned long long)ticks.back(), bench_ticks_unit());
+}
+
+int main() {
+    std::vector<double> input;
+    make_input(&input, SECONDS * SAMPLERATE);
+
+    printf("%d s decaying to subnormal, %d channels, %d-sample blocks\n",
+           SECONDS, NUM_CHANS, BLOCK);
+
+    // Warm-up, so that the first measured run does not pay for page faults.
+    run(input, true);
+
+    report("flush off", run(input, false));
+    report("flush on", run(input, true));
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "benchutils.h"
+#include "fft.h"
+
+#define ITERATIONS 2000
+
+struct fft_bufs_t {
+    explicit fft_bufs_t(int M)
+        : real(static_cast<double *>(fft_alloc(M * sizeof(double)))),
+          cpx(static_cast<std::complex<double> *>(
+              fft_alloc((M / 2 + 1) * sizeof(std::complex<double>)))) {}
+
+    ~fft_bufs_t() {
+        fft_free(real);
+        fft_free(cpx);
+    }
+
+    double               *real;
+    std::complex<double> *cpx;
+};
+
+/**
+ * Time ITERATIONS transforms after a short warm-up, return ns per transform.
+ * The input is restored before each run, so that the inverse (which may
+ * overwrite its input) always sees the same data.
+ */
+static double measure(fft_real_t *fft, double *in, const double *ref,
+                      int len) {
+    for (int it = 0; it < ITERATIONS / 10; ++it) {
+        std::copy(ref, ref + len, in);
+        fft->execute();
+    }
+
+    double t0 = bench_seconds();
+    for (int it = 0; it < ITERATIONS; ++it) {
+        std::copy(ref, ref + len, in);
+        fft->execute();
+    }
+    return (bench_seconds() - t0) * 1e9 / ITERATIONS;
+}
+
+int main() {
+    const fft_backend_t backends[] = {FFT_BACKEND_FFTW, FFT_BACKEND_BUILTIN};
+    const int           sizes[] = {1024, 2048, 4096, 8192, 16384};
+
+    printf("default backend: %s\n\n", fft_backend_name(fft_default_backend()));
+    printf("%-8s %6s %12s %9s %12s %9s\n", "backend", "M", "r2c ns", "MFLOPS",
+           "c2r ns", "MFLOPS");
+
+    for (int M : sizes) {
+        std::vector<double> x(M);
+        std::vector<double> X(M + 2);
+        for (auto &v : x) v = std::rand() / (double)RAND_MAX - 0.5;
+        for (auto &v : X) v = std::rand() / (double)RAND_MAX - 0.5;
+
+        // Conventional flop count of a real FFT
+        double flops = 2.5 * M * std::log2(M);
+
+        for (fft_backend_t backend : backends) {
+            if (!fft_backend_available(backend)) continue;
+
+            fft_bufs_t bufs(M);
+            auto fwd = fft_real_create(backend, M, false, bufs.real, bufs.cpx);
+            auto inv = fft_real_create(backend, M, true, bufs.real, bufs.cpx);
+
+            double tf = measure(fwd.get(), bufs.real, x.data(), M);
+            double ti = measure(inv.get(), reinterpret_cast<double *>(bufs.cpx),
+                                X.data(), M + 2);
+
+            bench_escape(bufs.real);
+
+            printf("%-8s %6d %12.0f %9.0f %12.0f %9.0f\n",
+                   fft_backend_name(backend), M, tf, flops / tf * 1e3, ti,
+                   flops / ti * 1e3);
+        }
+    }
+
+    return 0;
+}
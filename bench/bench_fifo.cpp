@@ -0,0 +1,105 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include "arrayutils.h"
+#include "benchutils.h"
+#include "circularbuf.h"
+#include "firwin.h"
+
+#define WIN_LEN 4096
+#define HOP 1024
+#define NUM_CHANS 2
+#define ITERATIONS 20000
+
+/**
+ * Overlap-add as it was done before: separate windowing pass in the inverse
+ * transform, then a scalar accumulate.
+ */
+static void ola_reference(double *acc, const double *buf, const double *g,
+                          double *tmp, int L) {
+    for (int ii = 0; ii < L; ++ii) tmp[ii] = buf[ii] * g[ii];
+    for (int ii = 0; ii < L; ++ii) acc[ii] += tmp[ii];
+}
+
+/**
+ * Read as it was done before: copy pass then clear pass.
+ */
+static void read_reference(double *src, int L, double *dst) {
+    std::copy(src, src + L, dst);
+    std::fill(src, src + L, 0);
+}
+
+/**
+ * Time ITERATIONS calls of fn after a short warm-up, return the ticks spent.
+ */
+template <typename Fn>
+static uint64_t measure(Fn fn) {
+    for (int it = 0; it < ITERATIONS / 10; ++it) fn();
+
+    uint64_t t0 = bench_ticks();
+    for (int it = 0; it < ITERATIONS; ++it) fn();
+    return bench_ticks() - t0;
+}
+
+static void report(const char *name, uint64_t ticks, double bytes) {
+    printf("%-28s %8.3f bytes/%s\n", name, bytes / ticks, bench_ticks_unit());
+}
+
+int main() {
+    auto acc = std::make_unique<double[]>(WIN_LEN);
+    auto buf = std::make_unique<double[]>(NUM_CHANS * WIN_LEN);
+    auto tmp = std::make_unique<double[]>(WIN_LEN);
+    auto g = std::make_unique<double[]>(WIN_LEN);
+    auto out = std::make_unique<double[]>(NUM_CHANS * HOP);
+
+    firwin(FIRWIN_HANN, WIN_LEN, g.get());
+    for (int ii = 0; ii < NUM_CHANS * WIN_LEN; ++ii) {
+        buf[ii] = std::rand() / (double)RAND_MAX;
+    }
+
+    // Overlap-add kernel: reads acc, buf and g, writes acc
+    double olaBytes = 3.0 * WIN_LEN * sizeof(double) * ITERATIONS;
+
+    report("overlap-add (before)", measure([&] {
+               ola_reference(acc.get(), buf.get(), g.get(), tmp.get(),
+                             WIN_LEN);
+               bench_escape(acc.get());
+           }),
+           olaBytes);
+
+    report("overlap-add (after)", measure([&] {
+               overlap_add(acc.get(), buf.get(), g.get(), WIN_LEN);
+               bench_escape(acc.get());
+           }),
+           olaBytes);
+
+    // Read-and-clear kernel: reads src, writes src and dst
+    double readBytes = 3.0 * HOP * sizeof(double) * ITERATIONS;
+
+    report("read-and-clear (before)", measure([&] {
+               read_reference(acc.get(), HOP, out.get());
+               bench_escape(out.get());
+           }),
+           readBytes);
+
+    report("read-and-clear (after)", measure([&] {
+               move_clear(acc.get(), HOP, out.get());
+               bench_escape(out.get());
+           }),
+           readBytes);
+
+    // Whole synthesis fifo, one frame in and one hop out per iteration
+    synthesis_fifo_t fifo(HOP + WIN_LEN, WIN_LEN, HOP, NUM_CHANS);
+    double          *outChans[NUM_CHANS];
+    for (int w = 0; w < NUM_CHANS; ++w) outChans[w] = out.get() + w * HOP;
+
+    report("synthesis_fifo_t", measure([&] {
+               fifo.write(buf.get(), g.get());
+               fifo.read(HOP, NUM_CHANS, outChans);
+               bench_escape(out.get());
+           }),
+           NUM_CHANS * (olaBytes + readBytes));
+
+    return 0;
+}
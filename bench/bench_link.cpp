@@ -0,0 +1,88 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "benchutils.h"
+#include "pv.h"
+#include "quality.h"
+
+#define SAMPLERATE 48000
+#define SECONDS 10
+#define BLOCK 1024
+
+/**
+ * Stereo mix of a harmonic tone panned left, a sweep panned right and a
+ * tone reaching the right channel 0.3 ms after the left one.
+ */
+static void make_input(std::vector<double> in[2], int L) {
+    const int delay = 15;
+
+    in[0].resize(L);
+    in[1].resize(L);
+    for (int n = 0; n < L; ++n) {
+        double t = n / (double)SAMPLERATE;
+        double td = (n - delay) / (double)SAMPLERATE;
+        double harm = 0;
+        double sweep = 0.2 * sin(2 * M_PI * (300 + 300 * t / SECONDS) * t);
+
+        for (int h = 1; h <= 8; ++h) {
+            harm += 0.1 * sin(2 * M_PI * 220 * h * t) / h;
+        }
+
+        in[0][n] = 0.8 * harm + 0.3 * sweep + 0.2 * sin(2 * M_PI * 880 * t);
+        in[1][n] = 0.3 * harm + 0.8 * sweep + 0.2 * sin(2 * M_PI * 880 * td);
+    }
+}
+
+static void report(const char *name, rtpghi_link_t link, double stretch,
+                   const std::vector<double> in[2]) {
+    pv_t                pv(stretch, 2, BLOCK);
+    std::vector<double> out[2];
+    size_t              pos = 0;
+
+    pv.set_channel_link(link);
+
+    double t0 = bench_seconds();
+
+    while (true) {
+        int Lin = pv.next_inlen(BLOCK);
+        if (pos + Lin > in[0].size()) break;
+
+        const double *inp[2] = {&in[0][pos], &in[1][pos]};
+        size_t        outpos = out[0].size();
+
+        out[0].resize(outpos + BLOCK);
+        out[1].resize(outpos + BLOCK);
+
+        double *outp[2] = {&out[0][outpos], &out[1][outpos]};
+        pv.execute(inp, Lin, 2, stretch, BLOCK, outp);
+        pos += Lin;
+    }
+
+    double secs = bench_seconds() - t0;
+    double sc = 0;
+
+    for (int w = 0; w < 2; ++w) {
+        sc += spectral_convergence(in[w], out[w], stretch, pv.get_latency());
+    }
+
+    printf("%-6s %6.2f  %8.2f  %8.2f  %8.3f\n", name, stretch,
+           1e3 * secs / SECONDS, sc / 2,
+           interchannel_phase_error(in, out, stretch, pv.get_latency()));
+}
+
+int main() {
+    std::vector<double> in[2];
+    make_input(in, SECONDS * SAMPLERATE);
+
+    printf("%-6s %6s  %8s  %8s  %8s\n", "", "stretch", "ms/s", "SC dB",
+           "ICPD rad");
+
+    for (double stretch : {0.8, 1.25, 1.5, 2.0}) {
+        report("none", RTPGHI_LINK_NONE, stretch, in);
+        report("sum", RTPGHI_LINK_SUM, stretch, in);
+        report("max", RTPGHI_LINK_MAX, stretch, in);
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "benchutils.h"
+#include "pv.h"
+#include "pv_multiband.h"
+
+#define SAMPLERATE 48000
+#define SECONDS 20
+#define BLOCK 256
+#define NUM_CHANS 2
+#define STRETCH 1.5
+
+/**
+ * Sweep from 50 Hz to 12 kHz over clicks every 250 ms, for content at both
+ * ends of the spectrum.
+ */
+static void make_input(std::vector<double> *in, int L) {
+    const double f0 = 50.0;
+    const double f1 = 12000.0;
+    const double k = std::log(f1 / f0) / L;
+
+    in->resize(L);
+    for (int n = 0; n < L; ++n) {
+        double phase = 2 * M_PI * f0 / SAMPLERATE * (std::exp(k * n) - 1) / k;
+        (*in)[n] = 0.5 * std::sin(phase);
+        if (n % (SAMPLERATE / 4) == 0) (*in)[n] += 0.5;
+    }
+}
+
+/**
+ * Stretch the whole input, return the processing time over the duration of
+ * the input.
+ */
+static double run(pv_multiband_t *pv, const std::vector<double> &input) {
+    std::vector<double> outbuf(NUM_CHANS * BLOCK);
+    double             *out[NUM_CHANS];
+    bench_source_t      src = {&input, 0};
+
+    for (int w = 0; w < NUM_CHANS; ++w) out[w] = &outbuf[w * BLOCK];
+
+    pv->reset();
+
+    double t0 = bench_seconds();
+    while (src.pos < input.size()) {
+        pv->pull(out, BLOCK, NUM_CHANS, STRETCH, bench_read, &src);
+        bench_escape(outbuf.data());
+    }
+    return (bench_seconds() - t0) / SECONDS;
+}
+
+/**
+ * Relative RMS difference between the output at stretch 1 and the input
+ * delayed by get_latency(), over the first seconds of the input. The bands
+ * reconstruct the input exactly, so it is only small if they are aligned
+ * and the latency is right.
+ */
+static double alignment_error(pv_multiband_t            *pv,
+                              const std::vector<double> &input) {
+    const size_t              L = 2 * SAMPLERATE;
+    const std::vector<double> head(input.begin(), input.begin() + L);
+    std::vector<double>       output;
+
+    pv->reset();
+    pv->set_stretch(1.0);
+    bench_pull_all(pv, head, 1.0, BLOCK, &output);
+
+    int    latency = pv->get_latency();
+    double err = 0, ref = 0;
+
+    // Past the first frames, once every band holds input, and before the
+    // unpulled last partial block
+    for (size_t n = latency + SAMPLERATE / 4; n + BLOCK < L; ++n) {
+        double x = input[n - latency];
+        err += (output[n] - x) * (output[n] - x);
+        ref += x * x;
+    }
+    return std::sqrt(err / ref);
+}
+
+static void report(const char *name, const pv_config_t bands[],
+                   int numBands, const std::vector<double> &input) {
+    pv_multiband_t pv(2.0, NUM_CHANS, BLOCK, bands, numBands);
+    int            lat1, lat2;
+
+    pv.set_stretch(1.0);
+    lat1 = pv.get_latency();
+    pv.set_stretch(STRETCH);
+    lat2 = pv.get_latency();
+
+    // Warm-up, so that the measured run does not pay for page faults.
+    run(&pv, input);
+
+    printf("%-12s %8.0f  %8.1f  %8.1f  %8.4f  %8.1e\n", name,
+           pv.get_fft_cost(), 1e3 * lat1 / SAMPLERATE, 1e3 * lat2 / SAMPLERATE,
+           run(&pv, input), alignment_error(&pv, input));
+}
+
+int main() {
+    std::vector<double> input;
+    make_input(&input, SECONDS * SAMPLERATE);
+
+    printf("%d s at %d Hz, %d channels, %d-sample blocks\n", SECONDS,
+           SAMPLERATE, NUM_CHANS, BLOCK);
+    printf("%-12s %8s  %8s  %8s  %8s  %8s\n", "", "flop/smp", "lat1 ms",
+           "lat ms", "rt", "err at 1");
+
+    // Bands from the highest, the last one at 1/2^(n-1) the input rate.
+    const pv_config_t single[] = {pv_config_t()};
+    const pv_config_t r4[] = {pv_config_redundancy(4)};
+    const pv_config_t two[] = {{512, 1024, 128}, {2048, 4096, 512}};
+    const pv_config_t three[] = {
+        {512, 1024, 128}, {512, 1024, 128}, {1024, 2048, 256}};
+    const pv_config_t threeR4[] = {
+        {1024, 1024, 256}, {1024, 1024, 256}, {2048, 2048, 512}};
+    const pv_config_t twoCausal[] = {
+        {512, 1024, 128, FIRWIN_HANN, 0.0, true},
+        {2048, 4096, 512, FIRWIN_HANN, 0.0, true}};
+
+    report("single", single, 1, input);
+    report("single R4", r4, 1, input);
+    report("2 bands", two, 2, input);
+    report("3 bands", three, 3, input);
+    report("3 bands R4", threeR4, 3, input);
+    report("2 causal", twoCausal, 2, input);
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "benchutils.h"
+#include "pv.h"
+
+#define SAMPLERATE 48000
+#define SECONDS 30
+#define BLOCK 16384
+#define NUM_CHANS 2
+#define STRETCH 1.5
+#define HOP 1024
+
+static void make_input(std::vector<double> *in, int L) {
+    in->resize(L);
+    for (int n = 0; n < L; ++n) {
+        double t = n / (double)SAMPLERATE;
+        (*in)[n] = 0.3 * std::sin(2 * M_PI * 220 * t) +
+                   0.2 * std::sin(2 * M_PI * 1375 * t * (1 + 0.01 * t));
+    }
+}
+
+/**
+ * Stretch the whole input in blocks of BLOCK output samples with the given
+ * pipeline stages and batched frames, return the frames processed per second.
+ */
+static double run(const std::vector<double> &input, int stages, int batch) {
+    const int bufLenMax = BLOCK;
+    pv_t      pv(STRETCH, NUM_CHANS, bufLenMax);
+
+    std::vector<double> outbuf(NUM_CHANS * BLOCK);
+    const double       *in[NUM_CHANS];
+    double             *out[NUM_CHANS];
+    long                outLen = 0;
+
+    pv.set_pipeline_stages(stages);
+    pv.set_batch_frames(batch);
+    for (int w = 0; w < NUM_CHANS; ++w) out[w] = &outbuf[w * BLOCK];
+
+    double t0 = bench_seconds();
+
+    size_t pos = 0;
+    while (true) {
+        int Lin = std::min<int>(pv.next_inlen(BLOCK), bufLenMax);
+        if (pos + Lin > input.size()) break;
+
+        for (int w = 0; w < NUM_CHANS; ++w) in[w] = &input[pos];
+
+        pv.execute(in, Lin, NUM_CHANS, STRETCH, BLOCK, out);
+        bench_escape(outbuf.data());
+
+        pos += Lin;
+        outLen += BLOCK;
+    }
+
+    // One frame per synthesis hop
+    return outLen / HOP / (bench_seconds() - t0);
+}
+
+int main() {
+    std::vector<double> input;
+    make_input(&input, SECONDS * SAMPLERATE);
+
+    printf("%d s, %d channels, %d-sample blocks, stretch %.2f\n", SECONDS,
+           NUM_CHANS, BLOCK, STRETCH);
+
+    // Warm-up, so that the first measured run does not pay for page faults.
+    run(input, 1, 1);
+
+    double serial = run(input, 1, 1);
+    printf("1 stage  %8.0f frames/s\n", serial);
+
+    for (int stages = 2; stages <= 3; ++stages) {
+        double fps = run(input, stages, 1);
+        printf("%d stages %8.0f frames/s  %.2fx\n", stages, fps, fps / serial);
+    }
+
+    for (int batch : {2, 4, 8}) {
+        double fps = run(input, 1, batch);
+        printf("batch %d  %8.0f frames/s  %.2fx\n", batch, fps, fps / serial);
+    }
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "benchutils.h"
+#include "pv.h"
+#include "pv_pool.h"
+
+#define SAMPLERATE 48000
+#define BLOCK 1024
+#define NUM_CHANS 2
+#define STRETCH 1.5
+#define STREAMS 20
+#define STREAM_BLOCKS 8
+
+/**
+ * A short stream: STREAM_BLOCKS output blocks of a tone.
+ */
+static void run_stream(pv_t *pv) {
+    std::vector<double> inbuf(2 * BLOCK);
+    std::vector<double> outbuf(NUM_CHANS * BLOCK);
+    const double       *in[NUM_CHANS];
+    double             *out[NUM_CHANS];
+
+    for (int n = 0; n < 2 * BLOCK; ++n) {
+        inbuf[n] = 0.3 * std::sin(2 * M_PI * 440 * n / SAMPLERATE);
+    }
+    for (int w = 0; w < NUM_CHANS; ++w) {
+        in[w] = inbuf.data();
+        out[w] = &outbuf[w * BLOCK];
+    }
+
+    for (int b = 0; b < STREAM_BLOCKS; ++b) {
+        pv->execute(in, pv->next_inlen(BLOCK), NUM_CHANS, STRETCH, BLOCK, out);
+        bench_escape(outbuf.data());
+    }
+}
+
+int main() {
+    pv_config_t config;
+
+    printf("%d streams of %d blocks of %d samples, %d channels\n", STREAMS,
+           STREAM_BLOCKS, BLOCK, NUM_CHANS);
+
+    // A new instance per stream
+    double startNew = 0, t0, t1;
+
+    for (int s = 0; s < STREAMS; ++s) {
+        t0 = bench_seconds();
+        pv_t pv(STRETCH, NUM_CHANS, BLOCK, config);
+        t1 = bench_seconds();
+
+        startNew += t1 - t0;
+        run_stream(&pv);
+    }
+
+    // Instances from a pool, constructed once
+    t0 = bench_seconds();
+    pv_pool_t pool(STRETCH, NUM_CHANS, BLOCK, config, 4);
+    double    fill = bench_seconds() - t0;
+    double    startPool = 0, releasePool = 0;
+
+    for (int s = 0; s < STREAMS; ++s) {
+        t0 = bench_seconds();
+        pv_t *pv = pool.acquire();
+        t1 = bench_seconds();
+
+        startPool += t1 - t0;
+        run_stream(pv);
+
+        t0 = bench_seconds();
+        pool.release(pv);
+        releasePool += bench_seconds() - t0;
+    }
+
+    printf("construct      %9.1f us per stream\n", 1e6 * startNew / STREAMS);
+    printf("pool acquire   %9.1f us per stream\n", 1e6 * startPool / STREAMS);
+    printf("pool release   %9.1f us per stream\n",
+           1e6 * releasePool / STREAMS);
+    printf("pool of %d      %9.1f us, once\n", pool.get_size(), 1e6 * fill);
+
+    return 0;
+}
@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "audiofile.h"
+#include "benchutils.h"
+#include "pv.h"
+#include "pv_p.h"
+#include "quality.h"
+
+#define SAMPLERATE 48000
+#define SECONDS 4
+#define MAX_SECONDS 20
+#define BLOCK 1024
+
+struct corpus_item_t {
+    std::string         name;
+    std::vector<double> samples;
+    int                 samplerate;
+};
+
+/**
+ * One point of the parameter grid and its measures, averaged over the
+ * stretch factors and the corpus.
+ */
+struct grid_point_t {
+    pv_config_t config;
+    const char *window;   //!< Name of the window
+    double      cost;     //!< CPU ms per second of output
+    double      sc;       //!< Mean spectral convergence, dB
+    double      scWorst;  //!< Worst spectral convergence, dB
+    double      pc;       //!< Mean phase consistency error, rad
+    bool        pareto;   //!< Not dominated by another point
+};
+
+/**
+ * Exponential chirp from 50 Hz to 12 kHz.
+ */
+static void make_chirp(std::vector<double> *x, int L) {
+    const double f0 = 50, f1 = 12000;
+    const double k = std::log(f1 / f0) / SECONDS;
+
+    x->resize(L);
+    for (int n = 0; n < L; ++n) {
+        double t = n / (double)SAMPLERATE;
+        (*x)[n] = 0.5 * sin(2 * M_PI * f0 * (std::exp(k * t) - 1) / k);
+    }
+}
+
+/**
+ * Decaying noise bursts every 250 ms over a low chord, for transients.
+ */
+static void make_bursts(std::vector<double> *x, int L) {
+    uint32_t state = 1;
+
+    x->resize(L);
+    for (int n = 0; n < L; ++n) {
+        double t = n / (double)SAMPLERATE;
+        double env = std::exp(-(n % (SAMPLERATE / 4)) / 400.0);
+
+        state = state * 1664525u + 1013904223u;
+        double noise = (state >> 8) * (2.0 / 16777216.0) - 1;
+
+        (*x)[n] = 0.4 * env * noise + 0.1 * sin(2 * M_PI * 110 * t) +
+                  0.1 * sin(2 * M_PI * 165 * t) + 0.1 * sin(2 * M_PI * 220 * t);
+    }
+}
+
+/**
+ * Read a file, mixed down to mono and truncated to MAX_SECONDS.
+ */
+static bool load_file(const char *path, corpus_item_t *item) {
+    audio_reader_t reader;
+
+    if (!reader.open(path)) return false;
+
+    const SF_INFO      &info = reader.get_info();
+    const int           chans = info.channels;
+    long                maxLen = (long)MAX_SECONDS * info.samplerate;
+    std::vector<double> buf(BLOCK * chans);
+    int                 got;
+
+    item->name = path;
+    item->samplerate = info.samplerate;
+    item->samples.clear();
+
+    while ((long)item->samples.size() < maxLen &&
+           (got = reader.read(buf.data(), BLOCK)) > 0) {
+        for (int ii = 0; ii < got; ++ii) {
+            double v = 0;
+            for (int w = 0; w < chans; ++w) v += buf[ii * chans + w];
+            item->samples.push_back(v / chans);
+        }
+    }
+
+    if ((long)item->samples.size() > maxLen) item->samples.resize(maxLen);
+
+    // The quality measures need a few frames
+    return item->samples.size() > 4 * QUALITY_FFTLEN;
+}
+
+/**
+ * Stretch one item, accumulate its CPU time and output duration and return
+ * its measures.
+ */
+static void run(const pv_config_t &config, double stretch,
+                const corpus_item_t &item, double *cpu, double *seconds,
+                double *sc, double *pc) {
+    const std::vector<double> &input = item.samples;
+    pv_t                       pv(stretch, 1, BLOCK, config);
+    std::vector<double>        output;
+
+    pv.set_stretch(stretch);
+
+    double t0 = bench_cpu_seconds();
+    bench_pull_all(&pv, input, stretch, BLOCK, &output);
+    *cpu += bench_cpu_seconds() - t0;
+    *seconds += output.size() / (double)item.samplerate;
+
+    *sc = spectral_convergence(input, output, stretch, pv.get_latency());
+    *pc = phase_consistency_error(input, output, stretch, pv.get_latency());
+}
+
+static void evaluate(grid_point_t *p, const std::vector<double> &stretches,
+                     const std::vector<corpus_item_t> &corpus) {
+    double cpu = 0, seconds = 0;
+    int    runs = 0;
+
+    p->sc = 0;
+    p->scWorst = -INFINITY;
+    p->pc = 0;
+
+    for (double stretch : stretches) {
+        for (const corpus_item_t &item : corpus) {
+            double sc, pc;
+
+            run(p->config, stretch, item, &cpu, &seconds, &sc, &pc);
+            p->sc += sc;
+            p->scWorst = std::max(p->scWorst, sc);
+            p->pc += pc;
+            ++runs;
+        }
+    }
+
+    p->cost = 1e3 * cpu / seconds;
+    p->sc /= runs;
+    p->pc /= runs;
+}
+
+/**
+ * Whether a is at least as good as b on every measure, and better on one.
+ */
+static bool dominates(const grid_point_t &a, const grid_point_t &b) {
+    return a.cost <= b.cost && a.sc <= b.sc && a.pc <= b.pc &&
+           (a.cost < b.cost || a.sc < b.sc || a.pc < b.pc);
+}
+
+static std::vector<grid_point_t> make_grid(bool quick) {
+    struct window_t {
+        const char *name;
+        firwin_t    window;
+        int         lenDiv;  //!< winLen = fftLen / lenDiv, 0 for Gaussian
+    };
+
+    const window_t windows[] = {{"hann", FIRWIN_HANN, 1},
+                                {"hann/2", FIRWIN_HANN, 2},
+                                {"blackman", FIRWIN_BLACKMAN, 1},
+                                {"blackman/2", FIRWIN_BLACKMAN, 2},
+                                {"gauss", FIRWIN_HANN, 0}};
+
+    std::vector<int>    fftLens = {2048, 4096, 8192};
+    std::vector<int>    redundancies = {4, 8};
+    std::vector<double> tols = {1e-1, 1e-2, 1e-4, 1e-6};
+
+    if (quick) {
+        fftLens = {4096};
+        tols = {1e-2, 1e-6};
+    }
+
+    std::vector<grid_point_t> grid;
+
+    for (int M : fftLens) {
+        for (int redundancy : redundancies) {
+            for (const window_t &win : windows) {
+                for (double tol : tols) {
+                    grid_point_t p = {};
+
+                    p.window = win.name;
+                    p.config.fftLen = M;
+                    p.config.hop = M / redundancy;
+                    p.config.window = win.window;
+                    p.config.tol = tol;
+                    if (win.lenDiv > 0) {
+                        p.config.winLen = M / win.lenDiv;
+                    } else {
+                        p.config.gaussThr = 1e-2;
+                    }
+                    grid.push_back(p);
+                }
+            }
+        }
+    }
+
+    return grid;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options] [file...]\n"
+            "\n"
+            "Measure the quality and the cost of pv_t over a grid of\n"
+            "transform configurations, on a synthetic corpus and the given\n"
+            "audio files (mixed down to mono, at most %d s each), and print\n"
+            "the Pareto-optimal ones from the cheapest.\n"
+            "\n"
+            "  -q       Smaller grid and fewer stretch factors\n"
+            "  -a       Print all configurations, Pareto-optimal ones with *\n"
+            "  -f dB    Also print the cheapest configuration with a mean\n"
+            "           spectral convergence below dB\n",
+            prog, MAX_SECONDS);
+}
+
+int main(int argc, char **argv) {
+    bool   quick = false;
+    bool   all = false;
+    double floorDb = NAN;
+
+    std::vector<corpus_item_t> corpus(3);
+
+    corpus[0].name = "tones";
+    bench_make_tones(&corpus[0].samples, SECONDS * SAMPLERATE, SAMPLERATE);
+    corpus[1].name = "chirp";
+    make_chirp(&corpus[1].samples, SECONDS * SAMPLERATE);
+    corpus[2].name = "bursts";
+    make_bursts(&corpus[2].samples, SECONDS * SAMPLERATE);
+    for (corpus_item_t &item : corpus) item.samplerate = SAMPLERATE;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-q")) {
+            quick = true;
+        } else if (!strcmp(argv[i], "-a")) {
+            all = true;
+        } else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+            floorDb = std::strtod(argv[++i], nullptr);
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            corpus_item_t item;
+
+            if (!load_file(argv[i], &item)) {
+                fprintf(stderr, "Cannot read %s\n", argv[i]);
+                return 1;
+            }
+            corpus.push_back(std::move(item));
+        }
+    }
+
+    std::vector<double> stretches = {0.75, 1.25, 1.5, 2.0};
+    if (quick) stretches = {0.75, 1.5};
+
+    std::vector<grid_point_t> grid = make_grid(quick);
+
+    printf("%zu configurations, %zu stretch factors, corpus:", grid.size(),
+           stretches.size());
+    for (const corpus_item_t &item : corpus) printf(" %s", item.name.c_str());
+    printf("\n");
+
+    for (size_t ii = 0; ii < grid.size(); ++ii) {
+        evaluate(&grid[ii], stretches, corpus);
+        fprintf(stderr, "\r%zu/%zu", ii + 1, grid.size());
+    }
+    fprintf(stderr, "\n");
+
+    for (grid_point_t &p : grid) {
+        p.pareto = std::none_of(
+            grid.begin(), grid.end(),
+            [&](const grid_point_t &q) { return dominates(q, p); });
+    }
+
+    std::sort(grid.begin(), grid.end(),
+              [](const grid_point_t &a, const grid_point_t &b) {
+                  return a.cost < b.cost;
+              });
+
+    printf("  %6s %6s %5s %-10s %6s  %8s  %8s  %8s  %8s\n", "fftLen",
+           "winLen", "hop", "window", "tol", "ms/s", "SC dB", "worst",
+           "PC rad");
+
+    const grid_point_t *cheapest = nullptr;
+
+    for (const grid_point_t &p : grid) {
+        if (!cheapest && p.sc <= floorDb) cheapest = &p;
+        if (!all && !p.pareto) continue;
+
+        printf("%c %6d %6d %5d %-10s %6.0e  %8.2f  %8.2f  %8.2f  %8.3f\n",
+               all && p.pareto ? '*' : ' ', p.config.fftLen,
+               pv_window_length(p.config), p.config.hop, p.window,
+               p.config.tol, p.cost, p.sc, p.scWorst, p.pc);
+    }
+
+    if (!std::isnan(floorDb)) {
+        if (cheapest) {
+            printf("Cheapest below %.1f dB: fftLen %d, hop %d, %s, tol %.0e, "
+                   "%.2f ms/s\n",
+                   floorDb, cheapest->config.fftLen, cheapest->config.hop,
+                   cheapest->window, cheapest->config.tol, cheapest->cost);
+        } else {
+            printf("No configuration below %.1f dB\n", floorDb);
+        }
+    }
+
+    return 0;
+}
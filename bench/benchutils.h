@@ -0,0 +1,121 @@
+#ifndef BENCHUTILS_H__
+#define BENCHUTILS_H__
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+/**
+ * Read the CPU timestamp counter if available, nanoseconds otherwise.
+ */
+inline uint64_t bench_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+/**
+ * Unit of bench_ticks(), for printing.
+ */
+inline const char *bench_ticks_unit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "cycle";
+#else
+    return "ns";
+#endif
+}
+
+/**
+ * Wall clock in seconds.
+ */
+inline double bench_seconds() {
+    return std::chrono::duration<double>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * Processor time of the process in seconds.
+ */
+inline double bench_cpu_seconds() {
+    return std::clock() / (double)CLOCKS_PER_SEC;
+}
+
+/**
+ * Keep the compiler from optimizing away a benchmarked result.
+ */
+template <typename T>
+inline void bench_escape(T *p) {
+    asm volatile("" : : "g"(p) : "memory");
+}
+
+/**
+ * Harmonic tone with vibrato (220 Hz, 12 harmonics) and a sine sweeping up
+ * from 500 Hz over the L samples.
+ */
+inline void bench_make_tones(std::vector<double> *x, int L, int samplerate) {
+    double seconds = L / (double)samplerate;
+
+    x->resize(L);
+    for (int n = 0; n < L; ++n) {
+        double t = n / (double)samplerate;
+        double ph = 2 * M_PI * 220 * t - 0.02 * 220 / 5 * cos(2 * M_PI * 5 * t);
+        double v = 0;
+
+        for (int h = 1; h <= 12; ++h) v += sin(h * ph) / h;
+        v *= 0.2;
+        v += 0.1 * sin(2 * M_PI * (500 + 2000 * t / seconds) * t);
+        (*x)[n] = v;
+    }
+}
+
+/**
+ * Mono input of pv_t::pull(), copied to every channel and padded with zeros
+ * past its end.
+ */
+struct bench_source_t {
+    const std::vector<double> *input;
+    size_t                     pos;
+};
+
+inline int bench_read(void *userdata, double *buf[], int len, int chan) {
+    bench_source_t *src = static_cast<bench_source_t *>(userdata);
+
+    for (int ii = 0; ii < len; ++ii, ++src->pos) {
+        double x = src->pos < src->input->size() ? (*src->input)[src->pos] : 0;
+        for (int w = 0; w < chan; ++w) buf[w][ii] = x;
+    }
+    return len;
+}
+
+/**
+ * Stretch the whole input into output, one channel, pulling blocks of
+ * block samples from pv (pv_t or pv_multiband_t) at a fixed stretch.
+ * output is resized to ceil(input length * stretch); its last partial
+ * block is left at zero.
+ */
+template <typename PV>
+inline void bench_pull_all(PV *pv, const std::vector<double> &input,
+                           double stretch, int block,
+                           std::vector<double> *output) {
+    bench_source_t src = {&input, 0};
+
+    output->assign(std::ceil(input.size() * stretch), 0);
+
+    for (size_t pos = 0; pos + block <= output->size(); pos += block) {
+        double *out[1] = {&(*output)[pos]};
+        pv->pull(out, block, 1, stretch, bench_read, &src);
+    }
+}
+
+#endif  // BENCHUTILS_H__
@@ -0,0 +1,209 @@
+#ifndef QUALITY_H__
+#define QUALITY_H__
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include "fft.h"
+
+/** Frame length of the quality measures */
+#define QUALITY_FFTLEN 2048
+
+/** Input hop between the frames of the quality measures */
+#define QUALITY_HOP 512
+
+/**
+ * Hann windowed spectra of QUALITY_FFTLEN sample frames.
+ */
+class quality_spectrum_t {
+   public:
+    quality_spectrum_t()
+        : _real(static_cast<double *>(
+              fft_alloc(QUALITY_FFTLEN * sizeof(double)))),
+          _cpx(static_cast<std::complex<double> *>(fft_alloc(
+              (QUALITY_FFTLEN / 2 + 1) * sizeof(std::complex<double>)))),
+          _fft(fft_real_create(fft_default_backend(), QUALITY_FFTLEN, false,
+                               _real, _cpx)),
+          _win(QUALITY_FFTLEN) {
+        for (int ii = 0; ii < QUALITY_FFTLEN; ++ii) {
+            _win[ii] = 0.5 - 0.5 * cos(2 * M_PI * ii / QUALITY_FFTLEN);
+        }
+    }
+
+    ~quality_spectrum_t() {
+        _fft.reset();
+        fft_free(_real);
+        fft_free(_cpx);
+    }
+
+    /**
+     * Spectrum of the frame of x centered on sample c, QUALITY_FFTLEN/2+1
+     * coefficients, valid until the next call.
+     */
+    const std::complex<double> *operator()(const std::vector<double> &x,
+                                           long                       c) {
+        for (int ii = 0; ii < QUALITY_FFTLEN; ++ii) {
+            _real[ii] = _win[ii] * x[c - QUALITY_FFTLEN / 2 + ii];
+        }
+        _fft->execute();
+        return _cpx;
+    }
+
+   private:
+    double                     *_real;
+    std::complex<double>       *_cpx;
+    std::unique_ptr<fft_real_t> _fft;
+    std::vector<double>         _win;
+};
+
+/**
+ * Calls f(ci, co) for the frame centers ci of the input and co of the
+ * output that match, for in and out as in spectral_convergence().
+ */
+template <typename F>
+inline void quality_frames(const std::vector<double> &in,
+                           const std::vector<double> &out, double stretch,
+                           int latency, F f) {
+    const int L = QUALITY_FFTLEN;
+
+    // Frame centers on input samples, the output ones are rounded.
+    for (long ci = L; ci + L < (long)in.size(); ci += QUALITY_HOP) {
+        long co = std::lround(ci * stretch + latency);
+
+        if (co < L / 2 || co + L / 2 > (long)out.size()) continue;
+
+        f(ci, co);
+    }
+}
+
+/**
+ * Spectral convergence of a stretched signal, in dB: the distance between
+ * the magnitude spectra of the output and of the input at the matching
+ * positions, relative to the input. Lower is better.
+ *
+ * Output sample n holds the input around (n - latency) / stretch, see
+ * pv_t::get_latency(). Frames that do not fit in both signals are skipped.
+ */
+inline double spectral_convergence(const std::vector<double> &in,
+                                   const std::vector<double> &out,
+                                   double stretch, int latency) {
+    quality_spectrum_t  spectrum;
+    std::vector<double> mag(QUALITY_FFTLEN / 2 + 1);
+    double              num = 0;
+    double              den = 0;
+
+    quality_frames(in, out, stretch, latency, [&](long ci, long co) {
+        const std::complex<double> *cin = spectrum(in, ci);
+        for (int m = 0; m <= QUALITY_FFTLEN / 2; ++m) mag[m] = std::abs(cin[m]);
+
+        const std::complex<double> *cout = spectrum(out, co);
+        for (int m = 0; m <= QUALITY_FFTLEN / 2; ++m) {
+            double d = std::abs(cout[m]) - mag[m];
+            num += d * d;
+            den += mag[m] * mag[m];
+        }
+    });
+
+    return 10 * std::log10(num / den);
+}
+
+/**
+ * Error of the phase differences between two channels, in radians: the
+ * difference between the phase of channel 1 relative to channel 0 in the
+ * output and in the input at the matching positions, averaged over the
+ * coefficients weighted by their magnitude. 0 when the stereo image is
+ * kept, about pi/2 when the phases of the channels are unrelated.
+ */
+inline double interchannel_phase_error(const std::vector<double> *in,
+                                       const std::vector<double> *out,
+                                       double stretch, int latency) {
+    const int                         M2 = QUALITY_FFTLEN / 2 + 1;
+    quality_spectrum_t                spectrum;
+    std::vector<std::complex<double>> cross(M2);
+    double                            num = 0;
+    double                            den = 0;
+
+    quality_frames(in[0], out[0], stretch, latency, [&](long ci, long co) {
+        const std::complex<double> *c = spectrum(in[0], ci);
+        std::copy(c, c + M2, cross.begin());
+
+        c = spectrum(in[1], ci);
+        for (int m = 0; m < M2; ++m) cross[m] *= std::conj(c[m]);
+
+        c = spectrum(out[0], co);
+        for (int m = 0; m < M2; ++m) cross[m] *= std::conj(c[m]);
+
+        // in0 conj(in1) conj(out0) out1, the difference of the differences
+        c = spectrum(out[1], co);
+        for (int m = 0; m < M2; ++m) {
+            std::complex<double> d = cross[m] * c[m];
+            double               w = std::sqrt(std::abs(d));
+
+            num += w * std::abs(std::arg(d));
+            den += w;
+        }
+    });
+
+    return num / den;
+}
+
+/**
+ * Phase consistency error of a stretched signal, in radians: the
+ * difference between the phase advance of the output from one frame to the
+ * next and the advance that the instantaneous frequency of the input at
+ * the matching positions predicts, averaged over the coefficients weighted
+ * by their magnitude. The instantaneous frequencies are measured from the
+ * phase advance over one sample, which is not ambiguous. 0 for sinusoids
+ * that keep their phase coherence, about pi/2 when the phases of
+ * consecutive frames are unrelated (phasiness).
+ */
+inline double phase_consistency_error(const std::vector<double> &in,
+                                      const std::vector<double> &out,
+                                      double stretch, int latency) {
+    const int                         M2 = QUALITY_FFTLEN / 2 + 1;
+    quality_spectrum_t                spectrum;
+    std::vector<std::complex<double>> cur(M2), prev(M2);
+    std::vector<double>               freq(M2), prevFreq(M2);
+    long                              prevci = -1, prevco = 0;
+    double                            num = 0;
+    double                            den = 0;
+
+    quality_frames(in, out, stretch, latency, [&](long ci, long co) {
+        // Instantaneous frequency of the input, in radians per sample
+        const std::complex<double> *c = spectrum(in, ci);
+        std::copy(c, c + M2, cur.begin());
+
+        c = spectrum(in, ci + 1);
+        for (int m = 0; m < M2; ++m) {
+            freq[m] = std::arg(c[m] * std::conj(cur[m]));
+        }
+
+        c = spectrum(out, co);
+        std::copy(c, c + M2, cur.begin());
+
+        // Frames skipped in between would make the advance ambiguous
+        if (ci == prevci + QUALITY_HOP) {
+            for (int m = 0; m < M2; ++m) {
+                double advance = 0.5 * (freq[m] + prevFreq[m]) * (co - prevco);
+                std::complex<double> d =
+                    cur[m] * std::conj(prev[m]) * std::polar(1.0, -advance);
+                double w = std::sqrt(std::abs(d));
+
+                num += w * std::abs(std::arg(d));
+                den += w;
+            }
+        }
+
+        std::swap(cur, prev);
+        std::swap(freq, prevFreq);
+        prevci = ci;
+        prevco = co;
+    });
+
+    return num / den;
+}
+
+#endif  // QUALITY_H__
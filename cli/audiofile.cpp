@@ -0,0 +1,153 @@
+#include "audiofile.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+audio_reader_t::audio_reader_t() : _file(nullptr) {
+    memset(&_info, 0, sizeof(_info));
+}
+
+audio_reader_t::~audio_reader_t() { close(); }
+
+bool audio_reader_t::open(const char *path) {
+    close();
+    memset(&_info, 0, sizeof(_info));
+
+    if (!(_file = sf_open(path, SFM_READ, &_info))) {
+        fprintf(stderr, "Not able to open input file %s: %s\n", path,
+                sf_strerror(nullptr));
+        return false;
+    }
+    return true;
+}
+
+void audio_reader_t::close() {
+    if (_file) sf_close(_file);
+    _file = nullptr;
+}
+
+const SF_INFO &audio_reader_t::get_info() const { return _info; }
+
+int audio_reader_t::read(double *buf, int frames) {
+    return (int)sf_readf_double(_file, buf, frames);
+}
+
+/**
+ * Case-insensitive comparison of the extension of path with ext.
+ */
+static bool has_ext(const char *path, const char *ext) {
+    const char *dot = strrchr(path, '.');
+
+    if (!dot) return false;
+
+    for (++dot; *dot && *ext; ++dot, ++ext) {
+        if (tolower((unsigned char)*dot) != *ext) return false;
+    }
+    return !*dot && !*ext;
+}
+
+int audio_major_format(const char *path) {
+    if (has_ext(path, "wav")) return SF_FORMAT_WAV;
+    if (has_ext(path, "aif") || has_ext(path, "aiff")) return SF_FORMAT_AIFF;
+    if (has_ext(path, "flac")) return SF_FORMAT_FLAC;
+    if (has_ext(path, "ogg") || has_ext(path, "oga") || has_ext(path, "opus"))
+        return SF_FORMAT_OGG;
+#ifdef PVCLI_HAVE_MPEG
+    if (has_ext(path, "mp3")) return SF_FORMAT_MPEG;
+#endif
+    if (has_ext(path, "raw") || has_ext(path, "pcm")) return SF_FORMAT_RAW;
+
+    return 0;
+}
+
+/**
+ * Pick the sample encoding for the output container.
+ */
+static int output_subtype(const char *path, int major, int inFormat) {
+    switch (major) {
+        case SF_FORMAT_OGG:
+            return has_ext(path, "opus") ? SF_FORMAT_OPUS : SF_FORMAT_VORBIS;
+#ifdef PVCLI_HAVE_MPEG
+        case SF_FORMAT_MPEG:
+            return SF_FORMAT_MPEG_LAYER_III;
+#endif
+        case SF_FORMAT_FLAC:
+            // FLAC is integer only
+            switch (inFormat & SF_FORMAT_SUBMASK) {
+                case SF_FORMAT_PCM_S8:
+                case SF_FORMAT_PCM_16:
+                case SF_FORMAT_PCM_24:
+                    return inFormat & SF_FORMAT_SUBMASK;
+                default:
+                    return SF_FORMAT_PCM_24;
+            }
+        default:
+            switch (inFormat & SF_FORMAT_SUBMASK) {
+                case SF_FORMAT_PCM_16:
+                case SF_FORMAT_PCM_24:
+                case SF_FORMAT_PCM_32:
+                case SF_FORMAT_FLOAT:
+                case SF_FORMAT_DOUBLE:
+                    return inFormat & SF_FORMAT_SUBMASK;
+                default:
+                    // Lossy input, keep the headroom
+                    return SF_FORMAT_FLOAT;
+            }
+    }
+}
+
+audio_writer_t::audio_writer_t() : _file(nullptr) {}
+
+audio_writer_t::~audio_writer_t() { close(); }
+
+bool audio_writer_t::open(const char *path, int channels, int samplerate,
+                          int inFormat, double quality) {
+    SF_INFO info;
+    int     major;
+
+    close();
+
+    if (!(major = audio_major_format(path))) {
+        fprintf(stderr, "Unknown output format for %s\n", path);
+        return false;
+    }
+
+    memset(&info, 0, sizeof(info));
+    info.channels = channels;
+    info.samplerate = samplerate;
+    info.format = major | output_subtype(path, major, inFormat);
+
+    if (!sf_format_check(&info)) {
+        fprintf(stderr,
+                "Output format of %s does not support %d channels at %d Hz\n",
+                path, channels, samplerate);
+        return false;
+    }
+
+    if (!(_file = sf_open(path, SFM_WRITE, &info))) {
+        fprintf(stderr, "Not able to open output file %s: %s\n", path,
+                sf_strerror(nullptr));
+        return false;
+    }
+
+    if (quality >= 0) {
+        // Ignored by formats without a quality setting
+        sf_command(_file, SFC_SET_VBR_ENCODING_QUALITY, &quality,
+                   sizeof(quality));
+    }
+
+    // Avoid wrap-around on integer formats
+    sf_command(_file, SFC_SET_CLIPPING, nullptr, SF_TRUE);
+
+    return true;
+}
+
+void audio_writer_t::close() {
+    if (_file) sf_close(_file);
+    _file = nullptr;
+}
+
+int audio_writer_t::write(const double *buf, int frames) {
+    return (int)sf_writef_double(_file, buf, frames);
+}
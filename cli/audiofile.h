@@ -0,0 +1,75 @@
+#ifndef AUDIOFILE_H__
+#define AUDIOFILE_H__
+
+#include <sndfile.h>
+
+/**
+ * Streaming audio file reader.
+ *
+ * Anything libsndfile can decode: WAV, AIFF, FLAC, Ogg Vorbis, Opus and MP3
+ * (the latter requires libsndfile 1.1 or newer).
+ */
+class audio_reader_t final {
+   public:
+    audio_reader_t();
+    ~audio_reader_t();
+
+    audio_reader_t(const audio_reader_t &) = delete;
+    audio_reader_t &operator=(const audio_reader_t &) = delete;
+
+    bool open(const char *path);
+    void close();
+
+    const SF_INFO &get_info() const;
+
+    /** Read up to frames interleaved frames, returns the number read */
+    int read(double *buf, int frames);
+
+   private:
+    SNDFILE *_file;
+    SF_INFO  _info;
+};
+
+/**
+ * Streaming audio file writer.
+ *
+ * The container and codec are picked from the file extension.
+ */
+class audio_writer_t final {
+   public:
+    audio_writer_t();
+    ~audio_writer_t();
+
+    audio_writer_t(const audio_writer_t &) = delete;
+    audio_writer_t &operator=(const audio_writer_t &) = delete;
+
+    /**
+     * Open path for writing.
+     *
+     * \param[in]  path       Output file name
+     * \param[in]  channels   Number of channels
+     * \param[in]  samplerate Sample rate
+     * \param[in]  inFormat   Format of the input file, its sample encoding is
+     *                        kept if the output container supports it
+     * \param[in]  quality    Encoder quality in [0,1] for lossy formats, or
+     *                        negative for the codec default
+     */
+    bool open(const char *path, int channels, int samplerate, int inFormat,
+              double quality);
+    void close();
+
+    /** Write frames interleaved frames, returns the number written */
+    int write(const double *buf, int frames);
+
+   private:
+    SNDFILE *_file;
+};
+
+/**
+ * Guess the libsndfile major format from the extension of path.
+ *
+ * \returns SF_FORMAT_TYPEMASK part of the format, or 0 if unknown
+ */
+int audio_major_format(const char *path);
+
+#endif  // AUDIOFILE_H__
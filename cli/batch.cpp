@@ -0,0 +1,151 @@
+#include "batch.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+#include "workpool.h"
+
+double batch_stats_t::realtime_factor() const {
+    if (seconds <= 0) return 0;
+    return inSeconds / seconds;
+}
+
+/**
+ * Split line into fields separated by tabs, or by spaces if there is no tab.
+ */
+static std::vector<std::string> split_fields(const std::string &line) {
+    std::vector<std::string> fields;
+
+    if (line.find('\t') != std::string::npos) {
+        std::istringstream in(line);
+        std::string        field;
+        while (std::getline(in, field, '\t')) {
+            if (!field.empty()) fields.push_back(field);
+        }
+    } else {
+        std::istringstream in(line);
+        std::string        field;
+        while (in >> field) fields.push_back(field);
+    }
+    return fields;
+}
+
+bool batch_load_manifest(const char *path, double defaultStretch,
+                         std::vector<batch_job_t> *jobs) {
+    std::ifstream in(path);
+    std::string   line;
+    int           lineNo = 0;
+
+    if (!in) {
+        fprintf(stderr, "Not able to open manifest %s\n", path);
+        return false;
+    }
+
+    while (std::getline(in, line)) {
+        ++lineNo;
+
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        std::vector<std::string> fields = split_fields(line);
+        batch_job_t              job{"", "", defaultStretch};
+        char                    *end = nullptr;
+
+        if (fields.size() == 3) {
+            job.stretch = std::strtod(fields[2].c_str(), &end);
+        }
+
+        if (fields.size() < 2 || fields.size() > 3 || (end && *end) ||
+            job.stretch <= 0) {
+            fprintf(stderr, "%s:%d: expected input, output [, stretch]\n",
+                    path, lineNo);
+            return false;
+        }
+
+        job.inPath = fields[0];
+        job.outPath = fields[1];
+        jobs->push_back(job);
+    }
+
+    return true;
+}
+
+/**
+ * Relative processing cost of a job: proportional to the number of output
+ * frames, estimated from the input file size.
+ */
+static double job_cost(const batch_job_t &job) {
+    struct stat st;
+
+    if (stat(job.inPath.c_str(), &st) < 0) return 0;
+    return st.st_size * job.stretch;
+}
+
+batch_stats_t batch_run(const std::vector<batch_job_t> &jobs,
+                        const pipeline_opts_t &opts, int numWorkers,
+                        std::vector<batch_result_t> *results) {
+    batch_stats_t               stats;
+    std::vector<batch_result_t> res(jobs.size());
+    std::vector<double>         cost(jobs.size());
+    std::vector<size_t>         order(jobs.size());
+
+    numWorkers = std::max(1, std::min<int>(numWorkers, jobs.size()));
+
+    std::vector<pv_cache_t> caches(numWorkers);
+    work_stealing_pool_t    pool(numWorkers);
+
+    // Longest first, dealt round robin: the long jobs start early and the
+    // short ones at the back of the deques are left for stealing.
+    for (size_t ii = 0; ii < jobs.size(); ++ii) cost[ii] = job_cost(jobs[ii]);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return cost[a] > cost[b]; });
+
+    for (size_t ii = 0; ii < order.size(); ++ii) {
+        size_t job = order[ii];
+
+        pool.submit(ii % numWorkers, [&, job](int worker) {
+            pipeline_opts_t jobOpts = opts;
+            jobOpts.stretch = jobs[job].stretch;
+
+            res[job].ok = pipeline_run_serial(
+                jobs[job].inPath.c_str(), jobs[job].outPath.c_str(), jobOpts,
+                &caches[worker], &res[job].stats);
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    pool.run();
+
+    stats.seconds = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+    stats.jobs = jobs.size();
+    stats.workers = numWorkers;
+    stats.steals = pool.get_steals();
+
+    for (const auto &cache : caches) stats.pvCreated += cache.get_created();
+
+    for (const auto &r : res) {
+        if (!r.ok) {
+            ++stats.failed;
+            continue;
+        }
+        stats.inFrames += r.stats.inFrames;
+        stats.inSeconds += r.stats.inFrames / (double)r.stats.samplerate;
+        stats.outSeconds += r.stats.outFrames / (double)r.stats.samplerate;
+    }
+
+    if (results) *results = std::move(res);
+
+    return stats;
+}
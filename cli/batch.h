@@ -0,0 +1,78 @@
+#ifndef BATCH_H__
+#define BATCH_H__
+
+#include <string>
+#include <vector>
+
+#include "pipeline.h"
+
+/**
+ * One file of a batch.
+ */
+struct batch_job_t {
+    std::string inPath;   //!< Input file
+    std::string outPath;  //!< Output file
+    double      stretch;  //!< Time stretch factor
+};
+
+/**
+ * Outcome of one job.
+ */
+struct batch_result_t {
+    bool             ok = false;  //!< Whether the files could be opened
+    pipeline_stats_t stats;       //!< Statistics of the file
+};
+
+/**
+ * Aggregate statistics of a batch.
+ */
+struct batch_stats_t {
+    int       jobs = 0;          //!< Number of jobs
+    int       failed = 0;        //!< Jobs whose files could not be opened
+    int       workers = 0;       //!< Number of worker threads
+    int       pvCreated = 0;     //!< pv_t instances constructed
+    long      steals = 0;        //!< Jobs stolen from another worker
+    double    inSeconds = 0.0;   //!< Duration of the input audio
+    double    outSeconds = 0.0;  //!< Duration of the output audio
+    long long inFrames = 0;      //!< Input frames, all channels counted once
+    double    seconds = 0.0;     //!< Wall clock time
+
+    /** Seconds of input audio processed per second of wall clock time */
+    double realtime_factor() const;
+};
+
+/**
+ * Read a batch manifest.
+ *
+ * One job per line: input path, output path and optionally the stretch
+ * factor, separated by tabs (or by spaces if the line contains no tab).
+ * Empty lines and lines starting with '#' are skipped.
+ *
+ * \param[in]   path            Manifest file
+ * \param[in]   defaultStretch  Stretch of the jobs that do not give one
+ * \param[out]  jobs            Jobs are appended to it
+ *
+ * \returns false if the manifest could not be read or has an invalid line
+ */
+bool batch_load_manifest(const char *path, double defaultStretch,
+                         std::vector<batch_job_t> *jobs);
+
+/**
+ * Run jobs on a work-stealing pool of numWorkers threads.
+ *
+ * Every worker processes whole files with pipeline_run_serial() and keeps
+ * its pv_t instances across files. Jobs are dealt longest first (by input
+ * size and stretch) and idle workers steal queued jobs from busy ones.
+ *
+ * \param[in]   jobs        Jobs to run, opts.stretch is overridden by theirs
+ * \param[in]   opts        Pipeline options
+ * \param[in]   numWorkers  Number of threads, the caller being one of them
+ * \param[out]  results     Outcome of each job, may be nullptr
+ *
+ * \returns Aggregate statistics
+ */
+batch_stats_t batch_run(const std::vector<batch_job_t> &jobs,
+                        const pipeline_opts_t &opts, int numWorkers,
+                        std::vector<batch_result_t> *results);
+
+#endif  // BATCH_H__
@@ -0,0 +1,58 @@
+#ifndef BOUNDEDQUEUE_H__
+#define BOUNDEDQUEUE_H__
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/**
+ * Blocking FIFO queue with a maximum number of elements.
+ *
+ * Producers block in push() while the queue is full, consumers block in pop()
+ * while it is empty. After close(), pop() drains the remaining elements and
+ * then returns false.
+ */
+template <typename T>
+class bounded_queue_t final {
+   public:
+    explicit bounded_queue_t(size_t capacity) : _capacity(capacity) {}
+
+    /** Returns false if the queue was closed in the meantime */
+    bool push(T &&item) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notFull.wait(lock,
+                      [this] { return _closed || _items.size() < _capacity; });
+        if (_closed) return false;
+        _items.push_back(std::move(item));
+        _notEmpty.notify_one();
+        return true;
+    }
+
+    /** Returns false if the queue is closed and empty */
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notEmpty.wait(lock, [this] { return _closed || !_items.empty(); });
+        if (_items.empty()) return false;
+        item = std::move(_items.front());
+        _items.pop_front();
+        _notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closed = true;
+        _notEmpty.notify_all();
+        _notFull.notify_all();
+    }
+
+   private:
+    std::mutex              _mutex;
+    std::condition_variable _notEmpty;
+    std::condition_variable _notFull;
+    std::deque<T>           _items;
+    size_t                  _capacity;
+    bool                    _closed = false;
+};
+
+#endif  // BOUNDEDQUEUE_H__
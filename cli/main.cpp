@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "batch.h"
+#include "pipeline.h"
+#include "rtpghi_trace.h"
+
+static void usage(const char *prog) {
+    printf(
+        "Usage: %s [options] input output [input output ...]\n"
+        "       %s [options] -l manifest [input output ...]\n"
+        "\n"
+        "Time-stretch audio files. Reads anything libsndfile can decode,\n"
+        "the output format is picked from the extension (.wav, .aiff, .flac,\n"
+        ".ogg, .opus, .mp3).\n"
+        "\n"
+        "Options:\n"
+        "  -s <ratio>    Stretch factor, output/input duration (default 1)\n"
+        "  -b <frames>   Block length between stages (default 1024)\n"
+        "  -d <blocks>   Queue depth between stages (default 8)\n"
+        "  -q <quality>  Encoder quality in [0,1] for lossy formats\n"
+        "  -R <M/a>      Redundancy of the transform, 8 (default), 4 or 2;\n"
+        "                lower is faster\n"
+        "  -m            Memory-map the input, PCM or float WAV only\n"
+        "  -r <f,c,sr>   Memory-map headerless input with sample format f\n"
+        "                (s16, s24, s32, f32, f64), c channels, rate sr\n"
+        "  -l <file>     Batch manifest, one 'input output [stretch]' job per\n"
+        "                line, fields separated by tabs or spaces\n"
+        "  -j <threads>  Batch worker threads (default: all cores)\n"
+        "  -t <file>     Write a Chrome trace of the last processed frames\n"
+        "                (library built with RTPGHI_TRACE)\n"
+        "  -h            Show this help\n"
+        "\n"
+        "With -l or -j, the files are processed as a batch on a work-stealing\n"
+        "thread pool, one file per worker at a time.\n",
+        prog, prog);
+}
+
+/**
+ * Parse the numeric value of option argv[*i], advancing *i.
+ */
+static bool parse_value(int argc, char **argv, int *i, double *value) {
+    char *end;
+
+    if (*i + 1 >= argc) {
+        fprintf(stderr, "Missing value for %s\n", argv[*i]);
+        return false;
+    }
+
+    *value = std::strtod(argv[++*i], &end);
+    if (*end) {
+        fprintf(stderr, "Invalid value for %s: %s\n", argv[*i - 1], argv[*i]);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Parse the RAW input description of option argv[*i], advancing *i.
+ */
+static bool parse_raw(int argc, char **argv, int *i, pipeline_opts_t *opts) {
+    static const struct {
+        const char  *name;
+        pcm_format_t fmt;
+    } formats[] = {{"s16", PCM_S16},
+                   {"s24", PCM_S24},
+                   {"s32", PCM_S32},
+                   {"f32", PCM_F32},
+                   {"f64", PCM_F64}};
+
+    char name[4];
+    int  channels, samplerate;
+
+    if (*i + 1 >= argc) {
+        fprintf(stderr, "Missing value for %s\n", argv[*i]);
+        return false;
+    }
+
+    if (sscanf(argv[++*i], "%3[a-z0-9],%d,%d", name, &channels,
+               &samplerate) == 3 &&
+        channels > 0 && samplerate > 0) {
+        for (const auto &f : formats) {
+            if (!strcmp(name, f.name)) {
+                opts->rawFormat = f.fmt;
+                opts->rawChannels = channels;
+                opts->rawSamplerate = samplerate;
+                return true;
+            }
+        }
+    }
+
+    fprintf(stderr, "Invalid value for %s: %s\n", argv[*i - 1], argv[*i]);
+    return false;
+}
+
+/**
+ * Run the manifest jobs and the input/output pairs of files as a batch.
+ */
+static int run_batch(const char *manifest, int workers, char **files,
+                     int numFiles, const pipeline_opts_t &opts) {
+    std::vector<batch_job_t>    jobs;
+    std::vector<batch_result_t> results;
+
+    if (manifest && !batch_load_manifest(manifest, opts.stretch, &jobs)) {
+        return 1;
+    }
+
+    for (int i = 0; i < numFiles; i += 2) {
+        jobs.push_back(batch_job_t{files[i], files[i + 1], opts.stretch});
+    }
+
+    if (workers <= 0) {
+        workers = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+
+    batch_stats_t stats = batch_run(jobs, opts, workers, &results);
+
+    for (size_t ii = 0; ii < jobs.size(); ++ii) {
+        if (!results[ii].ok) {
+            fprintf(stderr, "%s -> %s: failed\n", jobs[ii].inPath.c_str(),
+                    jobs[ii].outPath.c_str());
+        }
+    }
+
+    printf("%d files (%d failed) on %d workers: %.2f s in, %.2f s out, "
+           "%.2f s wall, %.1fx realtime, %.0f frames/s\n",
+           stats.jobs, stats.failed, stats.workers, stats.inSeconds,
+           stats.outSeconds, stats.seconds, stats.realtime_factor(),
+           stats.seconds > 0 ? stats.inFrames / stats.seconds : 0.0);
+    printf("%d phase vocoder instances for %d files, %ld jobs stolen\n",
+           stats.pvCreated, stats.jobs - stats.failed, stats.steals);
+
+    return stats.failed ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    pipeline_opts_t opts;
+    int             firstFile = argc;
+    double          value;
+    const char     *manifest = nullptr;
+    int             workers = 0;
+    bool            batch = false;
+    const char     *tracePath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i][0] != '-' || !argv[i][1]) {
+            firstFile = i;
+            break;
+        }
+
+        switch (argv[i][1]) {
+            case 's':
+                if (!parse_value(argc, argv, &i, &value)) return 1;
+                opts.stretch = value;
+                break;
+            case 'b':
+                if (!parse_value(argc, argv, &i, &value)) return 1;
+                opts.blockLen = (int)value;
+                break;
+            case 'd':
+                if (!parse_value(argc, argv, &i, &value)) return 1;
+                opts.queueDepth = (int)value;
+                break;
+            case 'q':
+                if (!parse_value(argc, argv, &i, &value)) return 1;
+                opts.quality = value;
+                break;
+            case 'R':
+                if (!parse_value(argc, argv, &i, &value)) return 1;
+                opts.redundancy = (int)value;
+                break;
+            case 'm':
+                opts.mmapInput = true;
+                break;
+            case 'r':
+                if (!parse_raw(argc, argv, &i, &opts)) return 1;
+                break;
+            case 'l':
+                if (i + 1 >= argc) {
+                    fprintf(stderr, "Missing value for %s\n", argv[i]);
+                    return 1;
+                }
+                manifest = argv[++i];
+                batch = true;
+                break;
+            case 'j':
+                if (!parse_value(argc, argv, &i, &value)) return 1;
+                workers = (int)value;
+                batch = true;
+                break;
+            case 't':
+                if (i + 1 >= argc) {
+                    fprintf(stderr, "Missing value for %s\n", argv[i]);
+                    return 1;
+                }
+                tracePath = argv[++i];
+                if (!rtpghi_trace_enabled()) {
+                    fprintf(stderr, "Tracing is not enabled in this build\n");
+                }
+                break;
+            case 'h':
+                usage(argv[0]);
+                return 0;
+            default:
+                fprintf(stderr, "Unknown option %s\n", argv[i]);
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if ((firstFile >= argc && !manifest) || (argc - firstFile) % 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (opts.stretch <= 0 || opts.blockLen <= 0 || opts.queueDepth <= 0) {
+        fprintf(stderr, "Stretch, block length and queue depth must be "
+                        "positive\n");
+        return 1;
+    }
+
+    if (opts.redundancy != 2 && opts.redundancy != 4 &&
+        opts.redundancy != 8) {
+        fprintf(stderr, "Redundancy must be 2, 4 or 8\n");
+        return 1;
+    }
+
+    int failed = 0;
+
+    if (batch) {
+        failed = run_batch(manifest, workers, argv + firstFile,
+                           argc - firstFile, opts);
+        firstFile = argc;
+    }
+
+    for (int i = firstFile; i < argc; i += 2) {
+        pipeline_stats_t stats;
+
+        if (!pipeline_run(argv[i], argv[i + 1], opts, &stats)) {
+            ++failed;
+            continue;
+        }
+
+        printf("%s -> %s: %d ch, %.2f s in, %.2f s out, %.2f s wall, "
+               "%.1fx realtime\n",
+               argv[i], argv[i + 1], stats.channels,
+               stats.inFrames / (double)stats.samplerate,
+               stats.outFrames / (double)stats.samplerate, stats.seconds,
+               stats.realtime_factor());
+    }
+
+    if (tracePath && rtpghi_trace_enabled() && !rtpghi_trace_dump(tracePath)) {
+        fprintf(stderr, "Not able to write trace %s\n", tracePath);
+        ++failed;
+    }
+
+    return failed ? 1 : 0;
+}
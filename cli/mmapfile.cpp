@@ -0,0 +1,197 @@
+#include "mmapfile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+mapped_audio_t::mapped_audio_t()
+    : _map(nullptr),
+      _mapLen(0),
+      _dataOffset(0),
+      _released(0),
+      _format(PCM_S16),
+      _channels(0),
+      _samplerate(0),
+      _frames(0) {}
+
+mapped_audio_t::~mapped_audio_t() { close(); }
+
+bool mapped_audio_t::map(const char *path) {
+    struct stat st;
+    int         fd;
+
+    close();
+
+    if ((fd = ::open(path, O_RDONLY | O_CLOEXEC)) < 0) {
+        fprintf(stderr, "Not able to open input file %s\n", path);
+        return false;
+    }
+
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        fprintf(stderr, "Input file %s is empty\n", path);
+        ::close(fd);
+        return false;
+    }
+
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (p == MAP_FAILED) {
+        fprintf(stderr, "Not able to map input file %s\n", path);
+        return false;
+    }
+
+    // The file is read once from start to end: aggressive read-ahead, and
+    // the pages can be dropped right after use.
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+
+    _map = static_cast<unsigned char *>(p);
+    _mapLen = st.st_size;
+    _released = 0;
+    return true;
+}
+
+void mapped_audio_t::close() {
+    if (_map) munmap(_map, _mapLen);
+    _map = nullptr;
+    _mapLen = 0;
+    _dataOffset = 0;
+    _released = 0;
+    _channels = 0;
+    _samplerate = 0;
+    _frames = 0;
+}
+
+static uint32_t load_le16(const unsigned char *p) { return p[0] | p[1] << 8; }
+
+static uint32_t load_le32(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+           (uint32_t)p[3] << 24;
+}
+
+bool mapped_audio_t::parse_wav() {
+    const uint32_t WAVE_FORMAT_PCM = 1;
+    const uint32_t WAVE_FORMAT_IEEE_FLOAT = 3;
+    const uint32_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+    bool     haveFmt = false;
+    uint32_t tag = 0, bits = 0, blockAlign = 0;
+
+    if (_mapLen < 12 || memcmp(_map, "RIFF", 4) || memcmp(_map + 8, "WAVE", 4))
+        return false;
+
+    size_t pos = 12;
+
+    while (pos + 8 <= _mapLen) {
+        const unsigned char *chunk = _map + pos;
+        size_t               size = load_le32(chunk + 4);
+
+        pos += 8;
+
+        if (!memcmp(chunk, "fmt ", 4)) {
+            if (size < 16 || pos + size > _mapLen) return false;
+
+            tag = load_le16(chunk + 8);
+            _channels = load_le16(chunk + 10);
+            _samplerate = load_le32(chunk + 12);
+            blockAlign = load_le16(chunk + 20);
+            bits = load_le16(chunk + 22);
+
+            // The actual format code is the start of the sub-format GUID
+            if (tag == WAVE_FORMAT_EXTENSIBLE) {
+                if (size < 40) return false;
+                tag = load_le16(chunk + 32);
+            }
+            haveFmt = true;
+        } else if (!memcmp(chunk, "data", 4)) {
+            if (!haveFmt) return false;
+
+            if (tag == WAVE_FORMAT_PCM && bits == 16) {
+                _format = PCM_S16;
+            } else if (tag == WAVE_FORMAT_PCM && bits == 24) {
+                _format = PCM_S24;
+            } else if (tag == WAVE_FORMAT_PCM && bits == 32) {
+                _format = PCM_S32;
+            } else if (tag == WAVE_FORMAT_IEEE_FLOAT && bits == 32) {
+                _format = PCM_F32;
+            } else if (tag == WAVE_FORMAT_IEEE_FLOAT && bits == 64) {
+                _format = PCM_F64;
+            } else {
+                return false;
+            }
+
+            if (_channels <= 0 ||
+                blockAlign != (uint32_t)_channels * pcm_sample_size(_format))
+                return false;
+
+            // Streamed or oversized files may not have a valid data size
+            if (size > _mapLen - pos) size = _mapLen - pos;
+
+            _dataOffset = pos;
+            _frames = size / blockAlign;
+            return true;
+        }
+
+        // Chunks are padded to an even size
+        pos += size + (size & 1);
+    }
+
+    return false;
+}
+
+bool mapped_audio_t::open_wav(const char *path) {
+    if (!map(path)) return false;
+
+    if (!parse_wav()) {
+        fprintf(stderr, "%s is not a PCM or float WAV file\n", path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool mapped_audio_t::open_raw(const char *path, pcm_format_t fmt,
+                              int channels, int samplerate) {
+    if (!map(path)) return false;
+
+    _format = fmt;
+    _channels = channels;
+    _samplerate = samplerate;
+    _dataOffset = 0;
+    _frames = _mapLen / (channels * pcm_sample_size(fmt));
+    return true;
+}
+
+pcm_format_t mapped_audio_t::get_format() const { return _format; }
+
+int mapped_audio_t::get_channels() const { return _channels; }
+
+int mapped_audio_t::get_samplerate() const { return _samplerate; }
+
+long long mapped_audio_t::get_frames() const { return _frames; }
+
+const void *mapped_audio_t::frame(long long n) const {
+    return _map + _dataOffset + n * _channels * pcm_sample_size(_format);
+}
+
+void mapped_audio_t::release(long long n) {
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+
+    size_t end = _dataOffset + n * _channels * pcm_sample_size(_format);
+    bool   last = n >= _frames;
+
+    // Up to the end of the mapping once all the frames are consumed
+    end = last ? _mapLen : end / pageSize * pageSize;
+
+    // Read-only file-backed pages: dropping them only costs a re-read. Batch
+    // the calls, one per MiB at most, and one for the rest at the end.
+    if (end > _released && (last || end >= _released + (1 << 20))) {
+        madvise(_map + _released, end - _released, MADV_DONTNEED);
+        _released = end;
+    }
+}
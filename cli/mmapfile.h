@@ -0,0 +1,66 @@
+#ifndef MMAPFILE_H__
+#define MMAPFILE_H__
+
+#include <cstddef>
+
+#include "pcm.h"
+
+/**
+ * Read-only memory mapping of an uncompressed PCM file.
+ *
+ * The samples are never copied: frame() points straight into the mapped
+ * pages, which the kernel reads ahead sequentially. Pages that were consumed
+ * are given back with release(), so that multi-gigabyte files do not stay
+ * resident.
+ */
+class mapped_audio_t final {
+   public:
+    mapped_audio_t();
+    ~mapped_audio_t();
+
+    mapped_audio_t(const mapped_audio_t &) = delete;
+    mapped_audio_t &operator=(const mapped_audio_t &) = delete;
+
+    /**
+     * Map a RIFF/WAVE file with integer or float PCM samples
+     * (16, 24, 32 bits integer, 32, 64 bits float, plain or extensible).
+     */
+    bool open_wav(const char *path);
+
+    /**
+     * Map a headerless file of interleaved little-endian samples.
+     */
+    bool open_raw(const char *path, pcm_format_t fmt, int channels,
+                  int samplerate);
+
+    void close();
+
+    pcm_format_t get_format() const;
+    int          get_channels() const;
+    int          get_samplerate() const;
+    long long    get_frames() const;
+
+    /** Address of frame n, 0 <= n <= get_frames() */
+    const void *frame(long long n) const;
+
+    /**
+     * Drop the pages holding frames before n from memory, and all the
+     * remaining ones once n reaches get_frames()
+     */
+    void release(long long n);
+
+   private:
+    bool map(const char *path);
+    bool parse_wav();
+
+    unsigned char *_map;         //!< Mapped file
+    size_t         _mapLen;      //!< Length of the mapping in bytes
+    size_t         _dataOffset;  //!< Offset of the first frame
+    size_t         _released;    //!< Bytes already released
+    pcm_format_t   _format;
+    int            _channels;
+    int            _samplerate;
+    long long      _frames;
+};
+
+#endif  // MMAPFILE_H__
@@ -0,0 +1,541 @@
+#include "pipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "audiofile.h"
+#include "boundedqueue.h"
+#include "mmapfile.h"
+#include "pv.h"
+
+/**
+ * Planar block of audio passed between the stages. An empty block marks the
+ * end of the stream.
+ */
+struct audio_block_t {
+    std::vector<double> data;    //!< channels x frames, planar
+    int                 frames;  //!< Number of frames
+};
+
+using block_queue_t = bounded_queue_t<audio_block_t>;
+
+double pipeline_stats_t::realtime_factor() const {
+    if (seconds <= 0 || samplerate <= 0) return 0;
+    return inFrames / (double)samplerate / seconds;
+}
+
+/**
+ * Reads the input file as planar blocks of at most blockLen frames.
+ */
+class decoder_t final {
+   public:
+    decoder_t(audio_reader_t *reader, int blockLen, long long *inFrames)
+        : _reader(reader),
+          _interleaved(blockLen * reader->get_info().channels),
+          _inFrames(inFrames),
+          _channels(reader->get_info().channels),
+          _blockLen(blockLen) {}
+
+    /** Returns false at the end of the file */
+    bool pop(audio_block_t &block) {
+        int frames = _reader->read(_interleaved.data(), _blockLen);
+
+        if (frames <= 0) return false;
+
+        block.data.resize(frames * _channels);
+        block.frames = frames;
+
+        for (int w = 0; w < _channels; ++w) {
+            for (int ii = 0; ii < frames; ++ii) {
+                block.data[w * frames + ii] = _interleaved[ii * _channels + w];
+            }
+        }
+
+        *_inFrames += frames;
+        return true;
+    }
+
+   private:
+    audio_reader_t     *_reader;
+    std::vector<double> _interleaved;
+    long long          *_inFrames;
+    int                 _channels;
+    int                 _blockLen;
+};
+
+/**
+ * Writes planar blocks to the output file.
+ */
+class encoder_t final {
+   public:
+    encoder_t(audio_writer_t *writer, int channels, long long *outFrames)
+        : _writer(writer), _outFrames(outFrames), _channels(channels) {}
+
+    bool push(audio_block_t &&block) {
+        _interleaved.resize(block.frames * _channels);
+
+        for (int w = 0; w < _channels; ++w) {
+            for (int ii = 0; ii < block.frames; ++ii) {
+                _interleaved[ii * _channels + w] =
+                    block.data[w * block.frames + ii];
+            }
+        }
+
+        *_outFrames += _writer->write(_interleaved.data(), block.frames);
+        return true;
+    }
+
+   private:
+    audio_writer_t     *_writer;
+    std::vector<double> _interleaved;
+    long long          *_outFrames;
+    int                 _channels;
+};
+
+static void decode_stage(decoder_t *decoder, block_queue_t *out) {
+    audio_block_t block;
+
+    while (decoder->pop(block)) {
+        if (!out->push(std::move(block))) break;
+    }
+
+    out->push(audio_block_t{{}, 0});
+}
+
+static void encode_stage(encoder_t *encoder, block_queue_t *in) {
+    audio_block_t block;
+
+    while (in->pop(block) && block.frames > 0) {
+        encoder->push(std::move(block));
+    }
+}
+
+/**
+ * Planar staging buffer between the variable-size decoder blocks and the
+ * input lengths requested by pv_t.
+ */
+class staging_buf_t final {
+   public:
+    staging_buf_t(int channels, int capacity)
+        : _buf(channels * capacity),
+          _ptrs(channels),
+          _channels(channels),
+          _capacity(capacity),
+          _len(0),
+          _eof(false) {
+        for (int w = 0; w < channels; ++w) _ptrs[w] = &_buf[w * capacity];
+    }
+
+    /** Make len frames available, padding with zeros past the end */
+    template <typename Blocks>
+    void fill(int len, Blocks *in) {
+        audio_block_t block;
+
+        while (_len < len && !_eof) {
+            if (!in->pop(block) || block.frames == 0) {
+                _eof = true;
+                break;
+            }
+            // Blocks are never longer than the spare capacity
+            for (int w = 0; w < _channels; ++w) {
+                std::copy(block.data.begin() + w * block.frames,
+                          block.data.begin() + (w + 1) * block.frames,
+                          _buf.begin() + w * _capacity + _len);
+            }
+            _len += block.frames;
+        }
+
+        if (_len < len) {
+            for (int w = 0; w < _channels; ++w) {
+                std::fill(_ptrs[w] + _len, _ptrs[w] + len, 0);
+            }
+            _len = len;
+        }
+    }
+
+    /** Drop the first len frames */
+    void consume(int len) {
+        for (int w = 0; w < _channels; ++w) {
+            std::copy(_ptrs[w] + len, _ptrs[w] + _len, _ptrs[w]);
+        }
+        _len -= len;
+    }
+
+    const double **get_ptrs() {
+        return const_cast<const double **>(_ptrs.data());
+    }
+
+    bool eof() const { return _eof; }
+
+   private:
+    std::vector<double>   _buf;
+    std::vector<double *> _ptrs;
+    int                   _channels;
+    int                   _capacity;
+    int                   _len;
+    bool                  _eof;
+};
+
+/**
+ * Input of the processing stage fed with decoded blocks, either from the
+ * decoder thread (block_queue_t) or decoded inline (decoder_t).
+ */
+template <typename Blocks>
+class stream_source_t final {
+   public:
+    stream_source_t(int channels, int bufLenMax, int blockLen, Blocks *in,
+                    const long long *inFrames)
+        : _stage(channels, bufLenMax + blockLen),
+          _in(in),
+          _inFrames(inFrames),
+          _channels(channels) {}
+
+    int execute(pv_t &pv, int inLen, double stretch, int outLen,
+                double **out) {
+        _stage.fill(inLen, _in);
+
+        int got = pv.execute(_stage.get_ptrs(), inLen, _channels, stretch,
+                             outLen, out);
+        _stage.consume(inLen);
+        return got;
+    }
+
+    bool eof() const { return _stage.eof(); }
+
+    /** Total number of input frames, once eof() */
+    long long frames() const { return *_inFrames; }
+
+   private:
+    staging_buf_t    _stage;
+    Blocks          *_in;
+    const long long *_inFrames;
+    int              _channels;
+};
+
+/**
+ * Input of the processing stage read straight from a mapped file.
+ */
+class mapped_source_t final {
+   public:
+    mapped_source_t(mapped_audio_t *file, int bufLenMax)
+        : _file(file),
+          _zeros(bufLenMax, 0),
+          _zeroPtrs(file->get_channels(), _zeros.data()),
+          _pos(0) {}
+
+    int execute(pv_t &pv, int inLen, double stretch, int outLen,
+                double **out) {
+        int channels = _file->get_channels();
+        int avail = (int)std::min<long long>(inLen, frames() - _pos);
+
+        // Past the end, the input is padded with zeros
+        if (avail < inLen) {
+            pv.execute_interleaved(_file->frame(_pos), _file->get_format(),
+                                   avail, channels, stretch, 0, out);
+            _pos += avail;
+            _file->release(_pos);
+            return pv.execute(_zeroPtrs.data(), inLen - avail, channels,
+                              stretch, outLen, out);
+        }
+
+        int got = pv.execute_interleaved(_file->frame(_pos),
+                                         _file->get_format(), inLen, channels,
+                                         stretch, outLen, out);
+        _pos += inLen;
+        _file->release(_pos);
+        return got;
+    }
+
+    bool eof() const { return _pos >= frames(); }
+
+    long long frames() const { return _file->get_frames(); }
+
+   private:
+    mapped_audio_t             *_file;
+    std::vector<double>         _zeros;
+    std::vector<const double *> _zeroPtrs;
+    long long                   _pos;
+};
+
+/**
+ * Stretch the input of src into blocks pushed to out, compensating for the
+ * processing latency.
+ */
+template <typename Source, typename Sink>
+static void process_stage(Source *src, pv_t *pv, int channels, int bufLenMax,
+                          const pipeline_opts_t &opts, Sink *out) {
+    int    blockLen = opts.blockLen;
+    double stretch = opts.stretch;
+
+    std::vector<double>   outbuf(channels * blockLen);
+    std::vector<double *> outPtrs(channels);
+    for (int w = 0; w < channels; ++w) outPtrs[w] = &outbuf[w * blockLen];
+
+    // Align the output with the stretched input: a positive latency is
+    // skipped, a negative one is padded with zeros
+    int       latency = pv->get_latency();
+    long long skip = std::max(latency, 0);
+    long long pad = std::max(-latency, 0);
+    long long emitted = 0;
+
+    for (;;) {
+        int inLen = std::min((int)pv->next_inlen(blockLen), bufLenMax);
+
+        int got = src->execute(*pv, inLen, stretch, blockLen, outPtrs.data());
+
+        int offset = (int)std::min<long long>(skip, got);
+        skip -= offset;
+        got -= offset;
+
+        // The padding goes first, and counts towards the total length
+        long long len = pad + got;
+        bool      done = false;
+
+        // Past its end the input is padded with zeros, so a short input
+        // keeps going through blocks eaten by skip until the total length
+        if (src->eof()) {
+            // The input is exhausted, so the total length is final
+            long long target = std::llround(src->frames() * stretch);
+            len = std::max<long long>(std::min(len, target - emitted), 0);
+            done = emitted + len >= target;
+        }
+
+        if (len > 0) {
+            int zeros = (int)std::min(pad, len);
+            int frames = (int)len;
+
+            audio_block_t block{std::vector<double>(channels * frames, 0),
+                                frames};
+            for (int w = 0; w < channels; ++w) {
+                std::copy(outPtrs[w] + offset,
+                          outPtrs[w] + offset + (frames - zeros),
+                          block.data.begin() + w * frames + zeros);
+            }
+            pad -= zeros;
+            emitted += frames;
+            out->push(std::move(block));
+        }
+
+        if (done) break;
+    }
+
+    out->push(audio_block_t{{}, 0});
+}
+
+/**
+ * Largest input length pv_t is asked for when producing blockLen frames.
+ */
+static int max_inlen(const pipeline_opts_t &opts) {
+    // Shrinking needs more input per output block
+    return (int)std::ceil(opts.blockLen / std::min(opts.stretch, 1.0)) + 1;
+}
+
+/**
+ * libsndfile format of a mapped input file.
+ */
+static int mapped_sf_format(const mapped_audio_t &file, bool raw) {
+    int major = raw ? SF_FORMAT_RAW : SF_FORMAT_WAV;
+
+    switch (file.get_format()) {
+        case PCM_S16:
+            return major | SF_FORMAT_PCM_16;
+        case PCM_S24:
+            return major | SF_FORMAT_PCM_24;
+        case PCM_S32:
+            return major | SF_FORMAT_PCM_32;
+        case PCM_F32:
+            return major | SF_FORMAT_FLOAT;
+        case PCM_F64:
+            return major | SF_FORMAT_DOUBLE;
+    }
+    return major;
+}
+
+pv_cache_t::pv_cache_t() : _created(0) {}
+
+pv_cache_t::~pv_cache_t() = default;
+
+pv_t *pv_cache_t::get(int channels, double stretch, int bufLenMax,
+                      int redundancy) {
+    entry_t &e = _entries[channels];
+    double   stretchMax = std::max(stretch, 1.0);
+
+    if (e.pv && e.stretchMax >= stretchMax && e.bufLenMax >= bufLenMax &&
+        e.redundancy == redundancy) {
+        e.pv->reset();
+    } else {
+        // Grow to cover both the previous and the new requirements
+        e.stretchMax = std::max(e.stretchMax, stretchMax);
+        e.bufLenMax = std::max(e.bufLenMax, bufLenMax);
+        e.redundancy = redundancy;
+        e.pv.reset();
+        e.pv = std::make_unique<pv_t>(e.stretchMax, channels, e.bufLenMax,
+                                      pv_config_redundancy(redundancy));
+        ++_created;
+    }
+
+    return e.pv.get();
+}
+
+int pv_cache_t::get_created() const { return _created; }
+
+/**
+ * pv_t for one file, from the cache if there is one.
+ */
+static pv_t *acquire_pv(pv_cache_t *cache, std::unique_ptr<pv_t> *own,
+                        int channels, const pipeline_opts_t &opts) {
+    int   bufLenMax = max_inlen(opts);
+    pv_t *pv;
+
+    if (cache) {
+        pv = cache->get(channels, opts.stretch, bufLenMax, opts.redundancy);
+    } else {
+        *own = std::make_unique<pv_t>(std::max(opts.stretch, 1.0), channels,
+                                      bufLenMax,
+                                      pv_config_redundancy(opts.redundancy));
+        pv = own->get();
+    }
+
+    pv->set_stretch(opts.stretch);
+    return pv;
+}
+
+static bool run_mapped(const char *inPath, const char *outPath,
+                       const pipeline_opts_t &opts, pv_cache_t *cache,
+                       pipeline_stats_t *st) {
+    mapped_audio_t        file;
+    audio_writer_t        writer;
+    std::unique_ptr<pv_t> own;
+    bool                  raw = opts.rawChannels > 0;
+
+    if (raw ? !file.open_raw(inPath, opts.rawFormat, opts.rawChannels,
+                             opts.rawSamplerate)
+            : !file.open_wav(inPath)) {
+        return false;
+    }
+
+    if (!writer.open(outPath, file.get_channels(), file.get_samplerate(),
+                     mapped_sf_format(file, raw), opts.quality)) {
+        return false;
+    }
+
+    int channels = file.get_channels();
+    int bufLenMax = max_inlen(opts);
+
+    st->channels = channels;
+    st->samplerate = file.get_samplerate();
+    st->inFrames = file.get_frames();
+
+    pv_t           *pv = acquire_pv(cache, &own, channels, opts);
+    mapped_source_t src(&file, bufLenMax);
+    encoder_t       encoder(&writer, channels, &st->outFrames);
+
+    if (cache) {
+        process_stage(&src, pv, channels, bufLenMax, opts, &encoder);
+        return true;
+    }
+
+    block_queue_t processed(opts.queueDepth);
+
+    // No decoder: the processing stage reads the mapped pages directly.
+    std::thread processor([&] {
+        process_stage(&src, pv, channels, bufLenMax, opts, &processed);
+    });
+
+    encode_stage(&encoder, &processed);
+
+    processor.join();
+
+    return true;
+}
+
+static bool run_decoded(const char *inPath, const char *outPath,
+                        const pipeline_opts_t &opts, pv_cache_t *cache,
+                        pipeline_stats_t *st) {
+    audio_reader_t        reader;
+    audio_writer_t        writer;
+    std::unique_ptr<pv_t> own;
+
+    if (!reader.open(inPath)) return false;
+
+    const SF_INFO &info = reader.get_info();
+
+    if (!writer.open(outPath, info.channels, info.samplerate, info.format,
+                     opts.quality)) {
+        return false;
+    }
+
+    int channels = info.channels;
+    int bufLenMax = max_inlen(opts);
+
+    st->channels = channels;
+    st->samplerate = info.samplerate;
+
+    pv_t     *pv = acquire_pv(cache, &own, channels, opts);
+    decoder_t decoder(&reader, opts.blockLen, &st->inFrames);
+    encoder_t encoder(&writer, channels, &st->outFrames);
+
+    if (cache) {
+        stream_source_t<decoder_t> src(channels, bufLenMax, opts.blockLen,
+                                       &decoder, &st->inFrames);
+        process_stage(&src, pv, channels, bufLenMax, opts, &encoder);
+        return true;
+    }
+
+    block_queue_t decoded(opts.queueDepth);
+    block_queue_t processed(opts.queueDepth);
+
+    // inFrames is only read by the processing stage once the decoder has
+    // pushed its end marker, the queue provides the ordering.
+    std::thread decoderThread(decode_stage, &decoder, &decoded);
+    std::thread processor([&] {
+        stream_source_t<block_queue_t> src(channels, bufLenMax, opts.blockLen,
+                                           &decoded, &st->inFrames);
+        process_stage(&src, pv, channels, bufLenMax, opts, &processed);
+    });
+
+    encode_stage(&encoder, &processed);
+
+    processor.join();
+    decoderThread.join();
+
+    return true;
+}
+
+static bool run(const char *inPath, const char *outPath,
+                const pipeline_opts_t &opts, pv_cache_t *cache,
+                pipeline_stats_t *stats) {
+    pipeline_stats_t st;
+    bool             ok;
+
+    auto start = std::chrono::steady_clock::now();
+
+    if (opts.mmapInput || opts.rawChannels > 0) {
+        ok = run_mapped(inPath, outPath, opts, cache, &st);
+    } else {
+        ok = run_decoded(inPath, outPath, opts, cache, &st);
+    }
+
+    st.seconds = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+    if (stats) *stats = st;
+
+    return ok;
+}
+
+bool pipeline_run(const char *inPath, const char *outPath,
+                  const pipeline_opts_t &opts, pipeline_stats_t *stats) {
+    return run(inPath, outPath, opts, nullptr, stats);
+}
+
+bool pipeline_run_serial(const char *inPath, const char *outPath,
+                         const pipeline_opts_t &opts, pv_cache_t *cache,
+                         pipeline_stats_t *stats) {
+    return run(inPath, outPath, opts, cache, stats);
+}
@@ -0,0 +1,104 @@
+#ifndef PIPELINE_H__
+#define PIPELINE_H__
+
+#include <map>
+#include <memory>
+
+#include "pcm.h"
+#include "pv.h"
+
+/**
+ * Options of the decode/process/encode pipeline.
+ */
+struct pipeline_opts_t {
+    double stretch = 1.0;    //!< Time stretch factor
+    int    blockLen = 1024;  //!< Frames per block passed between stages
+    int    queueDepth = 8;   //!< Blocks buffered between two stages
+    double quality = -1.0;   //!< Encoder quality in [0,1], negative: default
+    int    redundancy = 8;   //!< M/a, see pv_config_redundancy()
+
+    /** Memory-map the input instead of decoding it, PCM/float WAV only */
+    bool mmapInput = false;
+
+    /** Headerless input, mapped like mmapInput. Ignored if rawChannels is 0 */
+    int          rawChannels = 0;
+    int          rawSamplerate = 44100;
+    pcm_format_t rawFormat = PCM_S16;
+};
+
+/**
+ * Statistics of one processed file.
+ */
+struct pipeline_stats_t {
+    long long inFrames = 0;    //!< Decoded frames
+    long long outFrames = 0;   //!< Encoded frames
+    int       channels = 0;    //!< Number of channels
+    int       samplerate = 0;  //!< Sample rate
+    double    seconds = 0.0;   //!< Wall clock time
+
+    /** Seconds of input audio processed per second of wall clock time */
+    double realtime_factor() const;
+};
+
+/**
+ * Stretch one file with decoding, processing and encoding running as three
+ * threads connected by bounded queues.
+ *
+ * The output is compensated for the processing latency and is exactly
+ * round(inFrames * stretch) frames long.
+ *
+ * \param[in]   inPath   Input file, any format libsndfile can decode, or a
+ *                       PCM WAV/RAW file if the input is memory-mapped
+ * \param[in]   outPath  Output file, format picked from the extension
+ * \param[in]   opts     Pipeline options
+ * \param[out]  stats    Statistics, may be nullptr
+ *
+ * \returns false if a file could not be opened
+ */
+bool pipeline_run(const char *inPath, const char *outPath,
+                  const pipeline_opts_t &opts, pipeline_stats_t *stats);
+
+/**
+ * pv_t instances kept by one thread across files, so that buffers and FFT
+ * plans are created once per channel count instead of once per file.
+ */
+class pv_cache_t final {
+   public:
+    pv_cache_t();
+    ~pv_cache_t();
+
+    pv_cache_t(const pv_cache_t &) = delete;
+    pv_cache_t &operator=(const pv_cache_t &) = delete;
+
+    /**
+     * Instance for channels channels able to stretch by stretch with input
+     * blocks of up to bufLenMax frames, in its initial state. An instance
+     * too small for the request, or with another redundancy, is replaced.
+     */
+    pv_t *get(int channels, double stretch, int bufLenMax, int redundancy);
+
+    /** Number of instances constructed so far */
+    int get_created() const;
+
+   private:
+    struct entry_t {
+        std::unique_ptr<pv_t> pv;
+        double                stretchMax = 0.0;
+        int                   bufLenMax = 0;
+        int                   redundancy = 0;
+    };
+
+    std::map<int, entry_t> _entries;  //!< By channel count
+    int                    _created;
+};
+
+/**
+ * Same as pipeline_run(), but decoding, processing and encoding all run in
+ * the calling thread, with a pv_t taken from cache. Meant for running many
+ * files in parallel.
+ */
+bool pipeline_run_serial(const char *inPath, const char *outPath,
+                         const pipeline_opts_t &opts, pv_cache_t *cache,
+                         pipeline_stats_t *stats);
+
+#endif  // PIPELINE_H__
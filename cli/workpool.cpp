@@ -0,0 +1,70 @@
+#include "workpool.h"
+
+#include <thread>
+
+work_stealing_pool_t::work_stealing_pool_t(int numWorkers) : _steals(0) {
+    for (int w = 0; w < numWorkers; ++w) {
+        _deques.push_back(std::make_unique<deque_t>());
+    }
+}
+
+int work_stealing_pool_t::get_numworkers() const { return _deques.size(); }
+
+void work_stealing_pool_t::submit(int worker, task_t task) {
+    deque_t &d = *_deques[worker];
+
+    std::lock_guard<std::mutex> lock(d.mutex);
+    d.tasks.push_back(std::move(task));
+}
+
+bool work_stealing_pool_t::pop(int worker, task_t *task) {
+    deque_t &d = *_deques[worker];
+
+    std::lock_guard<std::mutex> lock(d.mutex);
+    if (d.tasks.empty()) return false;
+    *task = std::move(d.tasks.front());
+    d.tasks.pop_front();
+    return true;
+}
+
+bool work_stealing_pool_t::steal(int worker, task_t *task) {
+    int numWorkers = _deques.size();
+
+    // Start with the neighbour so that the thieves spread out
+    for (int ii = 1; ii < numWorkers; ++ii) {
+        deque_t &d = *_deques[(worker + ii) % numWorkers];
+
+        std::lock_guard<std::mutex> lock(d.mutex);
+        if (d.tasks.empty()) continue;
+        *task = std::move(d.tasks.back());
+        d.tasks.pop_back();
+        ++_steals;
+        return true;
+    }
+    return false;
+}
+
+void work_stealing_pool_t::work(int worker) {
+    task_t task;
+
+    // No task is submitted while running: once nothing can be stolen, the
+    // pool is drained.
+    while (pop(worker, &task) || steal(worker, &task)) {
+        task(worker);
+    }
+}
+
+void work_stealing_pool_t::run() {
+    std::vector<std::thread> threads;
+
+    for (int w = 1; w < get_numworkers(); ++w) {
+        threads.emplace_back(&work_stealing_pool_t::work, this, w);
+    }
+
+    // The calling thread is worker 0
+    work(0);
+
+    for (auto &t : threads) t.join();
+}
+
+long work_stealing_pool_t::get_steals() const { return _steals; }
@@ -0,0 +1,51 @@
+#ifndef WORKPOOL_H__
+#define WORKPOOL_H__
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Work-stealing thread pool for a known set of tasks.
+ *
+ * Every worker owns a deque. It takes tasks from the front of its own deque
+ * and, once that is empty, steals from the back of the others, so that a
+ * worker stuck on a long task does not hold up the short ones queued behind
+ * it.
+ */
+class work_stealing_pool_t final {
+   public:
+    /** Task, called with the index of the worker running it */
+    using task_t = std::function<void(int worker)>;
+
+    explicit work_stealing_pool_t(int numWorkers);
+
+    int get_numworkers() const;
+
+    /** Queue task on the deque of worker, before run() */
+    void submit(int worker, task_t task);
+
+    /** Run all queued tasks, returns once they are all done */
+    void run();
+
+    /** Tasks run by another worker than the one they were queued on */
+    long get_steals() const;
+
+   private:
+    struct deque_t {
+        std::mutex         mutex;
+        std::deque<task_t> tasks;
+    };
+
+    bool pop(int worker, task_t *task);
+    bool steal(int worker, task_t *task);
+    void work(int worker);
+
+    std::vector<std::unique_ptr<deque_t>> _deques;  //!< One per worker
+    std::atomic<long>                     _steals;
+};
+
+#endif  // WORKPOOL_H__
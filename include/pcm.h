@@ -0,0 +1,20 @@
+#ifndef PCM_H__
+#define PCM_H__
+
+/**
+ * Sample formats of PCM buffers. Multi-byte samples are little-endian.
+ */
+enum pcm_format_t {
+    PCM_S16,  //!< 16-bit signed integer
+    PCM_S24,  //!< 24-bit signed integer, packed in 3 bytes
+    PCM_S32,  //!< 32-bit signed integer
+    PCM_F32,  //!< 32-bit IEEE float
+    PCM_F64,  //!< 64-bit IEEE float
+};
+
+/**
+ * Size of one sample in bytes.
+ */
+int pcm_sample_size(pcm_format_t fmt);
+
+#endif  // PCM_H__
@@ -2,6 +2,89 @@
 #define PV_H__
 
 #include <cstddef>
+#include <cstdint>
+
+#include "firwin.h"
+#include "pcm.h"
+#include "rtdgtrealproc.h"
+#include "rtpghi.h"
+
+/**
+ * Input source of pv_t::pull().
+ *
+ * \param[in]   userdata  User defined data
+ * \param[out]  buf       Channels to be filled, len samples each
+ * \param[in]   len       Number of samples requested
+ * \param[in]   chan      Number of channels
+ *
+ * \returns Number of samples written, less than len at the end of the input
+ */
+using pv_reader_t = int(void* userdata, double* buf[], int len, int chan);
+
+/**
+ * Transform configuration of pv_t.
+ *
+ * The window may be longer than the FFT (winLen > fftLen): the frames are
+ * then folded before the FFT, and the dual window is the least energy dual
+ * supported on winLen samples. Such a dual does not exist for every
+ * configuration (e.g. a Hann window four times as long as the FFT), see
+ * pv_config_valid().
+ */
+struct pv_config_t {
+    int      winLen = 4096;         //!< Window length
+    int      fftLen = 8192;         //!< FFT length
+    int      hop = 1024;            //!< Synthesis hop
+    firwin_t window = FIRWIN_HANN;  //!< Window of winLen samples
+    /**
+     * If positive, use the Gaussian matched to the hop and the FFT length,
+     * truncated where it falls below gaussThr (see mtgauss()) instead;
+     * winLen and window are then ignored.
+     */
+    double gaussThr = 0.0;
+    /**
+     * Synthesize each frame as soon as it is analysed, with a time gradient
+     * from the hop before it only (see rtpghi_t::set_causal()). This removes
+     * one hop of latency.
+     */
+    bool causal = false;
+    /**
+     * Relative tolerance of the phase reconstruction (see
+     * rtpghi_t::set_tolerance()): coefficients below tol times the largest
+     * one of the frame get a random phase instead of an integrated one.
+     * Larger values skip more of the integration.
+     */
+    double tol = 1e-6;
+    /**
+     * Use the exact analysis hop hop / stretch, read at fractional
+     * positions (see rtdgtreal_processor_t::set_anaa()), instead of
+     * rounding it to an integer. Without it the achievable stretch factors
+     * are hop / k for integer k, coarse for small hops: with hop = 128, 1.5
+     * becomes 128 / 85 = 1.506.
+     */
+    bool fractionalHop = false;
+};
+
+/**
+ * Configuration with M/a = redundancy, 8 (the default configuration), 4 or
+ * 2. Fewer frames or shorter FFTs make lower redundancies cheaper; their
+ * windows are the lattice matched Gaussians that gave the lowest phase
+ * reconstruction error at each redundancy. Any other redundancy aborts.
+ */
+pv_config_t pv_config_redundancy(int redundancy);
+
+/**
+ * FFT work per output sample and channel: one forward and one inverse
+ * transform per synthesis hop, 2.5 M log2(M) flops each (the conventional
+ * count of a real FFT). It does not depend on the stretch.
+ */
+double pv_config_fft_cost(const pv_config_t& config);
+
+/**
+ * Whether pv_t can be constructed with config: the lengths are positive and
+ * a dual window with the support of the window exists. The constructor
+ * aborts otherwise.
+ */
+bool pv_config_valid(const pv_config_t& config);
 
 /**
  * Implementation class of PV.
@@ -15,10 +98,21 @@ class pv_t final {
    public:
     pv_t(double stretchmax, int Wmax, int buflenMax);
 
+    pv_t(double stretchmax, int Wmax, int buflenMax, const pv_config_t& config);
+
     ~pv_t();
 
     int get_procdelay() const;
 
+    /**
+     * Output delay in samples at the current stretch.
+     *
+     * Output sample latency + n*stretch corresponds to input sample n.
+     * Negative if the first output samples already correspond to a later
+     * part of the input.
+     */
+    int get_latency() const;
+
     void print_pos() const;
 
     size_t next_inlen(size_t Lout) const;
@@ -29,11 +123,191 @@ class pv_t final {
 
     void set_stretch(double stretch);
 
-    void execute(const double* in[], int Lin, int chan, double stretch,
-                 int Lout, double* out[]);
+    /**
+     * Run the processing functions with subnormal numbers flushed to zero
+     * (FTZ/DAZ on x86, FZ on AArch64). The floating-point state of the
+     * calling thread is restored before they return. Decaying tails and
+     * near-silent input otherwise produce subnormals in the FFTs, the phase
+     * reconstruction and the overlap-add, which can make a frame many times
+     * slower. Off by default.
+     *
+     * The reader of pull() also runs with this state.
+     */
+    void set_flush_denormals(bool enable);
+
+    bool get_flush_denormals() const;
+
+    /**
+     * Pipeline the analysis, the phase reconstruction and the synthesis of
+     * consecutive frames on up to 3 threads, see
+     * rtdgtreal_processor_t::set_pipeline_stages(). The output is the same;
+     * it is faster when each call has many frames to process, i.e. for
+     * offline processing with large blocks (bufLenMax of many hops). Not
+     * real-time safe. 1 (the default) disables it.
+     */
+    void set_pipeline_stages(int stages);
+
+    int get_pipeline_stages() const;
+
+    /**
+     * Transform up to frames frames at once when a call has several to
+     * process, see rtdgtreal_processor_t::set_batch_frames(). The output is
+     * the same. 1 (the default) disables it. Allocates.
+     */
+    void set_batch_frames(int frames);
+
+    int get_batch_frames() const;
+
+    /**
+     * Reconstruct the phase of all channels at once, from their sum or
+     * from the largest coefficient of each bin, keeping the phase
+     * differences between them (see rtpghi_t::set_channel_link()). This
+     * about halves the phase reconstruction cost of stereo and keeps its
+     * image. RTPGHI_LINK_NONE (the default) treats every channel on its
+     * own.
+     */
+    void set_channel_link(rtpghi_link_t link);
+
+    rtpghi_link_t get_channel_link() const;
+
+    /**
+     * Replace the processing of every frame, the phase reconstruction by
+     * default, with callback, typically a spectral_chain_t (see
+     * include/spectral_chain.h) with the phase reconstruction as one of its
+     * stages. A null callback restores the default. Takes effect at the
+     * next frame; the callback runs on the thread that processes the frames
+     * (see set_pipeline_stages()).
+     */
+    void set_frame_callback(rtdgtreal_processor_callback* callback,
+                            void*                         userdata);
+
+    /**
+     * Reconstruct the phase of one frame at the current stretch, what is
+     * done to every frame by default. Only to be called from the frame
+     * callback, once per frame.
+     *
+     * \param[in]   in      Input coefficients, M/2+1 x chan array
+     * \param[out]  out     Output coefficients, same layout
+     */
+    void reconstruct_phase(const std::complex<double>* in,
+                           std::complex<double>*       out);
+
+    /**
+     * Add TPDF dither when quantizing integer PCM output, see execute_pcm().
+     * On by default; turn it off for bit-exact round trips.
+     */
+    void set_dither(bool enable);
+
+    bool get_dither() const;
+
+    /**
+     * Return to the state right after construction, so that the instance
+     * (and its FFT plans) can be reused for another stream: the buffers,
+     * the positions and the stretch, and the random phases of the phase
+     * reconstruction, so that the same input gives the same output again.
+     * Does not allocate. The settings of the set_ functions are kept, see
+     * pv_pool_t for an instance with the default ones.
+     */
+    void reset();
+
+    /**
+     * Process Lin input samples and read up to Lout output samples.
+     *
+     * \returns Number of output samples produced, the remaining samples of
+     * out are set to zero.
+     */
+    int execute(const double* in[], int Lin, int chan, double stretch,
+                int Lout, double* out[]);
+
+    int execute_compact(const double* in, int Lin, int chan, double stretch,
+                        int Lout, double* out);
+
+    /**
+     * Same as execute(), but the input is interleaved PCM in format fmt, for
+     * instance a memory-mapped file. Samples are converted while they are
+     * copied into the analysis FIFO, no intermediate buffer is needed.
+     */
+    int execute_interleaved(const void* in, pcm_format_t fmt, int Lin,
+                            int chan, double stretch, int Lout, double* out[]);
+
+    /**
+     * Same as execute(), but in and out are planar PCM in format fmt. The
+     * input is converted while it is copied into the analysis FIFO and the
+     * output while it is read from the synthesis FIFO, so no scratch
+     * buffers or extra passes are needed. Integer output is dithered (see
+     * set_dither()) and saturated.
+     */
+    int execute_pcm(const void* const in[], pcm_format_t fmt, int Lin,
+                    int chan, double stretch, int Lout, void* const out[]);
+
+    /**
+     * Typed shorthands for execute_pcm(), for PCM_S16, PCM_S32 and PCM_F32.
+     */
+    int execute(const int16_t* in[], int Lin, int chan, double stretch,
+                int Lout, int16_t* out[]);
+
+    int execute(const int32_t* in[], int Lin, int chan, double stretch,
+                int Lout, int32_t* out[]);
+
+    int execute(const float* in[], int Lin, int chan, double stretch,
+                int Lout, float* out[]);
+
+    /**
+     * Produce exactly Lout output samples, pulling input on demand.
+     *
+     * reader is only called when the next analysis frame needs more input,
+     * and writes straight into the analysis FIFO. Past the end of the input
+     * (reader returning less than asked), silence is used. Unlike execute(),
+     * there is no need for next_inlen(), advance_by() or input buffers, and
+     * Lout is not limited by bufLenMax.
+     *
+     * \returns Number of input samples consumed, including that silence
+     */
+    int pull(double* out[], int Lout, int chan, double stretch,
+             pv_reader_t* reader, void* userdata);
+
+    /**
+     * Number of input samples before the target that seek() reads at this
+     * stretch.
+     */
+    int get_seek_preroll(double stretch) const;
+
+    /**
+     * Start again at another position of the input, for pull(): the
+     * output of the next pull() starts at the target, with the overlap-add
+     * and the phase reconstruction already in their steady state, instead
+     * of fading in after get_latency() samples as it does after reset().
+     *
+     * reader is read from get_seek_preroll(stretch) samples before the
+     * target (silence before the start of the input), then as far after it
+     * as the frames that reach the target need. These frames are processed
+     * in one pass, and those whose output lies entirely before the target
+     * are not synthesized. Resets the instance first.
+     *
+     * \returns Number of input samples read, as pull()
+     */
+    int seek(pv_reader_t* reader, void* userdata, int chan, double stretch);
+
+    /**
+     * Snapshot of the whole processing state: the FIFOs, the phase
+     * reconstruction history and its random generator, the positions and
+     * the stretch, get_state_size() bytes. load_state() returns to it
+     * exactly, so that the same input then gives the same output, e.g. to
+     * jump back for A/B loops. The snapshot can be stored, but only loaded
+     * by the same build into an instance constructed with the same
+     * arguments. The settings and the frame callback are not part of it.
+     * Neither function allocates.
+     */
+    size_t get_state_size() const;
+
+    void save_state(void* buf) const;
 
-    void execute_compact(const double* in, int Lin, int chan, double stretch,
-                         int Lout, double* out);
+    /**
+     * \returns false, and the instance is left unchanged, if buf does not
+     * start with the header of a pv_t snapshot of get_state_size() bytes,
+     * e.g. one saved by an instance with another number of channels
+     */
+    bool load_state(const void* buf);
 
    private:
     pv_priv* _p;
@@ -0,0 +1,82 @@
+#ifndef PV_ENGINE_H__
+#define PV_ENGINE_H__
+
+#include <cstddef>
+
+/**
+ * Implementation class of pv_engine.
+ */
+template <int M, int gl, int a, int W>
+class pv_engine_priv;
+
+/**
+ * Phase vocoder with the transform configuration fixed at compile time.
+ *
+ * Processes like pv_t with a Hann window of gl samples, M frequency
+ * channels, a synthesis hop of a samples and W channels, and produces the
+ * same output. The window tables are shared by all instances, the buffers
+ * have fixed sizes and the per-frame loops have constant trip counts, so
+ * the compiler can unroll and vectorize them.
+ *
+ * Only the configurations instantiated at the end of src/pv_engine.cpp are
+ * available; the default pv_config_t is M = 8192, gl = 4096 and a = 1024.
+ */
+template <int M, int gl, int a, int W>
+class pv_engine final {
+    static_assert(W > 0, "W must be positive");
+    static_assert(a > 0 && a < gl, "a must be in ]0,gl[");
+
+   public:
+    /**
+     * \param[in]   stretchmax  Largest stretch that will be used
+     * \param[in]   bufLenMax   Largest input or output length per call
+     */
+    pv_engine(double stretchmax, int bufLenMax);
+
+    ~pv_engine();
+
+    /**
+     * Output delay in samples at the current stretch, see pv_t.
+     */
+    int get_latency() const;
+
+    size_t next_inlen(size_t Lout) const;
+
+    size_t next_outlen(size_t Lin) const;
+
+    void advance_by(size_t Lin, size_t Lout);
+
+    void set_stretch(double stretch);
+
+    /**
+     * See pv_t::set_flush_denormals().
+     */
+    void set_flush_denormals(bool enable);
+
+    bool get_flush_denormals() const;
+
+    /**
+     * See pv_t::reset(), the random phases restart as well.
+     */
+    void reset();
+
+    /**
+     * Process Lin input samples and read up to Lout output samples.
+     *
+     * \returns Number of output samples produced, the remaining samples of
+     * out are set to zero.
+     */
+    int execute(const double* in[], int Lin, int chan, double stretch,
+                int Lout, double* out[]);
+
+    int execute_compact(const double* in, int Lin, int chan, double stretch,
+                        int Lout, double* out);
+
+   private:
+    pv_engine_priv<M, gl, a, W>* _p;
+};
+
+extern template class pv_engine<8192, 4096, 1024, 1>;
+extern template class pv_engine<8192, 4096, 1024, 2>;
+
+#endif  // PV_ENGINE_H__
@@ -0,0 +1,80 @@
+#ifndef PV_MULTIBAND_H__
+#define PV_MULTIBAND_H__
+
+#include "pv.h"
+
+/**
+ * Implementation class of pv_multiband_t.
+ */
+class pv_multiband_priv;
+
+/**
+ * Phase vocoder with a transform configuration per frequency band.
+ *
+ * The input is split by an octave pyramid: band k runs at 1/2^k of the
+ * sample rate and holds the part of the signal above about 0.2 times its
+ * own sample rate (the part that the decimation to the next band removes),
+ * the last band holds everything below. Each band has its own pv_t, so the
+ * upper bands can use short windows (less smearing of transients) and the
+ * lowest band long ones at a fraction of the cost. The bands are delayed
+ * to a common latency and summed; at stretch 1 the output is the input
+ * delayed by get_latency().
+ *
+ * Band configurations are in samples of the band's own rate, e.g. a 1024
+ * sample window in band 2 lasts as long as a 4096 sample one at the input
+ * rate. All hops must be multiples of the smallest one, so that all the
+ * bands are stretched by exactly the same factor.
+ */
+class pv_multiband_t final {
+   public:
+    /**
+     * \param[in]   stretchmax  Largest stretch that will be used
+     * \param[in]   Wmax        Maximum number of channels
+     * \param[in]   bufLenMax   Output block length of the band processing,
+     *                          pull() accepts any Lout
+     * \param[in]   bands       Configuration of each band, highest first
+     * \param[in]   numBands    Number of bands, at least 1
+     */
+    pv_multiband_t(double stretchmax, int Wmax, int bufLenMax,
+                   const pv_config_t bands[], int numBands);
+
+    ~pv_multiband_t();
+
+    int get_numbands() const;
+
+    /**
+     * Output delay in samples at the current stretch, see pv_t, including
+     * the band splitting filters.
+     */
+    int get_latency() const;
+
+    /**
+     * FFT work per output sample and channel, summed over the bands, see
+     * pv_config_fft_cost().
+     */
+    double get_fft_cost() const;
+
+    void set_stretch(double stretch);
+
+    void set_flush_denormals(bool enable);
+
+    bool get_flush_denormals() const;
+
+    void reset();
+
+    /**
+     * Produce exactly Lout output samples, pulling input on demand, see
+     * pv_t::pull(). The input is read in blocks of 2^(numBands - 1)
+     * samples, samples the reader does not provide are taken as silence.
+     *
+     * \returns Number of input samples pulled from reader, including that
+     * silence
+     */
+    int pull(double* out[], int Lout, int chan, double stretch,
+             pv_reader_t* reader, void* userdata);
+
+   private:
+    pv_multiband_priv* _p;
+};
+
+#endif  // PV_MULTIBAND_H__
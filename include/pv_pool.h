@@ -0,0 +1,70 @@
+#ifndef PV_POOL_H__
+#define PV_POOL_H__
+
+#include "pv.h"
+
+/**
+ * Implementation class of pv_pool_t.
+ */
+class pv_pool_priv;
+
+/**
+ * Pool of pv_t instances of one configuration, for streams that come and
+ * go. Constructing a pv_t allocates all its buffers and plans its FFTs;
+ * acquire() instead hands out an instance constructed ahead of time, and
+ * release() resets it for the next stream, so that starting a stream only
+ * takes a lock.
+ *
+ * The instances are constructed and run on a block of silence, so that
+ * their memory is touched, before they are handed out. acquire() returns
+ * them in the state right after construction, with the default settings:
+ * release() also restores those changed with the set_ functions of pv_t.
+ *
+ * acquire() and release() can be called from any thread. An instance is
+ * only used by one stream at a time, and is owned by the pool: it is
+ * destroyed with it.
+ */
+class pv_pool_t final {
+   public:
+    /**
+     * \param[in]   stretchmax  Largest stretch, see pv_t
+     * \param[in]   Wmax        Maximum number of channels, see pv_t
+     * \param[in]   buflenMax   Maximum block length, see pv_t
+     * \param[in]   config      Transform configuration of the instances
+     * \param[in]   count       Number of instances constructed now
+     */
+    pv_pool_t(double stretchmax, int Wmax, int buflenMax,
+              const pv_config_t& config, int count);
+
+    ~pv_pool_t();
+
+    /**
+     * Construct instances until there are count of them, free or not.
+     * Allocates, the lock is not held while constructing.
+     */
+    void reserve(int count);
+
+    /**
+     * A free instance. If there is none, one is constructed, which
+     * allocates; reserve() enough of them for the streams expected.
+     */
+    pv_t* acquire();
+
+    /**
+     * Reset an instance from acquire() and make it free again. Setting the
+     * number of pipeline stages or of batch frames back to 1 frees memory
+     * and stops threads if they were changed.
+     */
+    void release(pv_t* pv);
+
+    /** Number of instances, free or not */
+    int get_size() const;
+
+    /** Number of free instances */
+    int get_free() const;
+
+   private:
+    pv_pool_priv* _p;
+};
+
+#endif  // PV_POOL_H__
@@ -18,6 +18,32 @@ class rtdgtreal_t final {
 
     void execute(const double *f, int W, std::complex<double> *c);
 
+    /**
+     * Same as execute(), but the channels of f are fstride samples apart
+     * instead of gl.
+     */
+    void execute(const double *f, int fstride, int W, std::complex<double> *c);
+
+    /**
+     * Number of transforms execute_batch() runs as one batched FFT, e.g.
+     * frames times channels (1, the default, for none). Allocates.
+     */
+    void set_batch_len(int len);
+
+    /**
+     * Same as execute() for K frames, whose channels are all fstride samples
+     * apart. The K * W transforms are run in batches of the length set with
+     * set_batch_len(), the remainder one by one.
+     *
+     * \param[in]   f        Frames, K pointers
+     * \param[in]   fstride  Distance between the channels of a frame
+     * \param[in]   K        Number of frames
+     * \param[in]   W        Number of channels
+     * \param[out]  c        Coefficients, K x W x (M/2+1) array
+     */
+    void execute_batch(const double *const f[], int fstride, int K, int W,
+                       std::complex<double> *c);
+
     const int M;
 
    private:
@@ -32,6 +58,35 @@ class rtidgtreal_t final {
 
     void execute(const std::complex<double> *c, int W, double *f);
 
+    /**
+     * Same as execute(), but the output is not multiplied by the window.
+     * The caller is expected to apply get_window() itself, e.g. fused with
+     * the overlap-add.
+     */
+    void execute_unwindowed(const std::complex<double> *c, int W, double *f);
+
+    /**
+     * See rtdgtreal_t::set_batch_len().
+     */
+    void set_batch_len(int len);
+
+    /**
+     * Same as execute_unwindowed() for K frames, batched as with
+     * rtdgtreal_t::execute_batch().
+     *
+     * \param[in]   c  Coefficients, K x W x (M/2+1) array
+     * \param[in]   K  Number of frames
+     * \param[in]   W  Number of channels
+     * \param[out]  f  Frames, K x W x gl array
+     */
+    void execute_batch_unwindowed(const std::complex<double> *c, int K, int W,
+                                  double *f);
+
+    /**
+     * Window applied by execute(), gl samples in the output frame order.
+     */
+    const double *get_window() const;
+
     const int M;
 
    private:
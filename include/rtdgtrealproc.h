@@ -2,8 +2,10 @@
 #define RTDGTREALPROC_H__
 
 #include <complex>
+#include <cstddef>
 
 #include "firwin.h"
+#include "pcm.h"
 
 /**
  * \param[in]  userdata   User defined data
@@ -18,6 +20,20 @@ using rtdgtreal_processor_callback = void(void                       *userdata,
                                           int M2, int W,
                                           std::complex<double> *out);
 
+/**
+ * Input source of rtdgtreal_processor_t::execute_pull().
+ *
+ * \param[in]   userdata  User defined data
+ * \param[out]  buf       Channels to be filled, len samples each. They point
+ *                         into the analysis FIFO storage.
+ * \param[in]   len       Number of samples requested
+ * \param[in]   W         Number of channels
+ *
+ * \returns Number of samples written, less than len at the end of the input
+ */
+using rtdgtreal_processor_reader = int(void *userdata, double *buf[], int len,
+                                       int W);
+
 class rtdgtreal_processor_priv;
 
 class rtdgtreal_processor_t final {
@@ -25,22 +41,118 @@ class rtdgtreal_processor_t final {
     rtdgtreal_processor_t(firwin_t win, int gl, int a, int M, int numChans,
                           int bufLenMax, int procDelay);
 
+    /**
+     * Same as above with a custom window, e.g. from mtgauss(). The window
+     * is whole-point symmetric with zero delay, as firwin() returns it, and
+     * is copied.
+     */
+    rtdgtreal_processor_t(const double *g, int gl, int a, int M, int numChans,
+                          int bufLenMax, int procDelay);
+
     ~rtdgtreal_processor_t();
 
     void reset();
-    void set_anaa(int a);
+
+    /*
+     * Set the analysis hop, which can be fractional. The frames are still
+     * read at integer positions, the read position advancing by floor(a)
+     * or floor(a) + 1 samples, and the fraction left is applied to the
+     * coefficients as a linear phase ramp before the callback. The frames
+     * the callback gets then have the phases of frames a samples apart.
+     */
+    void set_anaa(double a);
     void set_syna(int a);
     void set_callback(rtdgtreal_processor_callback *callback, void *userdata);
 
-    void execute_compact(const double *in, int len, int chanNo, double *out);
+    /*
+     * Run the analysis, the callback and the synthesis of consecutive frames
+     * on up to 3 threads (1, the default, runs everything in the caller).
+     * With 2 stages the synthesis runs on a worker thread, with 3 the
+     * callback runs on another one. The frames are still processed in order,
+     * and each call returns once all its frames are done, so the output does
+     * not change; the stages only overlap when a call has several frames to
+     * process, i.e. with input blocks of several hops. The worker threads
+     * block, this is for offline processing. Not real-time safe.
+     */
+    void set_pipeline_stages(int stages);
+    int  get_pipeline_stages() const;
+
+    /*
+     * When a call has several frames to process, analyse up to frames of
+     * them with one batched FFT (all their channels), run the callback on
+     * each in order, and synthesize them with another one before the
+     * overlap-add (1, the default, processes one frame at a time). The
+     * output does not change. Ignored while pipelined stages are set.
+     * Allocates, not real-time safe.
+     */
+    void set_batch_frames(int frames);
+    int  get_batch_frames() const;
+
+    /*
+     * Add TPDF dither before quantizing output to integer PCM in
+     * execute_gen_pcm(), on by default. Float output is never dithered.
+     */
+    void set_dither(bool enable);
+    bool get_dither() const;
+
+    /*
+     * All execute functions return the number of samples written to out.
+     * The remaining samples up to the requested length are set to zero.
+     */
+
+    int execute_compact(const double *in, int len, int chanNo, double *out);
+
+    int execute_gen_compact(const double *in, int inLen, int chanNo,
+                            int outLen, double *out);
+
+    int execute(const double **in, int len, int chanNo, double **out);
+
+    int execute_gen(const double **in, int inLen, int chanNo, int outLen,
+                    double **out);
+
+    /*
+     * Same as execute_gen(), but the input is chanNo-channel interleaved PCM,
+     * converted while it is written to the analysis FIFO.
+     */
+    int execute_gen_interleaved(const void *in, pcm_format_t fmt, int inLen,
+                                int chanNo, int outLen, double **out);
+
+    /*
+     * Same as execute_gen(), but both the input and the output are planar
+     * PCM of the given format: in and out hold chanNo channels of inLen and
+     * outLen samples. The conversions happen while copying to and from the
+     * FIFOs, the processing itself stays in double precision.
+     */
+    int execute_gen_pcm(const void *const *in, pcm_format_t fmt, int inLen,
+                        int chanNo, int outLen, void *const *out);
 
-    void execute_gen_compact(const double *in, int inLen, int chanNo,
-                             int outLen, double *out);
+    /*
+     * Produce exactly outLen output samples, any outLen is accepted. Input
+     * is pulled from reader only when the next analysis frame needs it, and
+     * is taken as silence past the end of the input. The number of input
+     * samples consumed (including that silence) is stored in inLen if it is
+     * not null.
+     */
+    int execute_pull(rtdgtreal_processor_reader *reader, void *userdata,
+                     int chanNo, int outLen, double **out, int *inLen);
 
-    void execute(const double **in, int len, int chanNo, double **out);
+    /*
+     * Same as execute_pull(), but the outLen output samples are dropped.
+     * Frames whose output is all dropped are analysed and passed to the
+     * callback, but not synthesized. Returns outLen.
+     */
+    int execute_discard(rtdgtreal_processor_reader *reader, void *userdata,
+                        int chanNo, int outLen, int *inLen);
 
-    void execute_gen(const double **in, int inLen, int chanNo, int outLen,
-                     double **out);
+    /*
+     * Snapshot of the FIFOs and the dither state, get_state_size() bytes,
+     * which load_state() restores. Only for a processor constructed with
+     * the same arguments, by the same build. The settings and the callback
+     * are not part of it. Does not allocate.
+     */
+    size_t get_state_size() const;
+    void   save_state(void *buf) const;
+    void   load_state(const void *buf);
 
    private:
     rtdgtreal_processor_priv *_p;
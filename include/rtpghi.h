@@ -2,6 +2,7 @@
 #define RTPGHI_H__
 
 #include <complex>
+#include <cstddef>
 
 /**
  * Assert macro.
@@ -13,6 +14,16 @@
     #define rtpghi_assert(cond, msg)
 #endif
 
+/**
+ * How the channels of a frame are reconstructed, see
+ * rtpghi_t::set_channel_link().
+ */
+enum rtpghi_link_t {
+    RTPGHI_LINK_NONE,  //!< Each channel on its own
+    RTPGHI_LINK_SUM,   //!< Once, on the sum of the channels
+    RTPGHI_LINK_MAX,   //!< Once, on the largest coefficient of each bin
+};
+
 /**
  * Implementation class of RTPGHI.
  */
@@ -39,7 +50,8 @@ class rtpghi_t final {
     ~rtpghi_t();
 
     /**
-     * Reset RTPGHI state to the inital state.
+     * Reset RTPGHI state to the inital state, including the sequence of
+     * random phases.
      */
     void reset(const double** sinit);
 
@@ -50,8 +62,70 @@ class rtpghi_t final {
      */
     void set_tolerance(double tol);
 
+    /**
+     * Choose which frame execute() outputs. By default it is the previous
+     * one, whose time gradient is centered on it; in causal mode it is the
+     * frame passed to execute(), with a time gradient taken from the hop
+     * before it only. The causal mode removes one hop of latency at the cost
+     * of a less accurate gradient. Changing the mode takes effect at the
+     * next frame.
+     *
+     * \param[in]   causal  Output the frame passed to execute()
+     */
+    void set_causal(bool causal);
+
+    bool get_causal() const;
+
+    /**
+     * Take the analysis hop as asyn / stretch exactly, for a processor
+     * whose analysis hop is fractional (see
+     * rtdgtreal_processor_t::set_anaa()). By default it is rounded to the
+     * integer hop a processor with an integer analysis hop uses.
+     *
+     * \param[in]   fractional  Do not round the analysis hop
+     */
+    void set_fractional_hop(bool fractional);
+
+    bool get_fractional_hop() const;
+
+    /**
+     * Reconstruct the phase of linked channels once, on a reference
+     * spectrogram made of the sum of the channels or of the largest
+     * coefficient of each bin, and give each channel the phase offset it
+     * has to the reference at the input, i.e. rotate the input coefficients
+     * by the phase change of the reference. This costs one phase
+     * reconstruction per frame instead of one per channel, and keeps the
+     * phase differences between the channels, i.e. the stereo image. The
+     * sum cancels out where the channels are out of phase, the largest
+     * coefficient does not.
+     *
+     * Changing the mode takes effect at the next frame. The reference takes
+     * over the state of the channels when they are linked, and the other way
+     * around, so the phase stays continuous. Does nothing with a single
+     * channel.
+     *
+     * \param[in]   link    Linking of the channels, RTPGHI_LINK_NONE by
+     *                      default
+     */
+    void set_channel_link(rtpghi_link_t link);
+
+    rtpghi_link_t get_channel_link() const;
+
     double get_stretch() const;
 
+    /**
+     * Snapshot of the state: the magnitude, gradient and phase histories,
+     * the stretch and the random phase generator, get_state_size() bytes.
+     * load_state() restores it, and the same frames then give the same
+     * output. Only for a plan constructed with the same arguments, by the
+     * same build; the settings are not part of it. Does not allocate.
+     */
+    size_t get_state_size() const;
+
+    void save_state(void* buf) const;
+
+    void load_state(const void* buf);
+
     /**
      * Execute RTPGHI plan for a single frame.
      *
@@ -0,0 +1,42 @@
+#ifndef RTPGHI_TRACE_H__
+#define RTPGHI_TRACE_H__
+
+/**
+ * Per-frame event tracing.
+ *
+ * When the library is built with RTPGHI_TRACE, the processing path records
+ * timestamped events (FIFO writes and reads, analysis, phase reconstruction
+ * and synthesis of every frame, short reads and writes) into a lock-free
+ * ring per thread. Only the latest events of each thread are kept.
+ *
+ * At most 16 threads are traced at once; the events of any further thread
+ * are dropped until a ring is free. The worker threads of the library (see
+ * pv_t::set_pipeline_stages()) give their ring back when they exit, other
+ * threads keep theirs until the process ends. A thread that takes over a
+ * ring appends to its events under the same trace thread id.
+ *
+ * Without RTPGHI_TRACE, nothing is recorded and these functions do nothing.
+ */
+
+/**
+ * Whether the library was built with tracing.
+ */
+bool rtpghi_trace_enabled();
+
+/**
+ * Drop all recorded events. Must not run concurrently with processing.
+ */
+void rtpghi_trace_clear();
+
+/**
+ * Write the recorded events as Chrome trace JSON, which can be opened in
+ * chrome://tracing or ui.perfetto.dev. Events recorded while dumping may be
+ * missing or torn, so it is best called while the processing is idle.
+ *
+ * \param[in]  path  Output file
+ *
+ * \returns false if tracing is disabled or the file could not be written
+ */
+bool rtpghi_trace_dump(const char *path);
+
+#endif  // RTPGHI_TRACE_H__
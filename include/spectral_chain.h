@@ -0,0 +1,244 @@
+#ifndef SPECTRAL_CHAIN_H__
+#define SPECTRAL_CHAIN_H__
+
+#include <algorithm>
+#include <complex>
+#include <concepts>
+#include <tuple>
+#include <vector>
+
+#include "pv.h"
+#include "rtpghi.h"
+
+/**
+ * Stage that maps each coefficient on its own, e.g. a gain or a mask.
+ * bin() gets the channel w, the frequency index m and the coefficient.
+ */
+template <typename S>
+concept spectral_bin_stage =
+    requires(S s, int w, int m, std::complex<double> c) {
+        { s.bin(w, m, c) } -> std::convertible_to<std::complex<double>>;
+    };
+
+/**
+ * Stage that needs the whole frame, e.g. the phase reconstruction. frame()
+ * gets the M2 x W input and output arrays, which never alias.
+ */
+template <typename S>
+concept spectral_frame_stage =
+    requires(S s, const std::complex<double> *in, int M2, int W,
+             std::complex<double> *out) { s.frame(in, M2, W, out); };
+
+template <typename S>
+concept spectral_stage = spectral_bin_stage<S> || spectral_frame_stage<S>;
+
+/**
+ * Chain of spectral stages run on every frame, composed at compile time.
+ *
+ * Consecutive bin stages are fused into a single loop over the
+ * coefficients, with the stages inlined in it, and each frame stage is one
+ * direct call. The passes alternate between the output and a scratch frame
+ * so that the last one writes to the output and no pass copies: a chain of
+ * bin stages only, or a frame stage alone, makes one pass from the input
+ * to the output.
+ *
+ * callback() is a rtdgtreal_processor_callback with the chain as userdata,
+ * for rtdgtreal_processor_t::set_callback() or pv_t::set_frame_callback().
+ * The stages are copied into the chain, stage<I>() gives access to them to
+ * change their parameters between frames.
+ */
+template <spectral_stage... Stages>
+class spectral_chain_t final {
+   public:
+    static constexpr size_t num_stages = sizeof...(Stages);
+
+    /**
+     * \param[in]   M       Number of frequency channels (FFT length)
+     * \param[in]   W       Number of channels
+     * \param[in]   stages  Stages, run in order
+     *
+     * Allocates the scratch frame if needed.
+     */
+    explicit spectral_chain_t(int M, int W, Stages... stages)
+        : _stages(std::move(stages)...), _M2(M / 2 + 1), _W(W) {
+        if (passes<0>() > 1) _scratch.resize(_M2 * _W);
+    }
+
+    template <size_t I>
+    auto &stage() {
+        return std::get<I>(_stages);
+    }
+
+    /**
+     * Run the stages on a frame, see rtdgtreal_processor_callback.
+     */
+    void operator()(const std::complex<double> *in, int M2, int W,
+                    std::complex<double> *out) {
+        rtpghi_assert(M2 == _M2 && W == _W, "frame size mismatch");
+
+        if constexpr (num_stages == 0) {
+            std::copy(in, in + M2 * W, out);
+        } else {
+            run<0>(in, M2, W, out);
+        }
+    }
+
+    static void callback(void *userdata, const std::complex<double> *in,
+                         int M2, int W, std::complex<double> *out) {
+        (*static_cast<spectral_chain_t *>(userdata))(in, M2, W, out);
+    }
+
+   private:
+    using stages_t = std::tuple<Stages...>;
+
+    template <size_t I>
+    static constexpr bool is_frame =
+        spectral_frame_stage<std::tuple_element_t<I, stages_t>>;
+
+    /** First frame stage from stage I, num_stages if none */
+    template <size_t I>
+    static constexpr size_t next_frame() {
+        if constexpr (I == num_stages) {
+            return I;
+        } else if constexpr (is_frame<I>) {
+            return I;
+        } else {
+            return next_frame<I + 1>();
+        }
+    }
+
+    /** Number of passes from stage I on */
+    template <size_t I>
+    static constexpr int passes() {
+        if constexpr (I == num_stages) {
+            return 0;
+        } else if constexpr (is_frame<I>) {
+            return 1 + passes<I + 1>();
+        } else {
+            return 1 + passes<next_frame<I>()>();
+        }
+    }
+
+    template <size_t I, size_t J>
+    void apply_bins(int w, int m, std::complex<double> *c) {
+        if constexpr (I < J) {
+            *c = std::get<I>(_stages).bin(w, m, *c);
+            apply_bins<I + 1, J>(w, m, c);
+        }
+    }
+
+    template <size_t I>
+    void run(const std::complex<double> *src, int M2, int W,
+             std::complex<double> *out) {
+        if constexpr (I < num_stages) {
+            // Odd passes left: the last one writes to out
+            std::complex<double> *dst =
+                passes<I>() % 2 ? out : _scratch.data();
+
+            if constexpr (is_frame<I>) {
+                std::get<I>(_stages).frame(src, M2, W, dst);
+                run<I + 1>(dst, M2, W, out);
+            } else {
+                constexpr size_t J = next_frame<I>();
+
+                for (int w = 0; w < W; ++w) {
+                    for (int m = 0; m < M2; ++m) {
+                        std::complex<double> c = src[w * M2 + m];
+                        apply_bins<I, J>(w, m, &c);
+                        dst[w * M2 + m] = c;
+                    }
+                }
+                run<J>(dst, M2, W, out);
+            }
+        }
+    }
+
+    stages_t                          _stages;
+    std::vector<std::complex<double>> _scratch;  //!< Between passes
+    int                               _M2;
+    int                               _W;
+};
+
+/**
+ * Multiplies all the coefficients by a gain.
+ */
+struct spectral_gain_t {
+    double gain = 1.0;
+
+    std::complex<double> bin(int, int, std::complex<double> c) const {
+        return gain * c;
+    }
+};
+
+/**
+ * Multiplies the coefficients of every channel by a gain per frequency
+ * index, e.g. an equalizer curve. All gains are 1 initially.
+ */
+class spectral_mask_t {
+   public:
+    explicit spectral_mask_t(int M) : _gains(M / 2 + 1, 1.0) {}
+
+    void set_gain(int m, double gain) { _gains[m] = gain; }
+
+    /** M/2 + 1 gains */
+    double *data() { return _gains.data(); }
+
+    std::complex<double> bin(int, int m, std::complex<double> c) const {
+        return _gains[m] * c;
+    }
+
+   private:
+    std::vector<double> _gains;
+};
+
+/**
+ * Zeroes the coefficients below a magnitude threshold, a basic noise gate.
+ */
+struct spectral_gate_t {
+    double threshold = 0.0;
+
+    std::complex<double> bin(int, int, std::complex<double> c) const {
+        return std::norm(c) < threshold * threshold ? std::complex<double>()
+                                                    : c;
+    }
+};
+
+/**
+ * Phase reconstruction by a rtpghi_t at the stretch given to set_stretch(),
+ * for chains run by a rtdgtreal_processor_t.
+ */
+class spectral_rtpghi_t {
+   public:
+    explicit spectral_rtpghi_t(rtpghi_t *rtpghi)
+        : _rtpghi(rtpghi), _stretch(1.0) {}
+
+    void set_stretch(double stretch) { _stretch = stretch; }
+
+    void frame(const std::complex<double> *in, int, int,
+               std::complex<double> *out) {
+        _rtpghi->execute(in, _stretch, out);
+    }
+
+   private:
+    rtpghi_t *_rtpghi;
+    double    _stretch;
+};
+
+/**
+ * Phase reconstruction of a pv_t at its current stretch, see
+ * pv_t::set_frame_callback().
+ */
+class spectral_pv_phase_t {
+   public:
+    explicit spectral_pv_phase_t(pv_t *pv) : _pv(pv) {}
+
+    void frame(const std::complex<double> *in, int, int,
+               std::complex<double> *out) {
+        _pv->reconstruct_phase(in, out);
+    }
+
+   private:
+    pv_t *_pv;
+};
+
+#endif  // SPECTRAL_CHAIN_H__
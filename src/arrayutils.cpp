@@ -1,7 +1,13 @@
 #include "arrayutils.h"
 
+#include <cstdint>
+
 #include "rtpghi.h"
 
+#if defined(__AVX__) || defined(__SSE2__)
+    #include <immintrin.h>
+#endif
+
 void circshift(const double *in, int L, int shift, double *out) {
     int p;
     rtpghi_assert(L > 0, "L must be positive");
@@ -108,4 +114,63 @@ void periodize_array(const double *in, int Lin, int Lout, double *out) {
 
         std::copy(in, in + lastL, out + periods * Lin);
     }
-}
\ No newline at end of file
+}
+
+void overlap_add(double *acc, const double *in, const double *g, int L) {
+    int ii = 0;
+
+    if (g) {
+#if defined(__AVX__)
+        for (; ii + 4 <= L; ii += 4) {
+            __m256d x = _mm256_mul_pd(_mm256_loadu_pd(in + ii),
+                                      _mm256_loadu_pd(g + ii));
+            _mm256_storeu_pd(acc + ii,
+                             _mm256_add_pd(_mm256_loadu_pd(acc + ii), x));
+        }
+#elif defined(__SSE2__)
+        for (; ii + 2 <= L; ii += 2) {
+            __m128d x = _mm_mul_pd(_mm_loadu_pd(in + ii), _mm_loadu_pd(g + ii));
+            _mm_storeu_pd(acc + ii, _mm_add_pd(_mm_loadu_pd(acc + ii), x));
+        }
+#endif
+        for (; ii < L; ++ii) acc[ii] += in[ii] * g[ii];
+    } else {
+#if defined(__AVX__)
+        for (; ii + 4 <= L; ii += 4) {
+            _mm256_storeu_pd(acc + ii, _mm256_add_pd(_mm256_loadu_pd(acc + ii),
+                                                     _mm256_loadu_pd(in + ii)));
+        }
+#elif defined(__SSE2__)
+        for (; ii + 2 <= L; ii += 2) {
+            _mm_storeu_pd(acc + ii, _mm_add_pd(_mm_loadu_pd(acc + ii),
+                                               _mm_loadu_pd(in + ii)));
+        }
+#endif
+        for (; ii < L; ++ii) acc[ii] += in[ii];
+    }
+}
+
+void move_clear(double *src, int L, double *dst) {
+#if defined(__SSE2__) && defined(RTPGHI_NT_STORES)
+    // Single pass with streaming stores, needs an aligned destination.
+    if (reinterpret_cast<std::uintptr_t>(dst) % 16 == 0) {
+        const __m128d zero = _mm_setzero_pd();
+        int           ii = 0;
+        for (; ii + 2 <= L; ii += 2) {
+            _mm_stream_pd(dst + ii, _mm_loadu_pd(src + ii));
+            _mm_storeu_pd(src + ii, zero);
+        }
+        _mm_sfence();
+        for (; ii < L; ++ii) {
+            dst[ii] = src[ii];
+            src[ii] = 0;
+        }
+        return;
+    }
+#endif
+
+    // A fused copy-and-clear loop was measured slower than the libc block
+    // routines on cached data (and compilers turn it back into these anyway).
+    std::copy(src, src + L, dst);
+    std::fill(src, src + L, 0);
+}
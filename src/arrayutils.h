@@ -1,18 +1,6 @@
 #ifndef ARRAYUTILS_H__
 #define ARRAYUTILS_H__
 
-#include <fftw3.h>
-
-#include <complex>
-
-inline fftw_complex *cpx_stl2fftw(std::complex<double> *arr) {
-    return reinterpret_cast<fftw_complex *>(arr);
-}
-
-inline std::complex<double> *cpx_fftw2stl(fftw_complex *arr) {
-    return reinterpret_cast<std::complex<double> *>(arr);
-}
-
 void circshift(const double *in, int L, int shift, double *out);
 
 void fftshift(const double *in, int L, double *out);
@@ -25,4 +13,20 @@ void fold_array(const double *in, int Lin, int offset, int Lfold, double *out);
 
 void periodize_array(const double *in, int Lin, int Lout, double *out);
 
+/** Overlap-add with optional window: acc[ii] += in[ii] * g[ii]
+ *
+ * \param[in,out]  acc   Accumulator
+ * \param[in]       in   Samples to be added
+ * \param[in]        g   Window, may be nullptr for no windowing
+ * \param[in]        L   Number of samples
+ */
+void overlap_add(double *acc, const double *in, const double *g, int L);
+
+/** Copy L samples from src to dst and clear src
+ *
+ * If built with RTPGHI_NT_STORES, this is done in a single pass and dst is
+ * written with non-temporal stores.
+ */
+void move_clear(double *src, int L, double *dst);
+
 #endif  // ARRAYUTILS_H__
\ No newline at end of file
@@ -1,5 +1,10 @@
 #include "circularbuf.h"
 
+#include <algorithm>
+
+#include "arrayutils.h"
+#include "mirrorbuf.h"
+#include "pcmconv.h"
 #include "rtpghi.h"
 
 analysis_fifo_t::analysis_fifo_t(int fifoLen, int procDelay, int winLen,
@@ -16,22 +21,87 @@ analysis_fifo_t::analysis_fifo_t(int fifoLen, int procDelay, int winLen,
     _winLen = winLen;
     _readchanstride = winLen;
     _hop = hop;
-    _buf = std::make_unique<double[]>(numChans * (fifoLen + 1));
+    _hopFrac = 0;
+    _readFrac = 0;
+    _frameFrac = 0;
     _bufLen = fifoLen + 1;
-    _readIdx = fifoLen + 1;  // - procDelay;
+
+#ifdef RTPGHI_MIRRORED_FIFO
+    _mirror = std::make_unique<mirrored_buffer_t>(fifoLen + 1, numChans);
+    if (_mirror->valid()) {
+        // The ring length is rounded up to whole pages.
+        _bufLen = _mirror->get_len();
+        _data = _mirror->data();
+        _chanstride = _mirror->get_chanstride();
+    } else {
+        _mirror.reset();
+    }
+#endif
+
+    if (!_mirror) {
+        _buf = std::make_unique<double[]>(numChans * _bufLen);
+        _data = _buf.get();
+        _chanstride = _bufLen;
+    }
+
+    _chanptrs = std::make_unique<double*[]>(numChans);
+    _pcmptrs = std::make_unique<const void*[]>(numChans);
+
+    _readIdx = _bufLen;  // - procDelay;
     _writeIdx = 0;
     _numChans = numChans;
 }
 
+analysis_fifo_t::~analysis_fifo_t() = default;
+
 int analysis_fifo_t::get_numchans() const { return _numChans; }
 
+bool analysis_fifo_t::is_mirrored() const { return _mirror != nullptr; }
+
+void analysis_fifo_t::transfer_state(state_io_t* io) {
+    for (int w = 0; w < _numChans; ++w) io->io(chanptr(w), _bufLen);
+
+    io->io(&_readIdx);
+    io->io(&_writeIdx);
+    io->io(&_hop);
+    io->io(&_hopFrac);
+    io->io(&_readFrac);
+    io->io(&_frameFrac);
+}
+
+double* analysis_fifo_t::chanptr(int w) const {
+    return _data + w * _chanstride;
+}
+
 void analysis_fifo_t::reset() {
-    std::fill(_buf.get(), _buf.get() + _numChans * _bufLen, 0);
+    for (int w = 0; w < _numChans; ++w) {
+        std::fill(chanptr(w), chanptr(w) + _bufLen, 0);
+    }
+
+    _readIdx = _bufLen;
+    _writeIdx = 0;
+    _readFrac = 0;
+    _frameFrac = 0;
 }
 
-void analysis_fifo_t::set_hop(int hop) {
-    rtpghi_assert(hop > 0, "hop must be positive");
-    _hop = hop;
+void analysis_fifo_t::set_hop(double hop) {
+    rtpghi_assert(hop >= 1, "hop must be at least 1");
+    _hop = (int)hop;
+    _hopFrac = hop - _hop;
+}
+
+double analysis_fifo_t::get_frame_frac() const { return _frameFrac; }
+
+int analysis_fifo_t::next_step() const {
+    return _readFrac + _hopFrac >= 1 ? _hop + 1 : _hop;
+}
+
+void analysis_fifo_t::advance() {
+    int step = next_step();
+
+    _frameFrac = _readFrac;
+    _readFrac += _hopFrac - (step - _hop);
+    _readIdx = (_readIdx + step) % _bufLen;
 }
 
 void analysis_fifo_t::set_readchanstride(int stride) {
@@ -39,33 +109,42 @@ void analysis_fifo_t::set_readchanstride(int stride) {
     _readchanstride = stride;
 }
 
-int analysis_fifo_t::write(const double** buf, int bufLen, int W) {
-    int Wact, freeSpace, toWrite, valid, over, endWriteIdx;
-
-    rtpghi_assert(bufLen >= 0, "bufLen must be positive");
-    rtpghi_assert(W > 0, "W must be positive");
-
-    if (bufLen == 0) return 0;
+int analysis_fifo_t::write_split(int bufLen, int* valid, int* over) const {
+    int freeSpace, toWrite, endWriteIdx;
 
     freeSpace = _readIdx - _writeIdx - 1;
     if (freeSpace < 0) freeSpace += _bufLen;
 
-    Wact = _numChans < W ? _numChans : W;
-
     toWrite = bufLen > freeSpace ? freeSpace : bufLen;
-    valid = toWrite;
-    over = 0;
+    *valid = toWrite;
+    *over = 0;
 
     endWriteIdx = _writeIdx + toWrite;
 
-    if (endWriteIdx > _bufLen) {
-        valid = _bufLen - _writeIdx;
-        over = endWriteIdx - _bufLen;
+    // The mirrored view wraps around by itself.
+    if (endWriteIdx > _bufLen && !_mirror) {
+        *valid = _bufLen - _writeIdx;
+        *over = endWriteIdx - _bufLen;
     }
 
+    return toWrite;
+}
+
+int analysis_fifo_t::write(const double** buf, int bufLen, int W) {
+    int Wact, toWrite, valid, over;
+
+    rtpghi_assert(bufLen >= 0, "bufLen must be positive");
+    rtpghi_assert(W > 0, "W must be positive");
+
+    if (bufLen == 0) return 0;
+
+    Wact = _numChans < W ? _numChans : W;
+
+    toWrite = write_split(bufLen, &valid, &over);
+
     if (valid > 0) {
         for (int w = 0; w < _numChans; ++w) {
-            double* pbufchan = _buf.get() + w * _bufLen + _writeIdx;
+            double* pbufchan = chanptr(w) + _writeIdx;
             if (w < Wact)
                 std::copy(buf[w], buf[w] + valid, pbufchan);
             else
@@ -74,7 +153,7 @@ int analysis_fifo_t::write(const double** buf, int bufLen, int W) {
     }
     if (over > 0) {
         for (int w = 0; w < Wact; ++w) {
-            double* pbufchan = _buf.get() + w * _bufLen;
+            double* pbufchan = chanptr(w);
             if (w < Wact)
                 std::copy(buf[w] + valid, buf[w] + valid + over, pbufchan);
             else
@@ -86,13 +165,146 @@ int analysis_fifo_t::write(const double** buf, int bufLen, int W) {
     return toWrite;
 }
 
+template <pcm_format_t fmt>
+void analysis_fifo_t::write_pcm(int valid, int over, int W, int stride) {
+    for (int w = 0; w < _numChans; ++w) {
+        double* pbufchan = chanptr(w);
+
+        if (w < W) {
+            auto bufchan = static_cast<const unsigned char*>(_pcmptrs[w]);
+
+            pcm_convert<fmt>(bufchan, stride, valid, pbufchan + _writeIdx);
+            pcm_convert<fmt>(bufchan + valid * stride, stride, over, pbufchan);
+        } else {
+            std::fill(pbufchan + _writeIdx, pbufchan + _writeIdx + valid, 0);
+            std::fill(pbufchan, pbufchan + over, 0);
+        }
+    }
+}
+
+int analysis_fifo_t::write_pcm(pcm_format_t fmt, int bufLen, int W,
+                               int stride) {
+    int toWrite, valid, over;
+
+    toWrite = write_split(bufLen, &valid, &over);
+
+    switch (fmt) {
+        case PCM_S16:
+            write_pcm<PCM_S16>(valid, over, W, stride);
+            break;
+        case PCM_S24:
+            write_pcm<PCM_S24>(valid, over, W, stride);
+            break;
+        case PCM_S32:
+            write_pcm<PCM_S32>(valid, over, W, stride);
+            break;
+        case PCM_F32:
+            write_pcm<PCM_F32>(valid, over, W, stride);
+            break;
+        case PCM_F64:
+            write_pcm<PCM_F64>(valid, over, W, stride);
+            break;
+    }
+
+    _writeIdx = (_writeIdx + toWrite) % _bufLen;
+
+    return toWrite;
+}
+
+int analysis_fifo_t::write_interleaved(const void* buf, pcm_format_t fmt,
+                                       int bufLen, int W, int stride) {
+    int Wact, size;
+
+    rtpghi_assert(bufLen >= 0, "bufLen must be positive");
+    rtpghi_assert(W > 0, "W must be positive");
+    rtpghi_assert(stride >= W, "stride must be at least W");
+
+    if (bufLen == 0) return 0;
+
+    Wact = _numChans < W ? _numChans : W;
+    size = pcm_sample_size(fmt);
+
+    for (int w = 0; w < Wact; ++w) {
+        _pcmptrs[w] = static_cast<const unsigned char*>(buf) + w * size;
+    }
+
+    return write_pcm(fmt, bufLen, Wact, stride * size);
+}
+
+int analysis_fifo_t::write_planar(const void* const* buf, pcm_format_t fmt,
+                                  int bufLen, int W) {
+    int Wact;
+
+    rtpghi_assert(bufLen >= 0, "bufLen must be positive");
+    rtpghi_assert(W > 0, "W must be positive");
+
+    if (bufLen == 0) return 0;
+
+    Wact = _numChans < W ? _numChans : W;
+
+    for (int w = 0; w < Wact; ++w) _pcmptrs[w] = buf[w];
+
+    return write_pcm(fmt, bufLen, Wact, pcm_sample_size(fmt));
+}
+
+int analysis_fifo_t::write_from(analysis_fifo_reader* reader, void* userdata,
+                                int bufLen, int W) {
+    int Wact, toWrite, valid, over, got;
+
+    rtpghi_assert(bufLen >= 0, "bufLen must be positive");
+    rtpghi_assert(W > 0, "W must be positive");
+
+    if (bufLen == 0) return 0;
+
+    Wact = _numChans < W ? _numChans : W;
+
+    toWrite = write_split(bufLen, &valid, &over);
+
+    for (int w = 0; w < Wact; ++w) _chanptrs[w] = chanptr(w) + _writeIdx;
+    got = std::clamp(reader(userdata, _chanptrs.get(), valid, Wact), 0, valid);
+
+    if (got == valid && over > 0) {
+        for (int w = 0; w < Wact; ++w) _chanptrs[w] = chanptr(w);
+        got += std::clamp(reader(userdata, _chanptrs.get(), over, Wact), 0,
+                          over);
+    }
+
+    // Zero the part the reader did not provide, and the other channels
+    for (int w = 0; w < _numChans; ++w) {
+        int     from = w < Wact ? got : 0;
+        double* pbufchan = chanptr(w);
+
+        if (from < valid) {
+            std::fill(pbufchan + _writeIdx + from, pbufchan + _writeIdx + valid,
+                      0);
+            from = valid;
+        }
+        std::fill(pbufchan + from - valid, pbufchan + over, 0);
+    }
+
+    _writeIdx = (_writeIdx + toWrite) % _bufLen;
+
+    return toWrite;
+}
+
+int analysis_fifo_t::get_needed() const {
+    int available, needed, step = next_step();
+
+    available = _writeIdx - _readIdx;
+    if (available < 0) available += _bufLen;
+
+    needed = (_winLen > step ? _winLen : step) - available;
+
+    return needed > 0 ? needed : 0;
+}
+
 int analysis_fifo_t::read(double* buf) {
     int available, toRead, valid, over, endReadIdx;
 
     available = _writeIdx - _readIdx;
     if (available < 0) available += _bufLen;
 
-    if (available < _winLen || available < _hop) return 0;
+    if (available < _winLen || available < next_step()) return 0;
 
     toRead = _winLen;
 
@@ -108,23 +320,49 @@ int analysis_fifo_t::read(double* buf) {
 
     if (valid > 0) {
         for (int w = 0; w < _numChans; ++w) {
-            double* pbufchan = _buf.get() + w * _bufLen + _readIdx;
+            double* pbufchan = chanptr(w) + _readIdx;
             std::copy(pbufchan, pbufchan + valid, buf + w * _readchanstride);
         }
     }
     if (over > 0) {
         for (int w = 0; w < _numChans; ++w) {
-            std::copy(_buf.get() + w * _bufLen, _buf.get() + w * _bufLen + over,
+            std::copy(chanptr(w), chanptr(w) + over,
                       buf + valid + w * _readchanstride);
         }
     }
 
     // Only advance by hop
-    _readIdx = (_readIdx + _hop) % _bufLen;
+    advance();
 
     return toRead;
 }
 
+int analysis_fifo_t::read_view(const double** buf, int* chanStride,
+                               double* scratch) {
+    int available;
+
+    if (!_mirror) {
+        *buf = scratch;
+        *chanStride = _readchanstride;
+        return read(scratch);
+    }
+
+    available = _writeIdx - _readIdx;
+    if (available < 0) available += _bufLen;
+
+    if (available < _winLen || available < next_step()) return 0;
+
+    // _readIdx can be equal to _bufLen right after construction, the window
+    // still lies within the second view.
+    *buf = _data + _readIdx;
+    *chanStride = _chanstride;
+
+    // Only advance by hop
+    advance();
+
+    return _winLen;
+}
+
 synthesis_fifo_t::synthesis_fifo_t(int fifoLen, int winLen, int hop,
                                    int numChans) {
     rtpghi_assert(fifoLen > 0, "fifoLen must be positive");
@@ -146,8 +384,18 @@ synthesis_fifo_t::synthesis_fifo_t(int fifoLen, int winLen, int hop,
 
 int synthesis_fifo_t::get_numchans() const { return _numChans; }
 
+void synthesis_fifo_t::transfer_state(state_io_t* io) {
+    io->io(_buf.get(), _numChans * _bufLen);
+    io->io(&_readIdx);
+    io->io(&_writeIdx);
+    io->io(&_hop);
+}
+
 void synthesis_fifo_t::reset() {
     std::fill(_buf.get(), _buf.get() + _numChans * _bufLen, 0);
+
+    _readIdx = 0;
+    _writeIdx = 0;
 }
 
 void synthesis_fifo_t::set_hop(int hop) {
@@ -160,7 +408,9 @@ void synthesis_fifo_t::set_writechanstride(int stride) {
     _writechanstride = stride;
 }
 
-int synthesis_fifo_t::write(const double* buf) {
+int synthesis_fifo_t::write(const double* buf) { return write(buf, nullptr); }
+
+int synthesis_fifo_t::write(const double* buf, const double* g) {
     int freeSpace, toWrite, valid, over, endWriteIdx;
 
     freeSpace = _readIdx - _writeIdx - 1;
@@ -183,18 +433,14 @@ int synthesis_fifo_t::write(const double* buf) {
         for (int w = 0; w < _numChans; ++w) {
             double*       pbufchan = _buf.get() + _writeIdx + w * _bufLen;
             const double* bufchan = buf + w * _writechanstride;
-            for (int ii = 0; ii < valid; ++ii) {
-                pbufchan[ii] += bufchan[ii];
-            }
+            overlap_add(pbufchan, bufchan, g, valid);
         }
     }
     if (over > 0) {
         for (int w = 0; w < _numChans; ++w) {
             double*       pbufchan = _buf.get() + w * _bufLen;
             const double* bufchan = buf + valid + w * _writechanstride;
-            for (int ii = 0; ii < over; ++ii) {
-                pbufchan[ii] += bufchan[ii];
-            }
+            overlap_add(pbufchan, bufchan, g ? g + valid : nullptr, over);
         }
     }
 
@@ -203,47 +449,141 @@ int synthesis_fifo_t::write(const double* buf) {
     return toWrite;
 }
 
-int synthesis_fifo_t::read(int bufLen, int W, double** buf) {
-    int available, toRead, valid, over, endReadIdx;
+int synthesis_fifo_t::get_available() const {
+    int available = _writeIdx - _readIdx;
+    if (available < 0) available += _bufLen;
+    return available;
+}
+
+int synthesis_fifo_t::get_write_end() const {
+    return get_available() + _winLen;
+}
+
+int synthesis_fifo_t::write_zeros() {
+    int freeSpace = _readIdx - _writeIdx - 1;
+    if (freeSpace < 0) freeSpace += _bufLen;
+
+    if (freeSpace < _winLen) return 0;
+
+    _writeIdx = (_writeIdx + _hop) % _bufLen;
+
+    return _winLen;
+}
+
+int synthesis_fifo_t::discard(int bufLen) {
+    int toRead, valid, over;
 
-    rtpghi_assert(W > 0, "W must be positive");
     rtpghi_assert(bufLen >= 0, "bufLen must be nonnegative");
 
-    if (bufLen == 0) return 0;
+    toRead = read_split(bufLen, &valid, &over);
+
+    for (int w = 0; w < _numChans; ++w) {
+        clear_array(_buf.get() + _readIdx + w * _bufLen, valid);
+        clear_array(_buf.get() + w * _bufLen, over);
+    }
+
+    _readIdx = (_readIdx + toRead) % _bufLen;
+
+    return toRead;
+}
+
+int synthesis_fifo_t::read_split(int bufLen, int* valid, int* over) const {
+    int available, toRead, endReadIdx;
 
     available = _writeIdx - _readIdx;
     if (available < 0) available += _bufLen;
 
     toRead = available < bufLen ? available : bufLen;
 
-    valid = toRead;
-    over = 0;
+    *valid = toRead;
+    *over = 0;
 
-    endReadIdx = _readIdx + valid;
+    endReadIdx = _readIdx + toRead;
 
     if (endReadIdx > _bufLen) {
-        valid = _bufLen - _readIdx;
-        over = endReadIdx - _bufLen;
+        *valid = _bufLen - _readIdx;
+        *over = endReadIdx - _bufLen;
     }
 
+    return toRead;
+}
+
+int synthesis_fifo_t::read(int bufLen, int W, double** buf) {
+    int toRead, valid, over;
+
+    rtpghi_assert(W > 0, "W must be positive");
+    rtpghi_assert(bufLen >= 0, "bufLen must be nonnegative");
+
+    if (bufLen == 0) return 0;
+
+    toRead = read_split(bufLen, &valid, &over);
+
     // Set the just read samples to zero so that the values
     // are not used in write again
     if (valid > 0) {
         for (int w = 0; w < W; ++w) {
             double* pbufchan = _buf.get() + _readIdx + w * _bufLen;
-            std::copy(pbufchan, pbufchan + valid, buf[w]);
-            std::fill(pbufchan, pbufchan + valid, 0);
+            move_clear(pbufchan, valid, buf[w]);
         }
     }
     if (over > 0) {
         for (int w = 0; w < W; ++w) {
             double* pbufchan = _buf.get() + w * _bufLen;
-            std::copy(pbufchan, pbufchan + over, buf[w] + valid);
-            std::fill(pbufchan, pbufchan + over, 0);
+            move_clear(pbufchan, over, buf[w] + valid);
         }
     }
 
     _readIdx = (_readIdx + toRead) % _bufLen;
 
     return toRead;
-}
\ No newline at end of file
+}
+
+template <pcm_format_t fmt>
+void synthesis_fifo_t::read_pcm(int valid, int over, int W,
+                                pcm_dither_t* dither, void* const* buf) {
+    const int size = pcm_size<fmt>();
+
+    for (int w = 0; w < W; ++w) {
+        double*        pbufchan = _buf.get() + w * _bufLen;
+        unsigned char* bufchan = static_cast<unsigned char*>(buf[w]);
+
+        pcm_convert_clear<fmt>(pbufchan + _readIdx, valid, dither, bufchan,
+                               size);
+        pcm_convert_clear<fmt>(pbufchan, over, dither, bufchan + valid * size,
+                               size);
+    }
+}
+
+int synthesis_fifo_t::read_pcm(int bufLen, int W, pcm_format_t fmt,
+                               pcm_dither_t* dither, void* const* buf) {
+    int toRead, valid, over;
+
+    rtpghi_assert(W > 0, "W must be positive");
+    rtpghi_assert(bufLen >= 0, "bufLen must be nonnegative");
+
+    if (bufLen == 0) return 0;
+
+    toRead = read_split(bufLen, &valid, &over);
+
+    switch (fmt) {
+        case PCM_S16:
+            read_pcm<PCM_S16>(valid, over, W, dither, buf);
+            break;
+        case PCM_S24:
+            read_pcm<PCM_S24>(valid, over, W, dither, buf);
+            break;
+        case PCM_S32:
+            read_pcm<PCM_S32>(valid, over, W, dither, buf);
+            break;
+        case PCM_F32:
+            read_pcm<PCM_F32>(valid, over, W, dither, buf);
+            break;
+        case PCM_F64:
+            read_pcm<PCM_F64>(valid, over, W, dither, buf);
+            break;
+    }
+
+    _readIdx = (_readIdx + toRead) % _bufLen;
+
+    return toRead;
+}
@@ -3,6 +3,25 @@
 
 #include <memory>
 
+#include "pcm.h"
+#include "statebuf.h"
+
+class mirrored_buffer_t;
+struct pcm_dither_t;
+
+/**
+ * Source of samples for analysis_fifo_t::write_from().
+ *
+ * \param[in]   userdata  User defined data
+ * \param[out]  buf       Channels to be filled, len samples each
+ * \param[in]   len       Number of samples requested
+ * \param[in]   W         Number of channels
+ *
+ * \returns Number of samples written, less than len at the end of the input
+ */
+using analysis_fifo_reader = int(void *userdata, double *buf[], int len,
+                                 int W);
+
 class analysis_fifo_t final {
    public:
     /** Create constant size output ring buffer
@@ -26,12 +45,37 @@ class analysis_fifo_t final {
     analysis_fifo_t(int fifoLen, int procDelay, int winLen, int hop,
                     int numChans);
 
+    ~analysis_fifo_t();
+
     int get_numchans() const;
 
+    /** Transfer the samples and positions, see state_io_t */
+    void transfer_state(state_io_t *io);
+
+    /** Whether the ring buffer is backed by a mirrored mapping
+     *
+     * Only possible when built with RTPGHI_MIRRORED_FIFO; falls back to a
+     * plain heap array if the mapping could not be created.
+     */
+    bool is_mirrored() const;
+
     void reset();
-    void set_hop(int hop);
+
+    /**
+     * Set the hop size, which can be fractional. The read position is
+     * then integer, and advances by floor(hop) or floor(hop) + 1 so that
+     * it stays within one sample of the exact position; get_frame_frac()
+     * gives the offset of the last frame read to its exact position.
+     */
+    void set_hop(double hop);
     void set_readchanstride(int stride);
 
+    /**
+     * Offset in [0,1[ samples from the start of the last frame read to
+     * its exact position, 0 for integer hops.
+     */
+    double get_frame_frac() const;
+
     /** Write bufLen samples to the analysis ring buffer
      *
      * The function returns number of samples written and a negative number if
@@ -48,6 +92,56 @@ class analysis_fifo_t final {
      */
     int write(const double *buf[], int bufLen, int W);
 
+    /** Write bufLen interleaved PCM frames to the analysis ring buffer
+     *
+     * Same as write(), but the samples are converted to double while they
+     * are copied into the ring buffer.
+     *
+     * \param[in]  buf      Interleaved frames
+     * \param[in]  fmt      Sample format of buf
+     * \param[in]  bufLen   Number of frames to be written
+     * \param[in]  W        Number of channels to be written
+     * \param[in]  stride   Number of channels of buf, at least W
+     *
+     * \returns Number of frames written
+     */
+    int write_interleaved(const void *buf, pcm_format_t fmt, int bufLen, int W,
+                          int stride);
+
+    /** Write bufLen PCM samples per channel to the analysis ring buffer
+     *
+     * Same as write(), but the samples are converted to double while they
+     * are copied into the ring buffer.
+     *
+     * \param[in]  buf      Channels to be written
+     * \param[in]  fmt      Sample format of buf
+     * \param[in]  bufLen   Number of samples to be written
+     * \param[in]  W        Number of channels
+     *
+     * \returns Number of samples written
+     */
+    int write_planar(const void *const buf[], pcm_format_t fmt, int bufLen,
+                     int W);
+
+    /** Write bufLen samples produced by reader to the analysis ring buffer
+     *
+     * Same as write(), but reader fills the ring buffer storage in place, in
+     * at most two calls (before and after the wrap point). Samples reader
+     * did not provide are set to zero.
+     *
+     * \param[in]  reader    Sample source
+     * \param[in]  userdata  Passed to reader
+     * \param[in]  bufLen    Number of samples to be written
+     * \param[in]  W         Number of channels requested from reader
+     *
+     * \returns Number of samples written, including the zeros
+     */
+    int write_from(analysis_fifo_reader *reader, void *userdata, int bufLen,
+                   int W);
+
+    /** Number of samples to write before the next read() succeeds */
+    int get_needed() const;
+
     /** Read p->winLen samples from the analysis ring buffer
      *
      * The function attempts to read p->winLen samples from the buffer.
@@ -63,15 +157,56 @@ class analysis_fifo_t final {
      */
     int read(double buf[]);
 
+    /** Read p->winLen samples from the analysis ring buffer without copying
+     *
+     * Behaves like read(), except that if the ring buffer is mirrored, no
+     * samples are copied and buf points directly into the ring buffer
+     * storage. Otherwise the samples are copied to scratch as in read().
+     *
+     * The returned window stays valid until the next call to write().
+     *
+     * \param[out]  buf         First sample of the first channel
+     * \param[out]  chanStride  Distance between the channels of buf
+     * \param[out]  scratch     Fallback output array, see read()
+     *
+     * \returns Number of samples read
+     */
+    int read_view(const double **buf, int *chanStride, double scratch[]);
+
    private:
-    int                       _winLen;          //!< Window length
-    int                       _readchanstride;  //!< Window length
-    int                       _hop;             //!< Hop size
-    std::unique_ptr<double[]> _buf;             //!< Ring buffer array
-    int                       _bufLen;          //!< Length of the previous
-    int                       _readIdx;         //!< Read pos.
-    int                       _writeIdx;        //!< Write pos.
-    int                       _numChans;
+    double *chanptr(int w) const;
+
+    /** Available space and the split of toWrite samples at the wrap point */
+    int write_split(int bufLen, int *valid, int *over) const;
+
+    /** Convert the channels in _pcmptrs, stride bytes between samples */
+    template <pcm_format_t fmt>
+    void write_pcm(int valid, int over, int W, int stride);
+
+    int write_pcm(pcm_format_t fmt, int bufLen, int W, int stride);
+
+    /** Distance to the read position of the next frame */
+    int next_step() const;
+
+    /** Advance the read position to the next frame */
+    void advance();
+
+    int                                _winLen;          //!< Window length
+    int                                _readchanstride;  //!< Window length
+    std::unique_ptr<double *[]>        _chanptrs;        //!< Reader channels
+    std::unique_ptr<const void *[]>    _pcmptrs;         //!< PCM channels
+    int                                _hop;             //!< Hop size
+    double                             _hopFrac;         //!< Fraction of hop
+    double                             _readFrac;        //!< Read pos. fraction
+    double                             _frameFrac;       //!< Last frame offset
+    std::unique_ptr<double[]>          _buf;             //!< Ring buffer array
+    std::unique_ptr<mirrored_buffer_t> _mirror;          //!< Mirrored storage
+    double                            *_data;            //!< Ring buffer start
+    int                                _chanstride;      //!< Channel distance
+    int                                _bufLen;          //!< Ring length
+    int                                _readIdx;         //!< Read pos.
+    int                                _writeIdx;        //!< Write pos.
+    int                                _numChans;
 };
 
 class synthesis_fifo_t final {
@@ -101,6 +236,9 @@ class synthesis_fifo_t final {
 
     int get_numchans() const;
 
+    /** Transfer the samples and positions, see state_io_t */
+    void transfer_state(state_io_t *io);
+
     void reset();
     void set_hop(int hop);
     void set_writechanstride(int stride);
@@ -117,6 +255,18 @@ class synthesis_fifo_t final {
      */
     int write(const double buf[]);
 
+    /** Window and write p->winLen samples to DGT synthesis ring buffer
+     *
+     * Same as write(), but the samples are multiplied by the window g while
+     * they are overlap-added, sparing a separate windowing pass.
+     *
+     * \param[in]  buf      Samples to be written
+     * \param[in]  g        Window of length p->winLen, or nullptr
+     *
+     * \returns Number of samples written
+     */
+    int write(const double buf[], const double g[]);
+
     /** Read bufLen samples from DGT analysis ring buffer
      *
      * The function attempts to read bufLen samples from the buffer.
@@ -131,7 +281,48 @@ class synthesis_fifo_t final {
      */
     int read(int bufLen, int W, double *buf[]);
 
+    /** Read bufLen samples as PCM
+     *
+     * Same as read(), but the samples are converted to fmt while they are
+     * copied out, dithered if fmt is an integer format.
+     *
+     * \param[in]      bufLen   Number of samples to be read
+     * \param[in]      W        Number of channels
+     * \param[in]      fmt      Sample format of buf
+     * \param[in,out]  dither   Dither state
+     * \param[out]     buf      Output channels, bufLen samples each
+     *
+     * \returns Number of samples read
+     */
+    int read_pcm(int bufLen, int W, pcm_format_t fmt, pcm_dither_t *dither,
+                 void *const buf[]);
+
+    /** Number of samples ready to be read */
+    int get_available() const;
+
+    /** Samples from the read position to the end of the next write() */
+    int get_write_end() const;
+
+    /** Advance as write() of a frame of zeros would, without writing
+     *
+     * \returns Number of samples written, 0 if there is not enough space
+     */
+    int write_zeros();
+
+    /** Discard bufLen samples, same as read() without output
+     *
+     * \returns Number of samples discarded
+     */
+    int discard(int bufLen);
+
    private:
+    /** Split of toRead samples at the wrap point */
+    int read_split(int bufLen, int *valid, int *over) const;
+
+    template <pcm_format_t fmt>
+    void read_pcm(int valid, int over, int W, pcm_dither_t *dither,
+                  void *const buf[]);
+
     int                       _winLen;           //!< Window length
     int                       _writechanstride;  //!< Window length
     int                       _hop;              //!< Hop size
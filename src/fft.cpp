@@ -0,0 +1,65 @@
+#include "fft.h"
+
+#include <cstdlib>
+
+#include "rtpghi.h"
+
+std::unique_ptr<fft_real_t> fft_real_create(fft_backend_t backend, int M,
+                                            bool inverse, double *real,
+                                            std::complex<double> *cpx) {
+    return fft_real_create_batch(backend, M, 1, inverse, real, M, cpx);
+}
+
+std::unique_ptr<fft_real_t> fft_real_create_batch(fft_backend_t backend,
+                                                  int M, int howmany,
+                                                  bool inverse, double *real,
+                                                  int realDist,
+                                                  std::complex<double> *cpx) {
+    rtpghi_assert(howmany > 0, "howmany must be positive");
+    rtpghi_assert(realDist >= M, "realDist must be at least M");
+
+    switch (backend) {
+#ifdef RTPGHI_HAVE_FFTW
+        case FFT_BACKEND_FFTW:
+            return fft_fftw_create(M, howmany, inverse, real, realDist, cpx);
+#endif
+        case FFT_BACKEND_BUILTIN:
+            return fft_builtin_create(M, howmany, inverse, real, realDist,
+                                      cpx);
+        default:
+            return nullptr;
+    }
+}
+
+fft_backend_t fft_default_backend() {
+#if defined(RTPGHI_HAVE_FFTW) && !defined(RTPGHI_FFT_BUILTIN)
+    return FFT_BACKEND_FFTW;
+#else
+    return FFT_BACKEND_BUILTIN;
+#endif
+}
+
+bool fft_backend_available(fft_backend_t backend) {
+#ifdef RTPGHI_HAVE_FFTW
+    if (backend == FFT_BACKEND_FFTW) return true;
+#endif
+    return backend == FFT_BACKEND_BUILTIN;
+}
+
+const char *fft_backend_name(fft_backend_t backend) {
+    switch (backend) {
+        case FFT_BACKEND_FFTW:
+            return "fftw";
+        case FFT_BACKEND_BUILTIN:
+            return "builtin";
+        default:
+            return "unknown";
+    }
+}
+
+void *fft_alloc(size_t bytes) {
+    // 64 bytes covers AVX-512 and a cache line; the size must be a multiple.
+    return std::aligned_alloc(64, (bytes + 63) / 64 * 64);
+}
+
+void fft_free(void *ptr) { std::free(ptr); }
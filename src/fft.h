@@ -0,0 +1,95 @@
+#ifndef FFT_H__
+#define FFT_H__
+
+#include <complex>
+#include <memory>
+
+/**
+ * FFT implementations, see fft_real_create().
+ */
+enum fft_backend_t {
+    FFT_BACKEND_FFTW,     //!< FFTW, if built with RTPGHI_HAVE_FFTW
+    FFT_BACKEND_BUILTIN,  //!< Bundled radix-2 FFT, power-of-two sizes only
+};
+
+/**
+ * Real-to-complex (forward) or complex-to-real (inverse) FFT of length M,
+ * between the buffers given at creation.
+ *
+ * Follows the FFTW conventions: M/2+1 complex coefficients, no scaling in
+ * either direction, the imaginary parts of the DC and Nyquist coefficients
+ * are ignored by the inverse, and the input of the inverse may be
+ * overwritten.
+ */
+class fft_real_t {
+   public:
+    virtual ~fft_real_t() = default;
+
+    /**
+     * Transform the input buffer into the output buffer. Does not allocate,
+     * and may run concurrently with other instances.
+     */
+    virtual void execute() = 0;
+};
+
+/**
+ * Create a transform. Creation and destruction may be serialized internally
+ * (FFTW planner), execute() is not.
+ *
+ * \param[in]  backend  Implementation
+ * \param[in]  M        Transform length
+ * \param[in]  inverse  Complex-to-real if true, real-to-complex otherwise
+ * \param[in]  real     Real buffer, M samples, see fft_alloc()
+ * \param[in]  cpx      Complex buffer, M/2+1 coefficients, see fft_alloc()
+ *
+ * \returns nullptr if the backend is not available
+ */
+std::unique_ptr<fft_real_t> fft_real_create(fft_backend_t backend, int M,
+                                            bool inverse, double *real,
+                                            std::complex<double> *cpx);
+
+/**
+ * Same as fft_real_create(), but execute() runs howmany transforms of the
+ * same length at once, e.g. all channels of several frames (FFTW's
+ * advanced interface). Transform k is between real + k * realDist and
+ * cpx + k * (M/2+1).
+ *
+ * \param[in]  howmany   Number of transforms
+ * \param[in]  realDist  Distance between the real buffers, at least M
+ */
+std::unique_ptr<fft_real_t> fft_real_create_batch(fft_backend_t backend,
+                                                  int M, int howmany,
+                                                  bool inverse, double *real,
+                                                  int realDist,
+                                                  std::complex<double> *cpx);
+
+/**
+ * Backend selected at configure time (RTPGHI_FFT_BACKEND).
+ */
+fft_backend_t fft_default_backend();
+
+bool fft_backend_available(fft_backend_t backend);
+
+const char *fft_backend_name(fft_backend_t backend);
+
+/**
+ * Allocate memory aligned for SIMD transforms, free with fft_free().
+ */
+void *fft_alloc(size_t bytes);
+
+void fft_free(void *ptr);
+
+// Backends, use fft_real_create()
+
+std::unique_ptr<fft_real_t> fft_builtin_create(int M, int howmany,
+                                               bool inverse, double *real,
+                                               int                   realDist,
+                                               std::complex<double> *cpx);
+
+#ifdef RTPGHI_HAVE_FFTW
+std::unique_ptr<fft_real_t> fft_fftw_create(int M, int howmany, bool inverse,
+                                            double *real, int realDist,
+                                            std::complex<double> *cpx);
+#endif
+
+#endif  // FFT_H__
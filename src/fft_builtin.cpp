@@ -0,0 +1,234 @@
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "fft.h"
+#include "rtpghi.h"
+
+/**
+ * Real FFT of power-of-two length M, computed as a complex FFT of length
+ * N = M/2 on the even (real part) and odd (imaginary part) samples, and a
+ * twiddle pass separating the two spectra. The complex FFT is an iterative
+ * radix-2 decimation in time with contiguous per-stage twiddle tables and
+ * specialized first two stages. Everything is done in place in the complex
+ * buffer, which is M/2+1 coefficients long and holds the M real samples.
+ */
+class fft_builtin_t final : public fft_real_t {
+   public:
+    fft_builtin_t(int M, int howmany, bool inverse, double *real, int realDist,
+                  std::complex<double> *cpx)
+        : _M(M),
+          _N(M / 2),
+          _howmany(howmany),
+          _realDist(realDist),
+          _inverse(inverse),
+          _real(real),
+          _z(reinterpret_cast<double *>(cpx)) {
+        rtpghi_assert(M >= 2 && (M & (M - 1)) == 0,
+                      "M must be a power of two");
+
+        // Bit-reversal permutation, as swap pairs
+        for (int ii = 0, jj = 0; ii < _N; ++ii) {
+            if (ii < jj) {
+                _swaps.push_back(ii);
+                _swaps.push_back(jj);
+            }
+            int bit = _N >> 1;
+            for (; bit > 0 && (jj & bit); bit >>= 1) jj ^= bit;
+            jj |= bit;
+        }
+
+        // Stage twiddles e^(-2 pi i j/len), j < len/2, for len = 8..N
+        for (int len = 8; len <= _N; len <<= 1) {
+            for (int j = 0; j < len / 2; ++j) {
+                _twiddles.push_back(std::cos(2 * M_PI * j / len));
+                _twiddles.push_back(-std::sin(2 * M_PI * j / len));
+            }
+        }
+
+        // Split twiddles e^(-2 pi i k/M), k <= N/2
+        for (int k = 0; k <= _N / 2; ++k) {
+            _split.push_back(std::cos(2 * M_PI * k / _M));
+            _split.push_back(-std::sin(2 * M_PI * k / _M));
+        }
+    }
+
+    void execute() override {
+        // One transform after the other, the tables stay in cache
+        for (int k = 0; k < _howmany; ++k) {
+            double *real = _real + k * _realDist;
+            double *z = _z + k * 2 * (_N + 1);
+
+            if (_inverse) {
+                execute_c2r(z, real);
+            } else {
+                execute_r2c(real, z);
+            }
+        }
+    }
+
+   private:
+    void execute_r2c(const double *real, double *z);
+    void execute_c2r(double *z, double *real);
+
+    /**
+     * Unnormalized complex FFT of the N interleaved coefficients in z,
+     * e^(+2 pi i...) kernel if inverse.
+     */
+    void complex_fft(double *z, bool inverse);
+
+    int                 _M;
+    int                 _N;
+    int                 _howmany;   //!< Number of transforms
+    int                 _realDist;  //!< Distance between the real buffers
+    bool                _inverse;
+    double             *_real;      //!< Real buffers, M samples each
+    double             *_z;         //!< Complex buffers, interleaved
+    std::vector<int>    _swaps;     //!< Bit-reversal swap pairs
+    std::vector<double> _twiddles;  //!< Stage twiddles, interleaved
+    std::vector<double> _split;     //!< Split twiddles, interleaved
+};
+
+void fft_builtin_t::complex_fft(double *z, bool inverse) {
+    double sign = inverse ? -1.0 : 1.0;
+
+    for (size_t ii = 0; ii < _swaps.size(); ii += 2) {
+        int a = 2 * _swaps[ii];
+        int b = 2 * _swaps[ii + 1];
+        std::swap(z[a], z[b]);
+        std::swap(z[a + 1], z[b + 1]);
+    }
+
+    // len = 2: twiddle 1
+    if (_N >= 2) {
+        for (int ii = 0; ii < 2 * _N; ii += 4) {
+            double ar = z[ii], ai = z[ii + 1];
+            double br = z[ii + 2], bi = z[ii + 3];
+            z[ii] = ar + br;
+            z[ii + 1] = ai + bi;
+            z[ii + 2] = ar - br;
+            z[ii + 3] = ai - bi;
+        }
+    }
+
+    // len = 4: twiddles 1 and -i (+i for the inverse)
+    if (_N >= 4) {
+        for (int ii = 0; ii < 2 * _N; ii += 8) {
+            double ar = z[ii], ai = z[ii + 1];
+            double cr = z[ii + 4], ci = z[ii + 5];
+            z[ii] = ar + cr;
+            z[ii + 1] = ai + ci;
+            z[ii + 4] = ar - cr;
+            z[ii + 5] = ai - ci;
+
+            double br = z[ii + 2], bi = z[ii + 3];
+            double dr = sign * z[ii + 7], di = -sign * z[ii + 6];
+            z[ii + 2] = br + dr;
+            z[ii + 3] = bi + di;
+            z[ii + 6] = br - dr;
+            z[ii + 7] = bi - di;
+        }
+    }
+
+    const double *tw = _twiddles.data();
+
+    for (int len = 8; len <= _N; len <<= 1) {
+        int half = len / 2;
+
+        for (int start = 0; start < _N; start += len) {
+            double *lo = z + 2 * start;
+            double *hi = lo + len;
+
+            for (int j = 0; j < half; ++j) {
+                double wr = tw[2 * j], wi = sign * tw[2 * j + 1];
+                double hr = hi[2 * j], hi_ = hi[2 * j + 1];
+                double tr = hr * wr - hi_ * wi;
+                double ti = hr * wi + hi_ * wr;
+                double lr = lo[2 * j], li = lo[2 * j + 1];
+
+                lo[2 * j] = lr + tr;
+                lo[2 * j + 1] = li + ti;
+                hi[2 * j] = lr - tr;
+                hi[2 * j + 1] = li - ti;
+            }
+        }
+        tw += len;
+    }
+}
+
+void fft_builtin_t::execute_r2c(const double *real, double *z) {
+    // Even samples as real parts, odd samples as imaginary parts. The input
+    // is kept, as with FFTW.
+    std::copy(real, real + _M, z);
+
+    complex_fft(z, false);
+
+    // X[k] = A + W^k B and X[N-k] = conj(A - W^k B), with
+    // A = (Z[k] + conj(Z[N-k]))/2 and B = -i (Z[k] - conj(Z[N-k]))/2
+    for (int k = 1; k <= _N / 2; ++k) {
+        int    c = _N - k;
+        double zr = z[2 * k], zi = z[2 * k + 1];
+        double cr = z[2 * c], ci = -z[2 * c + 1];
+
+        double ar = 0.5 * (zr + cr), ai = 0.5 * (zi + ci);
+        double br = 0.5 * (zi - ci), bi = -0.5 * (zr - cr);
+        double wr = _split[2 * k], wi = _split[2 * k + 1];
+        double tr = wr * br - wi * bi;
+        double ti = wr * bi + wi * br;
+
+        z[2 * k] = ar + tr;
+        z[2 * k + 1] = ai + ti;
+        if (c != k) {
+            z[2 * c] = ar - tr;
+            z[2 * c + 1] = -(ai - ti);
+        }
+    }
+
+    double z0r = z[0], z0i = z[1];
+    z[0] = z0r + z0i;
+    z[1] = 0;
+    z[2 * _N] = z0r - z0i;
+    z[2 * _N + 1] = 0;
+}
+
+void fft_builtin_t::execute_c2r(double *z, double *real) {
+    // Z[k] = S + T and Z[N-k] = conj(S - T), with P = X[k],
+    // Q = conj(X[N-k]), S = P + Q and T = i W^-k (P - Q). The imaginary
+    // parts of X[0] and X[N] are ignored.
+    double x0 = z[0], xn = z[2 * _N];
+    z[0] = x0 + xn;
+    z[1] = x0 - xn;
+
+    for (int k = 1; k <= _N / 2; ++k) {
+        int    c = _N - k;
+        double pr = z[2 * k], pi = z[2 * k + 1];
+        double qr = z[2 * c], qi = -z[2 * c + 1];
+
+        double sr = pr + qr, si = pi + qi;
+        double dr = pr - qr, di = pi - qi;
+        double wr = _split[2 * k], wi = -_split[2 * k + 1];
+        double tr = -(wr * di + wi * dr);
+        double ti = wr * dr - wi * di;
+
+        z[2 * k] = sr + tr;
+        z[2 * k + 1] = si + ti;
+        if (c != k) {
+            z[2 * c] = sr - tr;
+            z[2 * c + 1] = -(si - ti);
+        }
+    }
+
+    complex_fft(z, true);
+
+    std::copy(z, z + _M, real);
+}
+
+std::unique_ptr<fft_real_t> fft_builtin_create(int M, int howmany,
+                                               bool inverse, double *real,
+                                               int                   realDist,
+                                               std::complex<double> *cpx) {
+    return std::make_unique<fft_builtin_t>(M, howmany, inverse, real, realDist,
+                                           cpx);
+}
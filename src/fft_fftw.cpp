@@ -0,0 +1,60 @@
+#include <fftw3.h>
+
+#include <mutex>
+
+#include "fft.h"
+
+/**
+ * Only fftw_execute is thread-safe, the planner must not be entered from
+ * several threads at once.
+ */
+static std::mutex &planner_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+static fftw_complex *cpx_stl2fftw(std::complex<double> *arr) {
+    return reinterpret_cast<fftw_complex *>(arr);
+}
+
+class fft_fftw_t final : public fft_real_t {
+   public:
+    fft_fftw_t(int M, int howmany, bool inverse, double *real, int realDist,
+               std::complex<double> *cpx) {
+        std::lock_guard<std::mutex> lock(planner_mutex());
+        int                         M2 = M / 2 + 1;
+
+        if (howmany > 1 && inverse) {
+            _plan = fftw_plan_many_dft_c2r(1, &M, howmany, cpx_stl2fftw(cpx),
+                                           nullptr, 1, M2, real, nullptr, 1,
+                                           realDist, FFTW_MEASURE);
+        } else if (howmany > 1) {
+            _plan = fftw_plan_many_dft_r2c(1, &M, howmany, real, nullptr, 1,
+                                           realDist, cpx_stl2fftw(cpx),
+                                           nullptr, 1, M2, FFTW_MEASURE);
+        } else if (inverse) {
+            _plan = fftw_plan_dft_c2r_1d(M, cpx_stl2fftw(cpx), real,
+                                         FFTW_MEASURE);
+        } else {
+            _plan = fftw_plan_dft_r2c_1d(M, real, cpx_stl2fftw(cpx),
+                                         FFTW_MEASURE);
+        }
+    }
+
+    ~fft_fftw_t() {
+        std::lock_guard<std::mutex> lock(planner_mutex());
+        fftw_destroy_plan(_plan);
+    }
+
+    void execute() override { fftw_execute(_plan); }
+
+   private:
+    fftw_plan _plan;
+};
+
+std::unique_ptr<fft_real_t> fft_fftw_create(int M, int howmany, bool inverse,
+                                            double *real, int realDist,
+                                            std::complex<double> *cpx) {
+    return std::make_unique<fft_fftw_t>(M, howmany, inverse, real, realDist,
+                                        cpx);
+}
@@ -0,0 +1,71 @@
+#ifndef FPENV_H__
+#define FPENV_H__
+
+#include <cstdint>
+
+#if defined(__SSE2__)
+    #include <immintrin.h>
+#endif
+
+/**
+ * Enables flush-to-zero and denormals-are-zero for the lifetime of the
+ * object, then restores the previous floating-point control state of the
+ * thread. Subnormal operands and results cost up to a hundred times the
+ * cycles of normal ones on most x86 CPUs.
+ *
+ * Sets FTZ and DAZ in MXCSR on SSE2, and FZ in FPCR on AArch64 (which also
+ * flushes inputs). Does nothing on other targets, or if enable is false.
+ */
+class denormal_scope_t final {
+   public:
+    explicit denormal_scope_t(bool enable) : _enabled(enable) {
+        if (!_enabled) return;
+#if defined(__SSE2__)
+        _saved = _mm_getcsr();
+        _mm_setcsr(_saved | FTZ_DAZ);
+#elif defined(__aarch64__)
+        asm volatile("mrs %0, fpcr" : "=r"(_saved));
+        asm volatile("msr fpcr, %0" : : "r"(_saved | FZ));
+#endif
+    }
+
+    ~denormal_scope_t() {
+        if (!_enabled) return;
+#if defined(__SSE2__)
+        _mm_setcsr(_saved);
+#elif defined(__aarch64__)
+        asm volatile("msr fpcr, %0" : : "r"(_saved));
+#endif
+    }
+
+    /**
+     * Whether flush-to-zero is on in the calling thread, e.g. to carry the
+     * caller's setting over to worker threads.
+     */
+    static bool active() {
+#if defined(__SSE2__)
+        return (_mm_getcsr() & FTZ_DAZ) == FTZ_DAZ;
+#elif defined(__aarch64__)
+        uint64_t fpcr;
+        asm volatile("mrs %0, fpcr" : "=r"(fpcr));
+        return (fpcr & FZ) != 0;
+#else
+        return false;
+#endif
+    }
+
+    denormal_scope_t(const denormal_scope_t &) = delete;
+    denormal_scope_t &operator=(const denormal_scope_t &) = delete;
+
+   private:
+#if defined(__SSE2__)
+    static constexpr unsigned int FTZ_DAZ = 0x8040;  //!< Bits 15 and 6
+    unsigned int                  _saved = 0;
+#elif defined(__aarch64__)
+    static constexpr uint64_t FZ = uint64_t(1) << 24;
+    uint64_t                  _saved = 0;
+#endif
+    bool _enabled;
+};
+
+#endif  // FPENV_H__
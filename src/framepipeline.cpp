@@ -0,0 +1,81 @@
+#include "framepipeline.h"
+
+#include <limits>
+
+#include "rtpghi.h"
+#include "rtpghi_trace_p.h"
+
+frame_pipeline_t::frame_pipeline_t(int numStages, int numSlots,
+                                   frame_pipeline_stage *stage,
+                                   void                 *userdata) {
+    rtpghi_assert(numStages >= 2, "numStages must be at least 2");
+    rtpghi_assert(numSlots >= numStages, "numSlots must be at least numStages");
+    rtpghi_assert(stage != nullptr, "stage must not be null");
+
+    _done = std::make_unique<std::atomic<int64_t>[]>(numStages);
+    for (int s = 0; s < numStages; ++s) _done[s].store(0);
+
+    _stop.store(false);
+    _stage = stage;
+    _userdata = userdata;
+    _submitted = 0;
+    _numStages = numStages;
+    _numSlots = numSlots;
+
+    for (int s = 1; s < numStages; ++s) {
+        _workers.emplace_back(&frame_pipeline_t::run, this, s);
+    }
+}
+
+frame_pipeline_t::~frame_pipeline_t() {
+    _stop.store(true);
+
+    // Release the workers from their waits
+    for (int s = 0; s < _numStages; ++s) {
+        _done[s].store(std::numeric_limits<int64_t>::max());
+        _done[s].notify_all();
+    }
+
+    for (std::thread &t : _workers) t.join();
+}
+
+int frame_pipeline_t::get_numstages() const { return _numStages; }
+
+void frame_pipeline_t::wait_above(const std::atomic<int64_t> &counter,
+                                  int64_t                     value) {
+    int64_t current;
+
+    while ((current = counter.load(std::memory_order_acquire)) <= value) {
+        counter.wait(current, std::memory_order_acquire);
+    }
+}
+
+int frame_pipeline_t::acquire() {
+    // Frame _submitted - _numSlots used the same slot
+    wait_above(_done[_numStages - 1], _submitted - _numSlots);
+
+    return _submitted % _numSlots;
+}
+
+void frame_pipeline_t::submit() {
+    _done[0].store(++_submitted, std::memory_order_release);
+    _done[0].notify_all();
+}
+
+void frame_pipeline_t::drain() {
+    wait_above(_done[_numStages - 1], _submitted - 1);
+}
+
+void frame_pipeline_t::run(int stage) {
+    for (int64_t frame = 0;; ++frame) {
+        wait_above(_done[stage - 1], frame);
+        if (_stop.load()) break;
+
+        _stage(_userdata, stage, frame % _numSlots);
+
+        _done[stage].store(frame + 1, std::memory_order_release);
+        _done[stage].notify_all();
+    }
+
+    RTPGHI_TRACE_THREAD_EXIT();
+}
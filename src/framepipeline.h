@@ -0,0 +1,76 @@
+#ifndef FRAMEPIPELINE_H__
+#define FRAMEPIPELINE_H__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs one stage of the frame in slot.
+ *
+ * \param[in]  userdata  User defined data
+ * \param[in]  stage     Stage, from 1 to numStages - 1
+ * \param[in]  slot      Slot of the frame
+ */
+using frame_pipeline_stage = void(void *userdata, int stage, int slot);
+
+/**
+ * Frames passed through a fixed sequence of stages, each stage running on
+ * its own thread, so that consecutive frames are in different stages at the
+ * same time.
+ *
+ * Stage 0 runs on the calling thread: acquire() a slot, fill it, submit()
+ * it. Stages 1 to numStages - 1 run on worker threads, in order of
+ * submission, and every stage sees the frames in that order. The frame data
+ * lives in numSlots slots owned by the caller; a slot is reused once the
+ * last stage is done with it.
+ */
+class frame_pipeline_t final {
+   public:
+    /**
+     * Start numStages - 1 worker threads.
+     *
+     * \param[in]  numStages  Number of stages, at least 2
+     * \param[in]  numSlots   Number of frames in flight, at least numStages
+     * \param[in]  stage      Stages 1 and up
+     * \param[in]  userdata   Passed to stage
+     */
+    frame_pipeline_t(int numStages, int numSlots, frame_pipeline_stage *stage,
+                     void *userdata);
+
+    /** Stop the workers, the pipeline must be drained */
+    ~frame_pipeline_t();
+
+    frame_pipeline_t(const frame_pipeline_t &) = delete;
+    frame_pipeline_t &operator=(const frame_pipeline_t &) = delete;
+
+    int get_numstages() const;
+
+    /** Wait for the slot of the next frame to be free and return it */
+    int acquire();
+
+    /** Hand the acquired slot over to stage 1 */
+    void submit();
+
+    /** Wait until the last stage is done with all the submitted frames */
+    void drain();
+
+   private:
+    /** Wait until counter is greater than value */
+    static void wait_above(const std::atomic<int64_t> &counter, int64_t value);
+
+    void run(int stage);
+
+    std::vector<std::thread>                _workers;
+    std::unique_ptr<std::atomic<int64_t>[]> _done;  //!< Frames done per stage
+    std::atomic<bool>                       _stop;
+    frame_pipeline_stage                   *_stage;
+    void                                   *_userdata;
+    int64_t                                 _submitted;
+    int                                     _numStages;
+    int                                     _numSlots;
+};
+
+#endif  // FRAMEPIPELINE_H__
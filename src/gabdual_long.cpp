@@ -0,0 +1,143 @@
+#include "gabdual_long.h"
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "gabdual_painless.h"
+#include "rtpghi.h"
+
+/**
+ * Solve the n x n system A x = b in place by Gaussian elimination with
+ * partial pivoting, A row-major. Returns false if A is singular.
+ */
+static bool solve_dense(std::vector<double> &A, std::vector<double> &b,
+                        int n) {
+    for (int col = 0; col < n; ++col) {
+        int piv = col;
+        for (int row = col + 1; row < n; ++row) {
+            if (std::fabs(A[row * n + col]) > std::fabs(A[piv * n + col])) {
+                piv = row;
+            }
+        }
+        if (A[piv * n + col] == 0.0) return false;
+
+        if (piv != col) {
+            for (int jj = 0; jj < n; ++jj) {
+                std::swap(A[piv * n + jj], A[col * n + jj]);
+            }
+            std::swap(b[piv], b[col]);
+        }
+
+        for (int row = col + 1; row < n; ++row) {
+            double f = A[row * n + col] / A[col * n + col];
+            for (int jj = col; jj < n; ++jj) {
+                A[row * n + jj] -= f * A[col * n + jj];
+            }
+            b[row] -= f * b[col];
+        }
+    }
+
+    for (int row = n - 1; row >= 0; --row) {
+        double acc = b[row];
+        for (int jj = row + 1; jj < n; ++jj) acc -= A[row * n + jj] * b[jj];
+        b[row] = acc / A[row * n + row];
+    }
+    return true;
+}
+
+bool gabdual_long(const double g[], int gl, int a, int M, double gd[]) {
+    rtpghi_assert(gl > 0, "gl must be positive");
+    rtpghi_assert(a > 0, "a must be positive");
+    rtpghi_assert(M > 0, "M must be positive");
+
+    // Window support in time: [tmin, tmax], stored at t (t >= 0) or t + gl
+    const int tmax = (gl + 1) / 2 - 1;
+    const int tmin = tmax - gl + 1;
+    const int K = gl / M + 1;
+
+    auto index = [gl](int t) { return t >= 0 ? t : t + gl; };
+
+    std::vector<int>    times;
+    std::vector<int>    ks;
+    std::vector<double> A;    // Equations x unknowns
+    std::vector<double> AAt;  // Normal matrix
+    std::vector<double> y;
+    bool                ok = true;
+
+    for (int r = 0; r < a; ++r) {
+        // Unknowns: gd at the support times congruent to r
+        times.clear();
+        int first = tmin + ((r - tmin) % a + a) % a;
+        for (int t = first; t <= tmax; t += a) times.push_back(t);
+
+        int n = times.size();
+        if (n == 0) continue;
+
+        // Equations: M sum_t g(t - kM) gd(t) = delta_k, for the k where
+        // the shifted window overlaps the unknowns
+        ks.clear();
+        A.clear();
+        for (int k = -K; k <= K; ++k) {
+            bool any = false;
+            for (int t : times) {
+                int    s = t - k * M;
+                double v = s >= tmin && s <= tmax ? M * g[index(s)] : 0.0;
+                A.push_back(v);
+                any |= v != 0.0;
+            }
+            if (any) {
+                ks.push_back(k);
+            } else {
+                A.resize(A.size() - n);
+            }
+        }
+
+        int m = ks.size();
+
+        // Minimum norm solution: gd = A^T (A A^T)^-1 e_0
+        AAt.assign(m * m, 0.0);
+        y.assign(m, 0.0);
+        for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < m; ++j) {
+                double acc = 0;
+                for (int l = 0; l < n; ++l) acc += A[i * n + l] * A[j * n + l];
+                AAt[i * m + j] = acc;
+            }
+            if (ks[i] == 0) y[i] = 1.0;
+        }
+
+        bool solved = m > 0 && solve_dense(AAt, y, m);
+        for (int l = 0; l < n; ++l) {
+            double acc = 0;
+            for (int i = 0; solved && i < m; ++i) acc += A[i * n + l] * y[i];
+            gd[index(times[l])] = acc;
+        }
+
+        // A singular or nearly singular system has no exact solution in
+        // general (e.g. a Hann window four times as long as M, whose shifts
+        // by M sum to zero with alternating signs), check the equations.
+        for (int i = 0; solved && i < m; ++i) {
+            double acc = 0;
+            for (int l = 0; l < n; ++l) {
+                acc += A[i * n + l] * gd[index(times[l])];
+            }
+            solved = std::fabs(acc - (ks[i] == 0)) < 1e-9;
+        }
+
+        if (!solved) {
+            for (int t : times) gd[index(t)] = 0;
+        }
+        ok &= solved;
+    }
+
+    return ok;
+}
+
+bool gabdual(const double g[], int gl, int a, int M, double gd[]) {
+    if (M >= gl) {
+        gabdual_painless(g, gl, a, M, gd);
+        return true;
+    }
+    return gabdual_long(g, gl, a, M, gd);
+}
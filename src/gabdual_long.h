@@ -0,0 +1,33 @@
+#ifndef GABDUAL_LONG_H__
+#define GABDUAL_LONG_H__
+
+/** Compute a dual window with the same support as the window, for any
+ * window length
+ *
+ * For each of the a residue classes of the window support, the dual
+ * condition of the Walnut representation gives a small underdetermined
+ * linear system (one equation per multiple of M overlapping the support);
+ * its minimum norm solution is used. For gl <= M there is a single
+ * equation per class and the result is the canonical dual of
+ * gabdual_painless(). Otherwise it is the dual of least energy among those
+ * supported on gl samples, which is exact but differs from the (infinitely
+ * supported) canonical dual.
+ *
+ * \param[in]   g    Original window, whole-point symmetric, zero delay
+ * \param[in]  gl    Length of the windows
+ * \param[in]   a    Hop factor
+ * \param[in]   M    Number of channels
+ * \param[out] gd    Dual window
+ *
+ * \returns false if no dual with this support exists (e.g. a >= M or the
+ * window vanishes on a whole residue class), gd is then zero on the
+ * classes that failed
+ */
+bool gabdual_long(const double g[], int gl, int a, int M, double gd[]);
+
+/** Dual window for the processor: gabdual_painless() if M >= gl,
+ * gabdual_long() otherwise
+ */
+bool gabdual(const double g[], int gl, int a, int M, double gd[]);
+
+#endif  // GABDUAL_LONG_H__
@@ -0,0 +1,74 @@
+#include "mirrorbuf.h"
+
+#include "rtpghi.h"
+
+#ifdef RTPGHI_MIRRORED_FIFO
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+mirrored_buffer_t::mirrored_buffer_t(int minLen, int numChans)
+    : _data(nullptr), _mapLen(0), _len(0) {
+    rtpghi_assert(minLen > 0, "minLen must be positive");
+    rtpghi_assert(numChans > 0, "numChans must be positive");
+
+#ifdef RTPGHI_MIRRORED_FIFO
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t chanBytes = minLen * sizeof(double);
+    chanBytes = (chanBytes + pageSize - 1) / pageSize * pageSize;
+
+    int fd = memfd_create("rtpghi_fifo", MFD_CLOEXEC);
+    if (fd < 0) return;
+
+    if (ftruncate(fd, numChans * chanBytes) < 0) {
+        close(fd);
+        return;
+    }
+
+    // Reserve the whole address range first so that the views can be
+    // placed next to each other.
+    size_t mapLen = 2 * numChans * chanBytes;
+    void  *base = mmap(nullptr, mapLen, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS,
+                       -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return;
+    }
+
+    for (int w = 0; w < numChans; ++w) {
+        char *chanBase = static_cast<char *>(base) + 2 * w * chanBytes;
+
+        for (int view = 0; view < 2; ++view) {
+            void *p = mmap(chanBase + view * chanBytes, chanBytes,
+                           PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+                           w * chanBytes);
+            if (p == MAP_FAILED) {
+                munmap(base, mapLen);
+                close(fd);
+                return;
+            }
+        }
+    }
+
+    // The mappings keep the memory alive.
+    close(fd);
+
+    _data = static_cast<double *>(base);
+    _mapLen = mapLen;
+    _len = chanBytes / sizeof(double);
+#endif
+}
+
+mirrored_buffer_t::~mirrored_buffer_t() {
+#ifdef RTPGHI_MIRRORED_FIFO
+    if (_data) munmap(_data, _mapLen);
+#endif
+}
+
+bool mirrored_buffer_t::valid() const { return _data != nullptr; }
+
+int mirrored_buffer_t::get_len() const { return _len; }
+
+int mirrored_buffer_t::get_chanstride() const { return 2 * _len; }
+
+double *mirrored_buffer_t::data() const { return _data; }
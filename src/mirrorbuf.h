@@ -0,0 +1,44 @@
+#ifndef MIRRORBUF_H__
+#define MIRRORBUF_H__
+
+#include <cstddef>
+
+class mirrored_buffer_t final {
+   public:
+    /** Create a mirrored (double-mapped) ring buffer storage
+     *
+     * Each channel is backed by a shared memory region mapped twice back to
+     * back, so that any run of up to get_len() samples starting anywhere in
+     * [0, get_len()[ is contiguous in virtual memory.
+     *
+     * The channel length is rounded up to a whole number of pages. If the
+     * mapping cannot be created, valid() returns false and the object must
+     * not be used.
+     *
+     * \param[in]  minLen    Minimum ring length in samples
+     * \param[in]  numChans  Number of channels
+     */
+    mirrored_buffer_t(int minLen, int numChans);
+
+    ~mirrored_buffer_t();
+
+    mirrored_buffer_t(const mirrored_buffer_t &) = delete;
+    mirrored_buffer_t &operator=(const mirrored_buffer_t &) = delete;
+
+    bool valid() const;
+
+    /** Ring length in samples (per channel) */
+    int get_len() const;
+
+    /** Distance in samples between the starts of two channels */
+    int get_chanstride() const;
+
+    double *data() const;
+
+   private:
+    double *_data;    //!< Start of the reserved region
+    size_t  _mapLen;  //!< Length of the reserved region in bytes
+    int     _len;     //!< Ring length
+};
+
+#endif  // MIRRORBUF_H__
@@ -0,0 +1,19 @@
+#include "pcm.h"
+
+#include "pcmconv.h"
+
+int pcm_sample_size(pcm_format_t fmt) {
+    switch (fmt) {
+        case PCM_S16:
+            return pcm_size<PCM_S16>();
+        case PCM_S24:
+            return pcm_size<PCM_S24>();
+        case PCM_S32:
+            return pcm_size<PCM_S32>();
+        case PCM_F32:
+            return pcm_size<PCM_F32>();
+        case PCM_F64:
+            return pcm_size<PCM_F64>();
+    }
+    return 0;
+}
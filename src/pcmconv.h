@@ -0,0 +1,171 @@
+#ifndef PCMCONV_H__
+#define PCMCONV_H__
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "pcm.h"
+
+/**
+ * Conversion of one little-endian PCM sample to double in [-1,1[.
+ */
+template <pcm_format_t fmt>
+inline double pcm_load(const unsigned char *p);
+
+template <>
+inline double pcm_load<PCM_S16>(const unsigned char *p) {
+    return (int16_t)(p[0] | p[1] << 8) * (1.0 / 32768.0);
+}
+
+template <>
+inline double pcm_load<PCM_S24>(const unsigned char *p) {
+    // Assemble in the upper bytes so that the sign is extended
+    int32_t v = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 |
+                          (uint32_t)p[2] << 24);
+    return v * (1.0 / 2147483648.0);
+}
+
+template <>
+inline double pcm_load<PCM_S32>(const unsigned char *p) {
+    int32_t v = (int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 |
+                          (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+    return v * (1.0 / 2147483648.0);
+}
+
+template <>
+inline double pcm_load<PCM_F32>(const unsigned char *p) {
+    float v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+template <>
+inline double pcm_load<PCM_F64>(const unsigned char *p) {
+    double v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ * Size of one sample in bytes, compile-time version of pcm_sample_size().
+ */
+template <pcm_format_t fmt>
+constexpr int pcm_size() {
+    return fmt == PCM_S16   ? 2
+           : fmt == PCM_S24 ? 3
+           : fmt == PCM_F64 ? 8
+                            : 4;
+}
+
+/**
+ * Convert len interleaved samples of one channel to double.
+ *
+ * \param[in]   in      First sample of the channel
+ * \param[in]   stride  Distance between two samples of in, in bytes
+ * \param[in]   len     Number of samples
+ * \param[out]  out     Output array
+ */
+template <pcm_format_t fmt>
+inline void pcm_convert(const unsigned char *in, int stride, int len,
+                        double *out) {
+    for (int ii = 0; ii < len; ++ii) {
+        out[ii] = pcm_load<fmt>(in + ii * stride);
+    }
+}
+
+/**
+ * Triangular (TPDF) dither added before rounding to integer PCM, from a
+ * linear congruential generator so that it is cheap and does not allocate.
+ */
+struct pcm_dither_t {
+    uint32_t state = 1;
+    bool     enabled = true;
+
+    /** Noise in ]-1,1[, in units of the last bit */
+    double next() {
+        if (!enabled) return 0;
+
+        state = state * 1664525u + 1013904223u;
+        double u1 = (state >> 8) * (1.0 / 16777216.0);
+        state = state * 1664525u + 1013904223u;
+        double u2 = (state >> 8) * (1.0 / 16777216.0);
+
+        return u1 - u2;
+    }
+};
+
+/**
+ * Round x (dithered, in units of the last bit) to an integer in [lo, hi].
+ */
+inline int32_t pcm_quantize(double x, double lo, double hi) {
+    x = std::floor(x + 0.5);
+    return (int32_t)(x < lo ? lo : x > hi ? hi : x);
+}
+
+/**
+ * Conversion of one sample in [-1,1[ to little-endian PCM. Integer formats
+ * are dithered and clipped.
+ */
+template <pcm_format_t fmt>
+inline void pcm_store(double v, pcm_dither_t *dither, unsigned char *p);
+
+template <>
+inline void pcm_store<PCM_S16>(double v, pcm_dither_t *dither,
+                               unsigned char *p) {
+    int32_t q = pcm_quantize(v * 32768.0 + dither->next(), -32768, 32767);
+    p[0] = (unsigned char)q;
+    p[1] = (unsigned char)(q >> 8);
+}
+
+template <>
+inline void pcm_store<PCM_S24>(double v, pcm_dither_t *dither,
+                               unsigned char *p) {
+    int32_t q =
+        pcm_quantize(v * 8388608.0 + dither->next(), -8388608, 8388607);
+    p[0] = (unsigned char)q;
+    p[1] = (unsigned char)(q >> 8);
+    p[2] = (unsigned char)(q >> 16);
+}
+
+template <>
+inline void pcm_store<PCM_S32>(double v, pcm_dither_t *dither,
+                               unsigned char *p) {
+    int32_t q = pcm_quantize(v * 2147483648.0 + dither->next(), -2147483648.0,
+                             2147483647.0);
+    p[0] = (unsigned char)q;
+    p[1] = (unsigned char)(q >> 8);
+    p[2] = (unsigned char)(q >> 16);
+    p[3] = (unsigned char)(q >> 24);
+}
+
+template <>
+inline void pcm_store<PCM_F32>(double v, pcm_dither_t *, unsigned char *p) {
+    float f = (float)v;
+    std::memcpy(p, &f, sizeof(f));
+}
+
+template <>
+inline void pcm_store<PCM_F64>(double v, pcm_dither_t *, unsigned char *p) {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+/**
+ * Convert len samples of one channel from double, and clear them.
+ *
+ * \param[in,out]  in      Samples, set to zero
+ * \param[in]      len     Number of samples
+ * \param[in,out]  dither  Dither state
+ * \param[out]     out     First sample of the channel
+ * \param[in]      stride  Distance between two samples of out, in bytes
+ */
+template <pcm_format_t fmt>
+inline void pcm_convert_clear(double *in, int len, pcm_dither_t *dither,
+                              unsigned char *out, int stride) {
+    for (int ii = 0; ii < len; ++ii) {
+        pcm_store<fmt>(in[ii], dither, out + ii * stride);
+        in[ii] = 0;
+    }
+}
+
+#endif  // PCMCONV_H__
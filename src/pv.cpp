@@ -1,15 +1,78 @@
 #include "pv.h"
 
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "gabdual_long.h"
 #include "pv_p.h"
+#include "rtpghi.h"
+
+pv_config_t pv_config_redundancy(int redundancy) {
+    pv_config_t config;
+
+    switch (redundancy) {
+        case 8:
+            break;
+        case 4:
+            // Same hop as the default, half the FFT length
+            config.fftLen = 4096;
+            config.hop = 1024;
+            config.gaussThr = 1e-2;
+            break;
+        case 2:
+            config.fftLen = 4096;
+            config.hop = 2048;
+            config.gaussThr = 1e-3;
+            break;
+        default:
+            fprintf(stderr, "Unknown redundancy %d, must be 8, 4 or 2\n",
+                    redundancy);
+            abort();
+    }
+
+    return config;
+}
+
+bool pv_config_valid(const pv_config_t &config) {
+    if (config.fftLen <= 0 || config.hop <= 0) return false;
+
+    int gl = pv_window_length(config);
+    if (gl <= 0) return false;
+
+    std::vector<double> g(gl), gd(gl);
+
+    if (config.gaussThr > 0.0) {
+        mtgauss(config.hop, config.fftLen, config.gaussThr, g.data());
+    } else {
+        firwin(config.window, gl, g.data());
+    }
+
+    return gabdual(g.data(), gl, config.hop, config.fftLen, gd.data());
+}
+
+double pv_config_fft_cost(const pv_config_t &config) {
+    double M = config.fftLen;
+
+    return 2.0 * 2.5 * M * std::log2(M) / config.hop;
+}
 
 pv_t::pv_t(double stretchmax, int Wmax, int bufLenMax) {
-    _p = new pv_priv(stretchmax, Wmax, bufLenMax);
+    _p = new pv_priv(stretchmax, Wmax, bufLenMax, pv_config_t());
+}
+
+pv_t::pv_t(double stretchmax, int Wmax, int bufLenMax,
+           const pv_config_t& config) {
+    _p = new pv_priv(stretchmax, Wmax, bufLenMax, config);
 }
 
 pv_t::~pv_t() { delete _p; }
 
 int pv_t::get_procdelay() const { return _p->get_procdelay(); }
 
+int pv_t::get_latency() const { return _p->get_latency(); }
+
 void pv_t::print_pos() const { _p->print_pos(); }
 
 size_t pv_t::next_inlen(size_t Lout) const { return _p->next_inlen(Lout); }
@@ -20,12 +83,100 @@ void pv_t::advance_by(size_t Lin, size_t Lout) { _p->advance_by(Lin, Lout); }
 
 void pv_t::set_stretch(double stretch) { _p->set_stretch(stretch); }
 
-void pv_t::execute(const double* in[], int Lin, int chan, double stretch,
-                   int Lout, double* out[]) {
-    _p->execute(in, Lin, chan, stretch, Lout, out);
+void pv_t::set_flush_denormals(bool enable) {
+    _p->set_flush_denormals(enable);
+}
+
+bool pv_t::get_flush_denormals() const { return _p->get_flush_denormals(); }
+
+void pv_t::set_pipeline_stages(int stages) { _p->set_pipeline_stages(stages); }
+
+int pv_t::get_pipeline_stages() const { return _p->get_pipeline_stages(); }
+
+void pv_t::set_batch_frames(int frames) { _p->set_batch_frames(frames); }
+
+int pv_t::get_batch_frames() const { return _p->get_batch_frames(); }
+
+void pv_t::set_channel_link(rtpghi_link_t link) { _p->set_channel_link(link); }
+
+rtpghi_link_t pv_t::get_channel_link() const {
+    return _p->get_channel_link();
+}
+
+void pv_t::set_dither(bool enable) { _p->set_dither(enable); }
+
+bool pv_t::get_dither() const { return _p->get_dither(); }
+
+void pv_t::set_frame_callback(rtdgtreal_processor_callback* callback,
+                              void*                         userdata) {
+    _p->set_frame_callback(callback, userdata);
+}
+
+void pv_t::reconstruct_phase(const std::complex<double>* in,
+                             std::complex<double>*       out) {
+    _p->reconstruct_phase(in, out);
+}
+
+void pv_t::reset() { _p->reset(); }
+
+int pv_t::execute(const double* in[], int Lin, int chan, double stretch,
+                  int Lout, double* out[]) {
+    return _p->execute(in, Lin, chan, stretch, Lout, out);
 }
 
-void pv_t::execute_compact(const double* in, int Lin, int chan, double stretch,
-                           int Lout, double* out) {
-    _p->execute_compact(in, Lin, chan, stretch, Lout, out);
-}
\ No newline at end of file
+int pv_t::execute_compact(const double* in, int Lin, int chan, double stretch,
+                          int Lout, double* out) {
+    return _p->execute_compact(in, Lin, chan, stretch, Lout, out);
+}
+
+int pv_t::execute_interleaved(const void* in, pcm_format_t fmt, int Lin,
+                              int chan, double stretch, int Lout,
+                              double* out[]) {
+    return _p->execute_interleaved(in, fmt, Lin, chan, stretch, Lout, out);
+}
+
+int pv_t::execute_pcm(const void* const in[], pcm_format_t fmt, int Lin,
+                      int chan, double stretch, int Lout, void* const out[]) {
+    return _p->execute_pcm(in, fmt, Lin, chan, stretch, Lout, out);
+}
+
+int pv_t::execute(const int16_t* in[], int Lin, int chan, double stretch,
+                  int Lout, int16_t* out[]) {
+    return _p->execute_pcm(reinterpret_cast<const void* const*>(in), PCM_S16,
+                           Lin, chan, stretch, Lout,
+                           reinterpret_cast<void* const*>(out));
+}
+
+int pv_t::execute(const int32_t* in[], int Lin, int chan, double stretch,
+                  int Lout, int32_t* out[]) {
+    return _p->execute_pcm(reinterpret_cast<const void* const*>(in), PCM_S32,
+                           Lin, chan, stretch, Lout,
+                           reinterpret_cast<void* const*>(out));
+}
+
+int pv_t::execute(const float* in[], int Lin, int chan, double stretch,
+                  int Lout, float* out[]) {
+    return _p->execute_pcm(reinterpret_cast<const void* const*>(in), PCM_F32,
+                           Lin, chan, stretch, Lout,
+                           reinterpret_cast<void* const*>(out));
+}
+
+int pv_t::pull(double* out[], int Lout, int chan, double stretch,
+               pv_reader_t* reader, void* userdata) {
+    return _p->pull(out, Lout, chan, stretch, reader, userdata);
+}
+
+int pv_t::get_seek_preroll(double stretch) const {
+    return _p->get_seek_preroll(stretch);
+}
+
+int pv_t::seek(pv_reader_t* reader, void* userdata, int chan,
+               double stretch) {
+    return _p->seek(reader, userdata, chan, stretch);
+}
+
+size_t pv_t::get_state_size() const { return _p->get_state_size(); }
+
+void pv_t::save_state(void* buf) const { _p->save_state(buf); }
+
+bool pv_t::load_state(const void* buf) { return _p->load_state(buf); }
\ No newline at end of file
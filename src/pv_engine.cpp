@@ -0,0 +1,87 @@
+#define _USE_MATH_DEFINES
+#include "pv_engine.h"
+
+#include "pv_engine_p.h"
+
+template <int M, int gl, int a, int W>
+pv_engine<M, gl, a, W>::pv_engine(double stretchmax, int bufLenMax) {
+    _p = new pv_engine_priv<M, gl, a, W>(stretchmax, bufLenMax);
+}
+
+template <int M, int gl, int a, int W>
+pv_engine<M, gl, a, W>::~pv_engine() {
+    delete _p;
+}
+
+template <int M, int gl, int a, int W>
+int pv_engine<M, gl, a, W>::get_latency() const {
+    return _p->get_latency();
+}
+
+template <int M, int gl, int a, int W>
+size_t pv_engine<M, gl, a, W>::next_inlen(size_t Lout) const {
+    return _p->next_inlen(Lout);
+}
+
+template <int M, int gl, int a, int W>
+size_t pv_engine<M, gl, a, W>::next_outlen(size_t Lin) const {
+    return _p->next_outlen(Lin);
+}
+
+template <int M, int gl, int a, int W>
+void pv_engine<M, gl, a, W>::advance_by(size_t Lin, size_t Lout) {
+    _p->advance_by(Lin, Lout);
+}
+
+template <int M, int gl, int a, int W>
+void pv_engine<M, gl, a, W>::set_stretch(double stretch) {
+    _p->set_stretch(stretch);
+}
+
+template <int M, int gl, int a, int W>
+void pv_engine<M, gl, a, W>::set_flush_denormals(bool enable) {
+    _p->set_flush_denormals(enable);
+}
+
+template <int M, int gl, int a, int W>
+bool pv_engine<M, gl, a, W>::get_flush_denormals() const {
+    return _p->get_flush_denormals();
+}
+
+template <int M, int gl, int a, int W>
+void pv_engine<M, gl, a, W>::reset() {
+    _p->reset();
+}
+
+template <int M, int gl, int a, int W>
+int pv_engine<M, gl, a, W>::execute(const double* in[], int Lin, int chan,
+                                    double stretch, int Lout, double* out[]) {
+    return _p->execute(in, Lin, chan, stretch, Lout, out);
+}
+
+template <int M, int gl, int a, int W>
+int pv_engine<M, gl, a, W>::execute_compact(const double* in, int Lin,
+                                            int chan, double stretch, int Lout,
+                                            double* out) {
+    const double* inChans[W];
+    double*       outChans[W];
+
+    // Same as rtdgtreal_processor_priv::execute_gen_compact()
+    int chanLoc = chan > W ? W : chan;
+
+    for (int w = 0; w < chanLoc; ++w) {
+        inChans[w] = &in[w * Lin];
+        outChans[w] = &out[w * Lout];
+    }
+
+    if (chan > chanLoc) {
+        std::fill(out + chanLoc * Lout, out + chan * Lout, 0);
+    }
+
+    return _p->execute(inChans, Lin, chanLoc, stretch, Lout, outChans);
+}
+
+// Configurations available to the users of pv_engine, add more here.
+
+template class pv_engine<8192, 4096, 1024, 1>;
+template class pv_engine<8192, 4096, 1024, 2>;
@@ -0,0 +1,315 @@
+#ifndef PV_ENGINE_P_H__
+#define PV_ENGINE_P_H__
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+
+#include "arrayutils.h"
+#include "circularbuf.h"
+#include "fft.h"
+#include "firwin.h"
+#include "fpenv.h"
+#include "gabdual_long.h"
+#include "pv_engine.h"
+#include "rtdgtreal_kernels.h"
+#include "rtpghi.h"
+#include "rtpghi_heap.h"
+#include "rtpghi_kernels.h"
+#include "rtpghi_p.h"
+#include "rtpghi_trace_p.h"
+
+template <int M, int gl, int a, int W>
+class pv_engine_priv final {
+   public:
+    static constexpr int M2 = M / 2 + 1;
+
+    pv_engine_priv(double stretchmax, int bufLenMax);
+
+    int get_latency() const;
+
+    size_t next_inlen(size_t Lout) const;
+
+    size_t next_outlen(size_t Lin) const;
+
+    void advance_by(size_t Lin, size_t Lout);
+
+    void set_stretch(double stretch);
+
+    void set_flush_denormals(bool enable) { _flushDenormals = enable; }
+
+    bool get_flush_denormals() const { return _flushDenormals; }
+
+    void reset();
+
+    int execute(const double* in[], int Lin, int chan, double stretch,
+                int Lout, double* out[]);
+
+   private:
+    /**
+     * Analysis and synthesis windows, in frame order (fftshifted) as in
+     * rtdgtreal_priv.
+     */
+    struct tables_t {
+        alignas(64) double g[gl];
+        alignas(64) double gd[gl];
+    };
+
+    /**
+     * Computed on first use, with the same code as the runtime path.
+     */
+    static const tables_t& tables();
+
+    struct buffers_t {
+        alignas(64) double frame[W * gl];         //!< Analysis, synthesis
+        alignas(64) double fft[gl > M ? gl : M];  //!< Real side of the FFTs
+        alignas(64) std::complex<double> cin[W * M2];
+        alignas(64) std::complex<double> cout[W * M2];
+        alignas(64) double s[W * 3 * M2];        //!< Magnitude history
+        alignas(64) double tgrad[W * 2 * M2];    //!< Time gradient history
+        alignas(64) double fgrad[W * M2];        //!< Frequency gradient
+        alignas(64) double phase[W * M2];        //!< Output phase
+        alignas(64) double phasein[W * 3 * M2];  //!< Input phase history
+    };
+
+    void process_frames();
+
+    void rtpghi_frame();
+
+    std::unique_ptr<buffers_t>        _b;
+    std::unique_ptr<fft_real_t>       _fwd[W];  //!< fft -> cin[w]
+    std::unique_ptr<fft_real_t>       _inv[W];  //!< cout[w] -> fft
+    std::unique_ptr<analysis_fifo_t>  _fwdfifo;
+    std::unique_ptr<synthesis_fifo_t> _backfifo;
+    rtpghi_update_plan                _plan;
+    int                               _bufLenMax;
+    double                            _stretch;
+    double                            _rtpghiStretch;  //!< Previous frame
+    size_t                            _in_pos;
+    size_t                            _out_pos;
+    double                            _in_in_out_offset;
+    double                            _out_in_in_offset;
+    bool                              _flushDenormals;
+};
+
+template <int M, int gl, int a, int W>
+const typename pv_engine_priv<M, gl, a, W>::tables_t&
+pv_engine_priv<M, gl, a, W>::tables() {
+    static const tables_t t = [] {
+        tables_t tab;
+        double   g[gl];
+        double   gd[gl];
+
+        firwin(FIRWIN_HANN, gl, g);
+        if (!gabdual(g, gl, a, M, gd)) {
+            fprintf(stderr,
+                    "No dual window with the support of the window\n");
+            abort();
+        }
+        fftshift(g, gl, tab.g);
+        fftshift(gd, gl, tab.gd);
+        return tab;
+    }();
+    return t;
+}
+
+template <int M, int gl, int a, int W>
+pv_engine_priv<M, gl, a, W>::pv_engine_priv(double stretchmax, int bufLenMax)
+    : _b(std::make_unique<buffers_t>()), _plan(M, W, 1e-6) {
+    int fifoSize = (bufLenMax + a) * stretchmax;
+    int procDelay = gl < fifoSize ? fifoSize : gl;
+
+    tables();
+
+    for (int w = 0; w < W; ++w) {
+        _fwd[w] = fft_real_create(fft_default_backend(), M, false, _b->fft,
+                                  _b->cin + w * M2);
+        _inv[w] = fft_real_create(fft_default_backend(), M, true, _b->fft,
+                                  _b->cout + w * M2);
+    }
+
+    _fwdfifo = std::make_unique<analysis_fifo_t>(fifoSize + gl, procDelay, gl,
+                                                 a, W);
+    _backfifo = std::make_unique<synthesis_fifo_t>(fifoSize + gl, gl, a, W);
+
+    _bufLenMax = fifoSize;
+    _flushDenormals = false;
+
+    reset();
+}
+
+template <int M, int gl, int a, int W>
+int pv_engine_priv<M, gl, a, W>::get_latency() const {
+    return (int)std::round(a + gl / 2.0 * (1.0 - _stretch));
+}
+
+template <int M, int gl, int a, int W>
+size_t pv_engine_priv<M, gl, a, W>::next_inlen(size_t Lout) const {
+    return (size_t)std::round(Lout / _rtpghiStretch + _out_in_in_offset);
+}
+
+template <int M, int gl, int a, int W>
+size_t pv_engine_priv<M, gl, a, W>::next_outlen(size_t Lin) const {
+    return (size_t)std::round((double)Lin * _rtpghiStretch +
+                              _in_in_out_offset);
+}
+
+template <int M, int gl, int a, int W>
+void pv_engine_priv<M, gl, a, W>::advance_by(size_t Lin, size_t Lout) {
+    _in_pos += Lin;
+    _out_pos += Lout;
+
+    _in_in_out_offset += Lin * _rtpghiStretch;
+    _in_in_out_offset -= Lout;
+
+    _out_in_in_offset += Lout / _rtpghiStretch;
+    _out_in_in_offset -= Lin;
+}
+
+template <int M, int gl, int a, int W>
+void pv_engine_priv<M, gl, a, W>::set_stretch(double stretch) {
+    int    newaana = std::round(a / stretch);
+    double truestretch = ((double)a) / newaana;
+
+    if (fabs(truestretch - _stretch) > std::numeric_limits<double>::epsilon()) {
+        _stretch = truestretch;
+        _fwdfifo->set_hop(newaana);
+    }
+}
+
+template <int M, int gl, int a, int W>
+void pv_engine_priv<M, gl, a, W>::reset() {
+    _fwdfifo->reset();
+    _backfifo->reset();
+
+    std::fill_n(_b->s, W * 3 * M2, 0);
+    std::fill_n(_b->tgrad, W * 2 * M2, 0);
+    std::fill_n(_b->fgrad, W * M2, 0);
+    std::fill_n(_b->phase, W * M2, 0);
+    std::fill_n(_b->phasein, W * 3 * M2, 0);
+
+    _in_pos = 0;
+    _out_pos = 0;
+    _in_in_out_offset = 0.0;
+    _out_in_in_offset = 0.0;
+
+    _rtpghiStretch = 1.0;
+    _stretch = 0.0;
+    set_stretch(1.0);
+
+    // Same random phases as after construction, as in rtpghi_priv::reset()
+    _plan.reseed();
+}
+
+template <int M, int gl, int a, int W>
+void pv_engine_priv<M, gl, a, W>::rtpghi_frame() {
+    int aanaprev = std::round(a / _rtpghiStretch);  // old stretch
+    int aananext = std::round(a / _stretch);        // new stretch
+
+    for (int w = 0; w < W; ++w) {
+        rtpghi_execute_channel(
+            _b->cin + w * M2, _b->s + w * 3 * M2, _b->tgrad + w * 2 * M2,
+            _b->fgrad + w * M2, _b->phase + w * M2, _b->phasein + w * 3 * M2,
+            &_plan, fixed_size_t<M>(), aanaprev, aananext, _rtpghiStretch,
+            _stretch, false, _b->cout + w * M2);
+    }
+
+    // Only update stretch for the next frame
+    _rtpghiStretch = _stretch;
+}
+
+template <int M, int gl, int a, int W>
+void pv_engine_priv<M, gl, a, W>::process_frames() {
+    const tables_t& t = tables();
+    const double*   frame;
+    int             frameStride;
+
+    while (_fwdfifo->read_view(&frame, &frameStride, _b->frame) > 0) {
+        RTPGHI_TRACE_SCOPE("frame", 0);
+
+        {
+            RTPGHI_TRACE_SCOPE("analysis", 0);
+            for (int w = 0; w < W; ++w) {
+                dgt_fwd_frame(frame + w * frameStride, t.g, fixed_size_t<gl>(),
+                              fixed_size_t<M>(), true, _b->fft);
+                _fwd[w]->execute();
+            }
+        }
+
+        {
+            RTPGHI_TRACE_SCOPE("process", 0);
+            rtpghi_frame();
+        }
+
+        RTPGHI_TRACE_SCOPE("synthesis", 0);
+        for (int w = 0; w < W; ++w) {
+            _inv[w]->execute();
+            dgt_inv_frame(_b->fft, nullptr, fixed_size_t<gl>(),
+                          fixed_size_t<M>(), true, _b->frame + w * gl);
+        }
+
+        _backfifo->write(_b->frame, t.gd);
+    }
+}
+
+template <int M, int gl, int a, int W>
+int pv_engine_priv<M, gl, a, W>::execute(const double* in[], int Lin,
+                                         int chan, double stretch, int Lout,
+                                         double* out[]) {
+    denormal_scope_t fpscope(_flushDenormals);
+    int              samplesWritten;
+    int              samplesRead;
+
+    advance_by(Lin, Lout);
+    set_stretch(stretch);
+
+    // Same clamping as rtdgtreal_processor_priv
+    rtpghi_assert(Lin >= 0 && Lout >= 0, "len must be nonnegative");
+    rtpghi_assert(chan >= 0, "chan must be nonnegative");
+
+    if (chan == 0 || (Lin == 0 && Lout == 0)) return 0;
+
+    for (int w = W; w < chan; ++w) std::fill(out[w], out[w] + Lout, 0);
+    chan = std::min(chan, W);
+
+    Lin = std::min(Lin, _bufLenMax);
+
+    if (Lout > _bufLenMax) {
+        for (int w = 0; w < chan; ++w) {
+            std::fill(out[w] + _bufLenMax, out[w] + Lout, 0);
+        }
+        Lout = _bufLenMax;
+    }
+
+    {
+        RTPGHI_TRACE_SCOPE("fifo write", Lin);
+        samplesWritten = _fwdfifo->write(in, Lin, chan);
+    }
+
+    process_frames();
+
+    {
+        RTPGHI_TRACE_SCOPE("fifo read", Lout);
+        samplesRead = _backfifo->read(Lout, chan, out);
+    }
+
+    // Do not leave stale data behind on a short read
+    for (int w = 0; w < chan; ++w) {
+        std::fill(out[w] + samplesRead, out[w] + Lout, 0);
+    }
+
+    if (samplesWritten != Lin) {
+        RTPGHI_TRACE_INSTANT("short write", Lin - samplesWritten);
+    }
+    if (samplesRead != Lout) {
+        RTPGHI_TRACE_INSTANT("short read", Lout - samplesRead);
+    }
+
+    return samplesRead;
+}
+
+#endif  // PV_ENGINE_P_H__
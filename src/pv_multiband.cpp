@@ -0,0 +1,33 @@
+#include "pv_multiband.h"
+
+#include "pv_multiband_p.h"
+
+pv_multiband_t::pv_multiband_t(double stretchmax, int Wmax, int bufLenMax,
+                               const pv_config_t bands[], int numBands) {
+    _p = new pv_multiband_priv(stretchmax, Wmax, bufLenMax, bands, numBands);
+}
+
+pv_multiband_t::~pv_multiband_t() { delete _p; }
+
+int pv_multiband_t::get_numbands() const { return _p->get_numbands(); }
+
+int pv_multiband_t::get_latency() const { return _p->get_latency(); }
+
+double pv_multiband_t::get_fft_cost() const { return _p->get_fft_cost(); }
+
+void pv_multiband_t::set_stretch(double stretch) { _p->set_stretch(stretch); }
+
+void pv_multiband_t::set_flush_denormals(bool enable) {
+    _p->set_flush_denormals(enable);
+}
+
+bool pv_multiband_t::get_flush_denormals() const {
+    return _p->get_flush_denormals();
+}
+
+void pv_multiband_t::reset() { _p->reset(); }
+
+int pv_multiband_t::pull(double* out[], int Lout, int chan, double stretch,
+                         pv_reader_t* reader, void* userdata) {
+    return _p->pull(out, Lout, chan, stretch, reader, userdata);
+}
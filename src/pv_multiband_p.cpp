@@ -0,0 +1,343 @@
+#include "pv_multiband_p.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "fpenv.h"
+#include "pv_p.h"
+#include "rtpghi.h"
+
+/** Steps of the stretch range when sizing the delay lines */
+#define DELAY_SEARCH_STEPS 1024
+
+pv_multiband_priv::pv_multiband_priv(double stretchmax, int Wmax,
+                                     int bufLenMax, const pv_config_t bands[],
+                                     int numBands) {
+    rtpghi_assert(numBands > 0, "numBands must be positive");
+    rtpghi_assert(Wmax > 0, "Wmax must be positive");
+    rtpghi_assert(bufLenMax > 0, "bufLenMax must be positive");
+
+    _grain = 1 << (numBands - 1);
+    _chunkMax = (bufLenMax + _grain - 1) / _grain * _grain;
+    _Wmax = Wmax;
+    _anaPtrs.resize(Wmax);
+    _synPtrs.resize(Wmax);
+    _carry = std::make_unique<double[]>(Wmax * _grain);
+    _flushDenormals = false;
+    _reader = nullptr;
+    _userdata = nullptr;
+    _chan = 0;
+    _pulled = 0;
+
+    _hopMin = bands[0].hop;
+    for (int k = 1; k < numBands; ++k) {
+        _hopMin = std::min(_hopMin, bands[k].hop);
+    }
+
+    // The bands pull their input independently, so a band can lag behind
+    // the others by up to what their FIFOs hold.
+    int lookahead = 0;
+    for (int k = 0; k < numBands; ++k) {
+        int maxLen = _chunkMax >> k;
+
+        rtpghi_assert(bands[k].hop % _hopMin == 0,
+                      "band hops must be multiples of the smallest one");
+
+        lookahead += ((int)((maxLen + bands[k].hop) * stretchmax) +
+                      pv_window_length(bands[k]))
+                     << k;
+    }
+
+    _bands.resize(numBands);
+    for (int k = 0; k < numBands; ++k) {
+        band_t &b = _bands[k];
+
+        b.owner = this;
+        b.index = k;
+        b.maxLen = _chunkMax >> k;
+        b.gl = pv_window_length(bands[k]);
+        b.config = bands[k];
+        b.pv = std::make_unique<pv_t>(stretchmax, Wmax, b.maxLen, bands[k]);
+        b.queue = std::make_unique<sample_queue_t>(
+            Wmax, ((lookahead + 2 * _chunkMax) >> k) + PYRAMID_TAPS);
+        b.ana = std::make_unique<double[]>(Wmax * b.maxLen);
+        b.syn = std::make_unique<double[]>(Wmax * b.maxLen);
+        b.tmp = std::make_unique<double[]>(b.maxLen);
+
+        if (k < numBands - 1) {
+            b.decim = std::make_unique<decimator_t>(Wmax, b.maxLen);
+            b.interpAna = std::make_unique<interpolator_t>(Wmax, b.maxLen / 2);
+            b.interpSyn = std::make_unique<interpolator_t>(Wmax, b.maxLen / 2);
+            b.delayIn = std::make_unique<delay_line_t>(Wmax, PYRAMID_DELAY,
+                                                       b.maxLen);
+            b.delayIn->set_delay(PYRAMID_DELAY);
+        }
+    }
+
+    // Delay lines long enough for any stretch up to the largest one the
+    // rounding of the hops can give
+    double smax = _hopMin / std::max(1.0, std::round(_hopMin / stretchmax));
+    std::vector<int> delays(2 * numBands);
+    std::vector<int> maxDelays(2 * numBands);
+
+    for (int ii = 0; ii <= DELAY_SEARCH_STEPS; ++ii) {
+        update_delays(smax * ii / DELAY_SEARCH_STEPS, delays.data());
+        for (int jj = 0; jj < 2 * numBands; ++jj) {
+            maxDelays[jj] = std::max(maxDelays[jj], delays[jj]);
+        }
+    }
+
+    for (int k = 0; k < numBands - 1; ++k) {
+        band_t &b = _bands[k];
+        int     margin = PYRAMID_TAPS;
+
+        b.delayBand = std::make_unique<delay_line_t>(
+            Wmax, maxDelays[2 * k] + margin, b.maxLen);
+        b.delayLow = std::make_unique<delay_line_t>(
+            Wmax, maxDelays[2 * k + 1] + margin, b.maxLen);
+    }
+
+    reset();
+}
+
+int pv_multiband_priv::get_numbands() const { return _bands.size(); }
+
+int pv_multiband_priv::get_latency() const {
+    return (int)std::round(_latency);
+}
+
+double pv_multiband_priv::get_fft_cost() const {
+    double cost = 0;
+
+    for (const band_t &b : _bands) {
+        cost += pv_config_fft_cost(b.config) / (1 << b.index);
+    }
+    return cost;
+}
+
+double pv_multiband_priv::update_delays(double s, int *delays) {
+    const double F = PYRAMID_DELAY;
+    const int    N = _bands.size();
+
+    // As pv_priv::get_latency(): causal bands output each frame at once
+    auto latency = [s](const band_t &b) {
+        int frameDelay = b.config.causal ? 0 : b.config.hop;
+        return frameDelay + b.gl / 2.0 * (1.0 - s);
+    };
+
+    // Output sample n of band k holds its input sample t at n = s t + E, in
+    // samples of band k. The residual path delays the input by F before
+    // the stretch, the lowpass path by F/2 before and F/2 after it; both
+    // are delayed to the later of the two.
+    double E = latency(_bands[N - 1]);
+
+    for (int k = N - 2; k >= 0; --k) {
+        band_t &b = _bands[k];
+        double  high = s * F + latency(b);
+        double  low = s * F / 2.0 + F / 2.0 + 2.0 * E;
+        double  T = std::max(high, low);
+        int     dBand = (int)std::round(T - high);
+        int     dLow = (int)std::round(T - low);
+
+        if (delays) {
+            delays[2 * k] = dBand;
+            delays[2 * k + 1] = dLow;
+        } else {
+            b.delayBand->set_delay(dBand);
+            b.delayLow->set_delay(dLow);
+        }
+        E = T;
+    }
+
+    return E;
+}
+
+void pv_multiband_priv::set_stretch(double stretch) {
+    // The hops of all the bands are multiples of _hopMin, rounding its
+    // analysis hop gives a stretch that all of them can use exactly
+    double s = _hopMin / std::max(1.0, std::round(_hopMin / stretch));
+
+    if (s != _stretch) {
+        _stretch = s;
+        _latency = update_delays(s, nullptr);
+        for (band_t &b : _bands) b.pv->set_stretch(s);
+    }
+}
+
+void pv_multiband_priv::set_flush_denormals(bool enable) {
+    _flushDenormals = enable;
+    for (band_t &b : _bands) b.pv->set_flush_denormals(enable);
+}
+
+bool pv_multiband_priv::get_flush_denormals() const {
+    return _flushDenormals;
+}
+
+void pv_multiband_priv::reset() {
+    for (band_t &b : _bands) {
+        b.pv->reset();
+        b.queue->reset();
+
+        if (b.decim) {
+            b.decim->reset();
+            b.interpAna->reset();
+            b.interpSyn->reset();
+            b.delayIn->reset();
+            b.delayBand->reset();
+            b.delayLow->reset();
+        }
+    }
+
+    _carryLen = 0;
+    _stretch = 0.0;
+    set_stretch(1.0);
+}
+
+int pv_multiband_priv::band_reader(void *userdata, double *buf[], int len,
+                                   int chan) {
+    band_t            *b = static_cast<band_t *>(userdata);
+    pv_multiband_priv *p = b->owner;
+
+    while (b->queue->get_available() < len) {
+        int needed = (len - b->queue->get_available()) << b->index;
+
+        needed = (needed + p->_grain - 1) / p->_grain * p->_grain;
+        p->analyse(std::min(needed, p->_chunkMax));
+    }
+
+    b->queue->read(buf, len, chan);
+    return len;
+}
+
+void pv_multiband_priv::analyse(int len) {
+    const int N = _bands.size();
+    band_t   &first = _bands[0];
+    int       got;
+
+    for (int w = 0; w < _chan; ++w) {
+        _anaPtrs[w] = first.ana.get() + w * first.maxLen;
+    }
+
+    got = std::clamp(_reader(_userdata, _anaPtrs.data(), len, _chan), 0, len);
+    for (int w = 0; w < _chan; ++w) {
+        std::fill(_anaPtrs[w] + got, _anaPtrs[w] + len, 0);
+    }
+    _pulled += len;
+
+    for (int k = 0; k < N; ++k) {
+        band_t &b = _bands[k];
+        int     n = len >> k;
+
+        if (k == N - 1) {
+            for (int w = 0; w < _chan; ++w) {
+                b.queue->write(w, b.ana.get() + w * b.maxLen, n);
+            }
+            b.queue->commit(n);
+            break;
+        }
+
+        band_t &next = _bands[k + 1];
+
+        // Residual: the input minus its lowpass part, with matching delays
+        for (int w = 0; w < _chan; ++w) {
+            double *x = b.ana.get() + w * b.maxLen;
+            double *d = next.ana.get() + w * next.maxLen;
+
+            b.decim->execute(w, x, n, d);
+            b.interpAna->execute(w, d, n / 2, b.tmp.get());
+            b.delayIn->execute(w, x, n);
+            for (int ii = 0; ii < n; ++ii) x[ii] -= b.tmp[ii];
+
+            b.queue->write(w, x, n);
+        }
+        b.delayIn->advance(n);
+        b.queue->commit(n);
+    }
+}
+
+void pv_multiband_priv::synthesise(int len) {
+    const int N = _bands.size();
+
+    for (int k = N - 1; k >= 0; --k) {
+        band_t &b = _bands[k];
+        int     n = len >> k;
+
+        for (int w = 0; w < _chan; ++w) {
+            _synPtrs[w] = b.syn.get() + w * b.maxLen;
+        }
+
+        b.pv->pull(_synPtrs.data(), n, _chan, _stretch, band_reader, &b);
+
+        if (k == N - 1) continue;
+
+        band_t &next = _bands[k + 1];
+
+        for (int w = 0; w < _chan; ++w) {
+            double *y = b.syn.get() + w * b.maxLen;
+
+            b.delayBand->execute(w, y, n);
+            b.interpSyn->execute(w, next.syn.get() + w * next.maxLen, n / 2,
+                                 b.tmp.get());
+            b.delayLow->execute(w, b.tmp.get(), n);
+            for (int ii = 0; ii < n; ++ii) y[ii] += b.tmp[ii];
+        }
+        b.delayBand->advance(n);
+        b.delayLow->advance(n);
+    }
+}
+
+int pv_multiband_priv::pull(double *out[], int Lout, int chan, double stretch,
+                            pv_reader_t *reader, void *userdata) {
+    denormal_scope_t fpscope(_flushDenormals);
+    band_t          &first = _bands[0];
+    int              done;
+
+    rtpghi_assert(Lout >= 0, "Lout must be nonnegative");
+    rtpghi_assert(chan >= 0, "chan must be nonnegative");
+
+    if (chan == 0 || Lout == 0) return 0;
+
+    for (int w = _Wmax; w < chan; ++w) std::fill(out[w], out[w] + Lout, 0);
+    chan = std::min(chan, _Wmax);
+
+    set_stretch(stretch);
+
+    _reader = reader;
+    _userdata = userdata;
+    _chan = chan;
+    _pulled = 0;
+
+    // Left over from the last block of the previous call
+    done = std::min(_carryLen, Lout);
+    for (int w = 0; w < chan; ++w) {
+        double *carry = _carry.get() + w * _grain;
+
+        std::copy(carry, carry + done, out[w]);
+        std::copy(carry + done, carry + _carryLen, carry);
+    }
+    _carryLen -= done;
+
+    while (done < Lout) {
+        int len = (Lout - done + _grain - 1) / _grain * _grain;
+        int n;
+
+        len = std::min(len, _chunkMax);
+        n = std::min(len, Lout - done);
+
+        synthesise(len);
+
+        for (int w = 0; w < chan; ++w) {
+            const double *y = first.syn.get() + w * first.maxLen;
+
+            std::copy(y, y + n, out[w] + done);
+            std::copy(y + n, y + len, _carry.get() + w * _grain);
+        }
+        _carryLen = len - n;
+        done += n;
+    }
+
+    _reader = nullptr;
+    _userdata = nullptr;
+
+    return _pulled;
+}
@@ -0,0 +1,89 @@
+#ifndef PV_MULTIBAND_P_H__
+#define PV_MULTIBAND_P_H__
+
+#include <memory>
+#include <vector>
+
+#include "pv.h"
+#include "pv_multiband.h"
+#include "pyramid.h"
+
+class pv_multiband_priv final {
+   public:
+    pv_multiband_priv(double stretchmax, int Wmax, int bufLenMax,
+                      const pv_config_t bands[], int numBands);
+
+    int get_numbands() const;
+
+    int get_latency() const;
+
+    double get_fft_cost() const;
+
+    void set_stretch(double stretch);
+
+    void set_flush_denormals(bool enable);
+
+    bool get_flush_denormals() const;
+
+    void reset();
+
+    int pull(double* out[], int Lout, int chan, double stretch,
+             pv_reader_t* reader, void* userdata);
+
+   private:
+    /**
+     * One level of the pyramid, at 1/2^index of the input rate. All but the
+     * last band have the splitting filters; the last one is only fed the
+     * decimated signal.
+     */
+    struct band_t {
+        pv_multiband_priv*              owner;
+        int                             index;
+        int                             maxLen;    //!< Largest block
+        int                             gl;        //!< Window length
+        pv_config_t                     config;
+        std::unique_ptr<pv_t>           pv;
+        std::unique_ptr<sample_queue_t> queue;     //!< Input of pv
+        std::unique_ptr<decimator_t>    decim;     //!< To the next band
+        std::unique_ptr<interpolator_t> interpAna; //!< Lowpass to remove
+        std::unique_ptr<delay_line_t>   delayIn;   //!< Input, aligned with it
+        std::unique_ptr<interpolator_t> interpSyn; //!< Next band output
+        std::unique_ptr<delay_line_t>   delayBand; //!< pv output
+        std::unique_ptr<delay_line_t>   delayLow;  //!< interpSyn output
+        std::unique_ptr<double[]>       ana;       //!< Band input, W blocks
+        std::unique_ptr<double[]>       syn;       //!< Band output, W blocks
+        std::unique_ptr<double[]>       tmp;       //!< One block
+    };
+
+    static int band_reader(void* userdata, double* buf[], int len, int chan);
+
+    /** Pull len input samples and split them into the band queues */
+    void analyse(int len);
+
+    /** Produce len output samples in the syn blocks of band 0 */
+    void synthesise(int len);
+
+    /** Band delays at stretch s, returns the total latency */
+    double update_delays(double s, int* delays);
+
+    std::vector<band_t>       _bands;
+    std::unique_ptr<double[]> _carry;      //!< Output past the last Lout
+    std::vector<double*>      _anaPtrs;    //!< Channels of analyse()
+    std::vector<double*>      _synPtrs;    //!< Channels of synthesise()
+    int                       _carryLen;
+    int                       _grain;      //!< Block multiple, 2^(bands-1)
+    int                       _chunkMax;   //!< Largest block at input rate
+    int                       _hopMin;     //!< Smallest band hop
+    int                       _Wmax;
+    double                    _stretch;    //!< Same for all the bands
+    double                    _latency;
+    bool                      _flushDenormals;
+
+    // Valid during pull()
+    pv_reader_t* _reader;
+    void*        _userdata;
+    int          _chan;
+    int          _pulled;
+};
+
+#endif  // PV_MULTIBAND_P_H__
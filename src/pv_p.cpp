@@ -3,20 +3,36 @@
 #include <limits>
 
 #include "firwin.h"
+#include "fpenv.h"
 #include "pv.h"
 
+/** Start of a snapshot, to catch loading one of another configuration */
+struct pv_state_header_t {
+    uint32_t magic;
+    uint32_t size;
+};
+
+#define PV_STATE_MAGIC 0x54535650  // "PVST"
+
 void rtpghi_processor_callback(void *userdata, const std::complex<double> *in,
                                int M2, int W, std::complex<double> *out) {
     (void)M2;
     (void)W;
-    auto state = static_cast<pv_priv *>(userdata);
-    state->_rtpghi->execute(in, state->_stretch, out);
+    static_cast<pv_priv *>(userdata)->reconstruct_phase(in, out);
+}
+
+int pv_window_length(const pv_config_t &config) {
+    if (config.gaussThr > 0.0) {
+        return mtgausslength(config.hop, config.fftLen, config.gaussThr);
+    }
+    return config.winLen;
 }
 
-pv_priv::pv_priv(double stretchmax, int Wmax, int bufLenMax) {
-    int asyn = 1024;
-    int M = 8192;
-    int gl = 4096;
+pv_priv::pv_priv(double stretchmax, int Wmax, int bufLenMax,
+                 const pv_config_t &config) {
+    int asyn = config.hop;
+    int M = config.fftLen;
+    int gl = pv_window_length(config);
     int fifoSize = (bufLenMax + asyn) * stretchmax;
 
     _procdelay = gl < fifoSize ? fifoSize : gl;
@@ -27,11 +43,23 @@ pv_priv::pv_priv(double stretchmax, int Wmax, int bufLenMax) {
     _out_in_in_offset = 0.0;
 
     _asyn = asyn;
+    _gl = gl;
+    _stretch = 0.0;
+    _flushDenormals = false;
 
-    _proc = std::make_unique<rtdgtreal_processor_t>(FIRWIN_HANN, gl, asyn, M,
-                                                    Wmax, fifoSize, _procdelay);
+    if (config.gaussThr > 0.0) {
+        auto g = std::make_unique<double[]>(gl);
+        mtgauss(asyn, M, config.gaussThr, g.get());
+        _proc = std::make_unique<rtdgtreal_processor_t>(
+            g.get(), gl, asyn, M, Wmax, fifoSize, _procdelay);
+    } else {
+        _proc = std::make_unique<rtdgtreal_processor_t>(
+            config.window, gl, asyn, M, Wmax, fifoSize, _procdelay);
+    }
 
-    _rtpghi = std::make_unique<rtpghi_t>(Wmax, asyn, M, 1e-6);
+    _rtpghi = std::make_unique<rtpghi_t>(Wmax, asyn, M, config.tol);
+    _rtpghi->set_causal(config.causal);
+    _rtpghi->set_fractional_hop(config.fractionalHop);
 
     _proc->set_callback(rtpghi_processor_callback, this);
 
@@ -40,6 +68,15 @@ pv_priv::pv_priv(double stretchmax, int Wmax, int bufLenMax) {
 
 int pv_priv::get_procdelay() const { return _procdelay; }
 
+int pv_priv::get_latency() const {
+    // Frames are gl long and start at multiples of the hops on both sides,
+    // and RTPGHI outputs the previous frame, one synthesis hop late, unless
+    // it is causal.
+    int frameDelay = _rtpghi->get_causal() ? 0 : _asyn;
+
+    return (int)std::round(frameDelay + _gl / 2.0 * (1.0 - _stretch));
+}
+
 void pv_priv::print_pos() const {
     printf(
         "in_pos: %zu, out_pos: %zu, in_out_offset: %.3f, out_in_offset: %.3f, "
@@ -57,7 +94,6 @@ size_t pv_priv::next_outlen(size_t Lin) const {
     double stretch = _rtpghi->get_stretch();
     size_t out_pos_end =
         (size_t)std::round((double)Lin * stretch + _in_in_out_offset);
-    printf("stretch:%f, in_in_out_offset:%f\n", stretch, _in_in_out_offset);
     return out_pos_end;
 }
 
@@ -74,9 +110,25 @@ void pv_priv::advance_by(size_t Lin, size_t Lout) {
     _out_in_in_offset -= Lin;
 }
 
+void pv_priv::reset() {
+    _proc->reset();
+    _rtpghi->reset(nullptr);
+
+    _in_pos = 0;
+    _out_pos = 0;
+    _in_in_out_offset = 0.0;
+    _out_in_in_offset = 0.0;
+
+    _stretch = 0.0;
+    set_stretch(1.0);
+}
+
 void pv_priv::set_stretch(double stretch) {
-    int    newaana = std::round(_asyn / stretch);
-    double truestretch = ((double)_asyn) / newaana;
+    double newaana = _asyn / stretch;
+
+    if (!_rtpghi->get_fractional_hop()) newaana = std::round(newaana);
+
+    double truestretch = _asyn / newaana;
 
     if (fabs(truestretch - _stretch) > std::numeric_limits<double>::epsilon()) {
         _aana = newaana;
@@ -85,16 +137,174 @@ void pv_priv::set_stretch(double stretch) {
     }
 }
 
-void pv_priv::execute(const double *in[], int Lin, int chan, double stretch,
-                      int Lout, double *out[]) {
+void pv_priv::set_flush_denormals(bool enable) { _flushDenormals = enable; }
+
+bool pv_priv::get_flush_denormals() const { return _flushDenormals; }
+
+void pv_priv::set_pipeline_stages(int stages) {
+    _proc->set_pipeline_stages(stages);
+}
+
+int pv_priv::get_pipeline_stages() const {
+    return _proc->get_pipeline_stages();
+}
+
+void pv_priv::set_batch_frames(int frames) { _proc->set_batch_frames(frames); }
+
+int pv_priv::get_batch_frames() const { return _proc->get_batch_frames(); }
+
+void pv_priv::set_channel_link(rtpghi_link_t link) {
+    _rtpghi->set_channel_link(link);
+}
+
+rtpghi_link_t pv_priv::get_channel_link() const {
+    return _rtpghi->get_channel_link();
+}
+
+void pv_priv::set_dither(bool enable) { _proc->set_dither(enable); }
+
+bool pv_priv::get_dither() const { return _proc->get_dither(); }
+
+void pv_priv::set_frame_callback(rtdgtreal_processor_callback *callback,
+                                 void                         *userdata) {
+    if (callback) {
+        _proc->set_callback(callback, userdata);
+    } else {
+        _proc->set_callback(rtpghi_processor_callback, this);
+    }
+}
+
+void pv_priv::reconstruct_phase(const std::complex<double> *in,
+                                std::complex<double>       *out) {
+    _rtpghi->execute(in, _stretch, out);
+}
+
+int pv_priv::execute(const double *in[], int Lin, int chan, double stretch,
+                     int Lout, double *out[]) {
+    denormal_scope_t fpscope(_flushDenormals);
+
     advance_by(Lin, Lout);
     set_stretch(stretch);
-    _proc->execute_gen(in, Lin, chan, Lout, out);
+    return _proc->execute_gen(in, Lin, chan, Lout, out);
 }
 
-void pv_priv::execute_compact(const double *in, int Lin, int chan,
-                              double stretch, int Lout, double *out) {
+int pv_priv::execute_compact(const double *in, int Lin, int chan,
+                             double stretch, int Lout, double *out) {
+    denormal_scope_t fpscope(_flushDenormals);
+
     advance_by(Lin, Lout);
     set_stretch(stretch);
-    _proc->execute_gen_compact(in, Lin, chan, Lout, out);
-}
\ No newline at end of file
+    return _proc->execute_gen_compact(in, Lin, chan, Lout, out);
+}
+
+int pv_priv::execute_interleaved(const void *in, pcm_format_t fmt, int Lin,
+                                 int chan, double stretch, int Lout,
+                                 double *out[]) {
+    denormal_scope_t fpscope(_flushDenormals);
+
+    advance_by(Lin, Lout);
+    set_stretch(stretch);
+    return _proc->execute_gen_interleaved(in, fmt, Lin, chan, Lout, out);
+}
+
+int pv_priv::execute_pcm(const void *const in[], pcm_format_t fmt, int Lin,
+                         int chan, double stretch, int Lout,
+                         void *const out[]) {
+    denormal_scope_t fpscope(_flushDenormals);
+
+    advance_by(Lin, Lout);
+    set_stretch(stretch);
+    return _proc->execute_gen_pcm(in, fmt, Lin, chan, Lout, out);
+}
+
+int pv_priv::pull(double *out[], int Lout, int chan, double stretch,
+                  pv_reader_t *reader, void *userdata) {
+    denormal_scope_t fpscope(_flushDenormals);
+    int              Lin;
+
+    set_stretch(stretch);
+    _proc->execute_pull(reader, userdata, chan, Lout, out, &Lin);
+    advance_by(Lin, Lout);
+    return Lin;
+}
+
+int pv_priv::get_seek_preroll(double stretch) const {
+    // The first frame that reaches the target in the output starts about
+    // gl/2 + gl/2 / stretch before it, and has two frames before it for
+    // the time gradient, plus one hop of margin.
+    return (int)std::ceil(_gl / 2.0 + (_gl / 2.0 + 3 * _asyn) / stretch);
+}
+
+int pv_priv::seek(pv_reader_t *reader, void *userdata, int chan,
+                  double stretch) {
+    denormal_scope_t fpscope(_flushDenormals);
+    int              preroll = get_seek_preroll(stretch);
+    int              Lin;
+
+    reset();
+    set_stretch(stretch);
+
+    // Output sample latency + n * stretch is input sample n
+    int Lout = (int)std::round(get_latency() + preroll * _stretch);
+
+    rtpghi_assert(Lout >= 0, "preroll shorter than the latency");
+
+    _proc->execute_discard(reader, userdata, chan, Lout, &Lin);
+    advance_by(Lin, Lout);
+    return Lin;
+}
+
+void pv_priv::transfer_state(state_io_t *io) {
+    io->io(&_stretch);
+    io->io(&_aana);
+    io->io(&_in_pos);
+    io->io(&_out_pos);
+    io->io(&_in_in_out_offset);
+    io->io(&_out_in_in_offset);
+
+    // The processor and RTPGHI have their own snapshots
+    switch (io->get_mode()) {
+        case state_io_t::STATE_SAVE:
+            _proc->save_state(io->cur());
+            io->skip(_proc->get_state_size());
+            _rtpghi->save_state(io->cur());
+            break;
+        case state_io_t::STATE_LOAD:
+            _proc->load_state(io->cur());
+            io->skip(_proc->get_state_size());
+            _rtpghi->load_state(io->cur());
+            break;
+        case state_io_t::STATE_SIZE:
+            io->skip(_proc->get_state_size());
+            break;
+    }
+    io->skip(_rtpghi->get_state_size());
+}
+
+size_t pv_priv::get_state_size() {
+    state_io_t io(state_io_t::STATE_SIZE, nullptr);
+
+    transfer_state(&io);
+    return sizeof(pv_state_header_t) + io.get_len();
+}
+
+void pv_priv::save_state(void *buf) {
+    pv_state_header_t header = {PV_STATE_MAGIC, (uint32_t)get_state_size()};
+    state_io_t        io(state_io_t::STATE_SAVE, buf);
+
+    io.io(&header);
+    transfer_state(&io);
+}
+
+bool pv_priv::load_state(const void *buf) {
+    pv_state_header_t header;
+    state_io_t        io(state_io_t::STATE_LOAD, const_cast<void *>(buf));
+
+    // Before any state is touched, also without assertions
+    io.io(&header);
+    if (header.magic != PV_STATE_MAGIC || header.size != get_state_size()) {
+        return false;
+    }
+    transfer_state(&io);
+    return true;
+}
@@ -3,15 +3,25 @@
 
 #include <memory>
 
+#include "pv.h"
 #include "rtdgtrealproc.h"
 #include "rtpghi.h"
+#include "statebuf.h"
+
+/**
+ * Window length of a configuration, winLen or that of the Gaussian.
+ */
+int pv_window_length(const pv_config_t& config);
 
 class pv_priv final {
    public:
-    pv_priv(double stretchmax, int Wmax, int bufLenMax);
+    pv_priv(double stretchmax, int Wmax, int bufLenMax,
+            const pv_config_t& config);
 
     int get_procdelay() const;
 
+    int get_latency() const;
+
     void print_pos() const;
 
     size_t next_inlen(size_t Lout) const;
@@ -22,13 +32,62 @@ class pv_priv final {
 
     void set_stretch(double stretch);
 
-    void execute(const double* in[], int Lin, int chan, double stretch,
-                 int Lout, double* out[]);
+    void set_flush_denormals(bool enable);
+
+    bool get_flush_denormals() const;
+
+    void set_pipeline_stages(int stages);
+
+    int get_pipeline_stages() const;
+
+    void set_batch_frames(int frames);
+
+    int get_batch_frames() const;
+
+    void set_channel_link(rtpghi_link_t link);
+
+    rtpghi_link_t get_channel_link() const;
+
+    void set_dither(bool enable);
+
+    bool get_dither() const;
+
+    void set_frame_callback(rtdgtreal_processor_callback* callback,
+                            void*                         userdata);
 
-    void execute_compact(const double* in, int Lin, int chan, double stretch,
-                         int Lout, double* out);
+    void reconstruct_phase(const std::complex<double>* in,
+                           std::complex<double>*       out);
+
+    void reset();
+
+    int execute(const double* in[], int Lin, int chan, double stretch,
+                int Lout, double* out[]);
+
+    int execute_compact(const double* in, int Lin, int chan, double stretch,
+                        int Lout, double* out);
+
+    int execute_interleaved(const void* in, pcm_format_t fmt, int Lin,
+                            int chan, double stretch, int Lout, double* out[]);
+
+    int execute_pcm(const void* const in[], pcm_format_t fmt, int Lin,
+                    int chan, double stretch, int Lout, void* const out[]);
+
+    int pull(double* out[], int Lout, int chan, double stretch,
+             pv_reader_t* reader, void* userdata);
+
+    int get_seek_preroll(double stretch) const;
+
+    int seek(pv_reader_t* reader, void* userdata, int chan, double stretch);
+
+    size_t get_state_size();
+
+    void save_state(void* buf);
+
+    bool load_state(const void* buf);
 
    private:
+    void transfer_state(state_io_t* io);
+
     std::unique_ptr<rtdgtreal_processor_t> _proc;
     std::unique_ptr<rtpghi_t>              _rtpghi;
     double                                 _stretch;
@@ -37,8 +96,10 @@ class pv_priv final {
     size_t                                 _out_pos;
     double                                 _in_in_out_offset;
     double                                 _out_in_in_offset;
-    int                                    _aana;
+    double                                 _aana;
     int                                    _asyn;
+    int                                    _gl;
+    bool                                   _flushDenormals;
 
     friend void rtpghi_processor_callback(void*                       userdata,
                                           const std::complex<double>* in,
@@ -0,0 +1,20 @@
+#include "pv_pool.h"
+
+#include "pv_pool_p.h"
+
+pv_pool_t::pv_pool_t(double stretchmax, int Wmax, int buflenMax,
+                     const pv_config_t& config, int count) {
+    _p = new pv_pool_priv(stretchmax, Wmax, buflenMax, config, count);
+}
+
+pv_pool_t::~pv_pool_t() { delete _p; }
+
+void pv_pool_t::reserve(int count) { _p->reserve(count); }
+
+pv_t* pv_pool_t::acquire() { return _p->acquire(); }
+
+void pv_pool_t::release(pv_t* pv) { _p->release(pv); }
+
+int pv_pool_t::get_size() const { return _p->get_size(); }
+
+int pv_pool_t::get_free() const { return _p->get_free(); }
@@ -0,0 +1,98 @@
+#include "pv_pool_p.h"
+
+#include "pv_p.h"
+#include "rtpghi.h"
+
+pv_pool_priv::pv_pool_priv(double stretchmax, int Wmax, int bufLenMax,
+                           const pv_config_t& config, int count) {
+    rtpghi_assert(Wmax > 0, "Wmax must be positive");
+    rtpghi_assert(bufLenMax > 0, "bufLenMax must be positive");
+    rtpghi_assert(count >= 0, "count must be non-negative");
+
+    _stretchmax = stretchmax;
+    _Wmax = Wmax;
+    _bufLenMax = bufLenMax;
+    _config = config;
+
+    reserve(count);
+}
+
+static int silence_reader(void*, double*[], int, int) { return 0; }
+
+std::unique_ptr<pv_t> pv_pool_priv::make_instance() const {
+    auto pv = std::make_unique<pv_t>(_stretchmax, _Wmax, _bufLenMax, _config);
+
+    std::vector<double>  buf(_Wmax * _bufLenMax);
+    std::vector<double*> out(_Wmax);
+
+    long warmLen = pv->get_procdelay() + pv_window_length(_config);
+
+    for (int w = 0; w < _Wmax; ++w) out[w] = &buf[w * _bufLenMax];
+
+    // Pull silence through the whole analysis FIFO, which touches the
+    // pages of every buffer and runs the FFTs once
+    for (long n = 0; n < warmLen;) {
+        n += pv->pull(out.data(), _bufLenMax, _Wmax, 1.0, silence_reader,
+                      nullptr);
+    }
+
+    pv->reset();
+    return pv;
+}
+
+void pv_pool_priv::add(std::unique_ptr<pv_t> pv, bool free) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // release() never grows _free
+    _free.reserve(_all.size() + 1);
+    if (free) _free.push_back(pv.get());
+    _all.push_back(std::move(pv));
+}
+
+void pv_pool_priv::reserve(int count) {
+    while (get_size() < count) add(make_instance(), true);
+}
+
+pv_t* pv_pool_priv::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!_free.empty()) {
+            pv_t* pv = _free.back();
+            _free.pop_back();
+            return pv;
+        }
+    }
+
+    std::unique_ptr<pv_t> pv = make_instance();
+    pv_t*                 ptr = pv.get();
+
+    add(std::move(pv), false);
+    return ptr;
+}
+
+void pv_pool_priv::release(pv_t* pv) {
+    // Back to the settings of a new instance
+    pv->set_flush_denormals(false);
+    pv->set_pipeline_stages(1);
+    pv->set_batch_frames(1);
+    pv->set_channel_link(RTPGHI_LINK_NONE);
+    pv->set_frame_callback(nullptr, nullptr);
+    pv->set_dither(true);
+    pv->reset();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    rtpghi_assert(_free.size() < _all.size(), "pv released twice");
+    _free.push_back(pv);
+}
+
+int pv_pool_priv::get_size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _all.size();
+}
+
+int pv_pool_priv::get_free() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _free.size();
+}
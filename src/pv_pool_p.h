@@ -0,0 +1,43 @@
+#ifndef PV_POOL_P_H__
+#define PV_POOL_P_H__
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "pv.h"
+#include "pv_pool.h"
+
+class pv_pool_priv final {
+   public:
+    pv_pool_priv(double stretchmax, int Wmax, int bufLenMax,
+                 const pv_config_t& config, int count);
+
+    void reserve(int count);
+
+    pv_t* acquire();
+
+    void release(pv_t* pv);
+
+    int get_size() const;
+
+    int get_free() const;
+
+   private:
+    /** Construct an instance and run it on silence */
+    std::unique_ptr<pv_t> make_instance() const;
+
+    /** Add an instance, free if free is set */
+    void add(std::unique_ptr<pv_t> pv, bool free);
+
+    double      _stretchmax;
+    int         _Wmax;
+    int         _bufLenMax;
+    pv_config_t _config;
+
+    mutable std::mutex                 _mutex;
+    std::vector<std::unique_ptr<pv_t>> _all;   //!< All instances
+    std::vector<pv_t*>                 _free;  //!< Capacity of _all.size()
+};
+
+#endif  // PV_POOL_P_H__
@@ -0,0 +1,206 @@
+#define _USE_MATH_DEFINES
+#include "pyramid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "rtpghi.h"
+
+/** History kept by interpolator_t, one more than its polyphase length */
+#define INTERP_HIST ((PYRAMID_TAPS + 1) / 2)
+
+/**
+ * Blackman windowed sinc, cut off at 0.2, unit DC gain.
+ */
+static const double *pyramid_lowpass() {
+    static const struct lowpass_t {
+        double h[PYRAMID_TAPS];
+
+        lowpass_t() {
+            const double fc = 0.2;
+            const int    half = PYRAMID_TAPS / 2;
+            double       sum = 0;
+
+            for (int ii = 0; ii < PYRAMID_TAPS; ++ii) {
+                double t = ii - half;
+                double x = 2.0 * M_PI * ii / (PYRAMID_TAPS - 1);
+                double w = 0.42 - 0.5 * cos(x) + 0.08 * cos(2.0 * x);
+                double s = t == 0 ? 2.0 * fc
+                                  : sin(2.0 * M_PI * fc * t) / (M_PI * t);
+
+                h[ii] = s * w;
+                sum += h[ii];
+            }
+            for (double &v : h) v /= sum;
+        }
+    } lp;
+
+    return lp.h;
+}
+
+decimator_t::decimator_t(int numChans, int maxLen) {
+    rtpghi_assert(numChans > 0, "numChans must be positive");
+    rtpghi_assert(maxLen > 0, "maxLen must be positive");
+
+    _stride = PYRAMID_TAPS - 1 + maxLen;
+    _numChans = numChans;
+    _buf = std::make_unique<double[]>(numChans * _stride);
+    pyramid_lowpass();
+}
+
+void decimator_t::reset() {
+    std::fill_n(_buf.get(), _numChans * _stride, 0);
+}
+
+void decimator_t::execute(int w, const double *in, int len, double *out) {
+    const double *h = pyramid_lowpass();
+    double       *b = _buf.get() + w * _stride;
+    const double *x = b + PYRAMID_TAPS - 1;
+
+    rtpghi_assert(len % 2 == 0, "len must be even");
+
+    std::copy(in, in + len, b + PYRAMID_TAPS - 1);
+
+    // Keep the even samples, x[-1] ... x[-(PYRAMID_TAPS-1)] is the history
+    for (int j = 0; j < len / 2; ++j) {
+        double acc = 0;
+        for (int ii = 0; ii < PYRAMID_TAPS; ++ii) acc += h[ii] * x[2 * j - ii];
+        out[j] = acc;
+    }
+
+    std::memmove(b, b + len, (PYRAMID_TAPS - 1) * sizeof(double));
+}
+
+interpolator_t::interpolator_t(int numChans, int maxLen) {
+    rtpghi_assert(numChans > 0, "numChans must be positive");
+    rtpghi_assert(maxLen > 0, "maxLen must be positive");
+
+    _stride = INTERP_HIST + maxLen;
+    _numChans = numChans;
+    _buf = std::make_unique<double[]>(numChans * _stride);
+    pyramid_lowpass();
+}
+
+void interpolator_t::reset() {
+    std::fill_n(_buf.get(), _numChans * _stride, 0);
+}
+
+void interpolator_t::execute(int w, const double *in, int len, double *out) {
+    const double *h = pyramid_lowpass();
+    double       *b = _buf.get() + w * _stride;
+    const double *u = b + INTERP_HIST;
+
+    std::copy(in, in + len, b + INTERP_HIST);
+
+    // Filtering the input with zeros inserted, the even taps give the even
+    // output samples and the odd taps the odd ones. Gain 2 makes up for the
+    // zeros.
+    for (int j = 0; j < len; ++j) {
+        double even = 0;
+        double odd = 0;
+        for (int q = 0; 2 * q < PYRAMID_TAPS; ++q) {
+            even += h[2 * q] * u[j - q];
+        }
+        for (int q = 0; 2 * q + 1 < PYRAMID_TAPS; ++q) {
+            odd += h[2 * q + 1] * u[j - q];
+        }
+        out[2 * j] = 2.0 * even;
+        out[2 * j + 1] = 2.0 * odd;
+    }
+
+    std::memmove(b, b + len, INTERP_HIST * sizeof(double));
+}
+
+delay_line_t::delay_line_t(int numChans, int maxDelay, int maxLen) {
+    rtpghi_assert(numChans > 0, "numChans must be positive");
+    rtpghi_assert(maxDelay >= 0, "maxDelay must be nonnegative");
+    rtpghi_assert(maxLen > 0, "maxLen must be positive");
+
+    _bufLen = maxDelay + maxLen;
+    _numChans = numChans;
+    _maxDelay = maxDelay;
+    _buf = std::make_unique<double[]>(numChans * _bufLen);
+    _delay = 0;
+
+    reset();
+}
+
+void delay_line_t::reset() {
+    std::fill_n(_buf.get(), _numChans * _bufLen, 0);
+    _writeIdx = 0;
+}
+
+void delay_line_t::set_delay(int delay) {
+    rtpghi_assert(delay >= 0 && delay <= _maxDelay,
+                  "delay must be in [0,maxDelay]");
+    _delay = std::clamp(delay, 0, _maxDelay);
+}
+
+int delay_line_t::get_delay() const { return _delay; }
+
+void delay_line_t::execute(int w, double *inout, int len) {
+    double *b = _buf.get() + w * _bufLen;
+    int     writeIdx = _writeIdx;
+    int     readIdx = _writeIdx - _delay;
+
+    if (readIdx < 0) readIdx += _bufLen;
+
+    // Write before reading, a delay shorter than len reads this call's input
+    for (int ii = 0; ii < len; ++ii) {
+        b[writeIdx] = inout[ii];
+        inout[ii] = b[readIdx];
+        if (++writeIdx == _bufLen) writeIdx = 0;
+        if (++readIdx == _bufLen) readIdx = 0;
+    }
+}
+
+void delay_line_t::advance(int len) {
+    _writeIdx = (_writeIdx + len) % _bufLen;
+}
+
+sample_queue_t::sample_queue_t(int numChans, int capacity) {
+    rtpghi_assert(numChans > 0, "numChans must be positive");
+    rtpghi_assert(capacity > 0, "capacity must be positive");
+
+    _bufLen = capacity;
+    _numChans = numChans;
+    _buf = std::make_unique<double[]>(numChans * _bufLen);
+
+    reset();
+}
+
+void sample_queue_t::reset() {
+    _readIdx = 0;
+    _available = 0;
+}
+
+int sample_queue_t::get_available() const { return _available; }
+
+void sample_queue_t::write(int w, const double *in, int len) {
+    double *b = _buf.get() + w * _bufLen;
+    int     writeIdx = (_readIdx + _available) % _bufLen;
+    int     valid = std::min(len, _bufLen - writeIdx);
+
+    rtpghi_assert(_available + len <= _bufLen, "sample queue overflow");
+
+    std::copy(in, in + valid, b + writeIdx);
+    std::copy(in + valid, in + len, b);
+}
+
+void sample_queue_t::commit(int len) { _available += len; }
+
+void sample_queue_t::read(double *out[], int len, int W) {
+    int valid = std::min(len, _bufLen - _readIdx);
+
+    rtpghi_assert(len <= _available, "not enough samples in the queue");
+
+    for (int w = 0; w < W; ++w) {
+        const double *b = _buf.get() + w * _bufLen;
+        std::copy(b + _readIdx, b + _readIdx + valid, out[w]);
+        std::copy(b, b + len - valid, out[w] + valid);
+    }
+
+    _readIdx = (_readIdx + len) % _bufLen;
+    _available -= len;
+}
@@ -0,0 +1,153 @@
+#ifndef PYRAMID_H__
+#define PYRAMID_H__
+
+#include <memory>
+
+/**
+ * Building blocks of the octave pyramid of pv_multiband_t.
+ *
+ * Decimating a signal x by two and interpolating it back gives its lowpass
+ * part, delayed by PYRAMID_DELAY samples; x delayed by as much minus that
+ * is the highpass residual. Summing the two gives back x exactly, whatever
+ * the filter, which is what makes the band split perfectly reconstructing.
+ *
+ * All lengths are per channel, the channels are processed independently.
+ */
+
+/** Length of the pyramid lowpass, odd for an integer delay */
+#define PYRAMID_TAPS 63
+
+/** Delay of decimation followed by interpolation */
+#define PYRAMID_DELAY (PYRAMID_TAPS - 1)
+
+/**
+ * Decimation by two with the pyramid lowpass, which is cut off at 0.2 times
+ * the input rate, so that the aliasing stays above the band that is kept.
+ */
+class decimator_t final {
+   public:
+    /**
+     * \param[in]  numChans  Number of channels
+     * \param[in]  maxLen    Largest input length
+     */
+    decimator_t(int numChans, int maxLen);
+
+    void reset();
+
+    /**
+     * \param[in]   w    Channel
+     * \param[in]   in   Input, len samples, len even
+     * \param[in]   len  Input length
+     * \param[out]  out  Output, len / 2 samples
+     */
+    void execute(int w, const double *in, int len, double *out);
+
+   private:
+    std::unique_ptr<double[]> _buf;  //!< History followed by the input
+    int                       _stride;
+    int                       _numChans;
+};
+
+/**
+ * Interpolation by two with the pyramid lowpass.
+ */
+class interpolator_t final {
+   public:
+    /**
+     * \param[in]  numChans  Number of channels
+     * \param[in]  maxLen    Largest input length
+     */
+    interpolator_t(int numChans, int maxLen);
+
+    void reset();
+
+    /**
+     * \param[in]   w    Channel
+     * \param[in]   in   Input, len samples
+     * \param[in]   len  Input length
+     * \param[out]  out  Output, 2 * len samples
+     */
+    void execute(int w, const double *in, int len, double *out);
+
+   private:
+    std::unique_ptr<double[]> _buf;  //!< History followed by the input
+    int                       _stride;
+    int                       _numChans;
+};
+
+/**
+ * Integer delay, adjustable up to a maximum.
+ */
+class delay_line_t final {
+   public:
+    /**
+     * \param[in]  numChans  Number of channels
+     * \param[in]  maxDelay  Largest delay
+     * \param[in]  maxLen    Largest length of execute()
+     */
+    delay_line_t(int numChans, int maxDelay, int maxLen);
+
+    void reset();
+
+    /**
+     * Change the delay. The samples already in the line are kept, so the
+     * output jumps by the difference.
+     */
+    void set_delay(int delay);
+
+    int get_delay() const;
+
+    /**
+     * Delay one channel. execute() must be called for all the channels
+     * with the same len before advance().
+     *
+     * \param[in]      w      Channel
+     * \param[in,out]  inout  Samples, len
+     * \param[in]      len    Length
+     */
+    void execute(int w, double *inout, int len);
+
+    /** Move past the len samples of the channels */
+    void advance(int len);
+
+   private:
+    std::unique_ptr<double[]> _buf;
+    int                       _bufLen;
+    int                       _numChans;
+    int                       _maxDelay;
+    int                       _writeIdx;
+    int                       _delay;
+};
+
+/**
+ * FIFO of multichannel samples.
+ */
+class sample_queue_t final {
+   public:
+    sample_queue_t(int numChans, int capacity);
+
+    void reset();
+
+    int get_available() const;
+
+    /**
+     * Append len samples of one channel. write() must be called for all the
+     * channels with the same len before commit().
+     */
+    void write(int w, const double *in, int len);
+
+    /** Make the len samples written last available */
+    void commit(int len);
+
+    /** Remove len samples of W channels, len at most get_available() */
+    void read(double *out[], int len, int W);
+
+   private:
+    std::unique_ptr<double[]> _buf;
+    int                       _bufLen;
+    int                       _numChans;
+    int                       _readIdx;
+    int                       _available;
+};
+
+#endif  // PYRAMID_H__
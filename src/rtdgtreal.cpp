@@ -13,6 +13,18 @@ void rtdgtreal_t::execute(const double *f, int W, std::complex<double> *c) {
     _p->execute_fwd(f, W, c);
 }
 
+void rtdgtreal_t::execute(const double *f, int fstride, int W,
+                          std::complex<double> *c) {
+    _p->execute_fwd(f, fstride, W, c);
+}
+
+void rtdgtreal_t::set_batch_len(int len) { _p->set_batch_len(len); }
+
+void rtdgtreal_t::execute_batch(const double *const f[], int fstride, int K,
+                                int W, std::complex<double> *c) {
+    _p->execute_fwd_batch(f, fstride, K, W, c);
+}
+
 rtidgtreal_t::rtidgtreal_t(const double *g, int gl, int M, rtdgt_phase_t ptype)
     : M(M) {
     _p = new rtdgtreal_priv(g, gl, M, ptype, DGT_INVERSE);
@@ -21,5 +33,19 @@ rtidgtreal_t::rtidgtreal_t(const double *g, int gl, int M, rtdgt_phase_t ptype)
 rtidgtreal_t::~rtidgtreal_t() { delete _p; }
 
 void rtidgtreal_t::execute(const std::complex<double> *c, int W, double *f) {
-    _p->execute_inv(c, W, f);
-}
\ No newline at end of file
+    _p->execute_inv(c, W, f, true);
+}
+
+void rtidgtreal_t::execute_unwindowed(const std::complex<double> *c, int W,
+                                      double *f) {
+    _p->execute_inv(c, W, f, false);
+}
+
+void rtidgtreal_t::set_batch_len(int len) { _p->set_batch_len(len); }
+
+void rtidgtreal_t::execute_batch_unwindowed(const std::complex<double> *c,
+                                            int K, int W, double *f) {
+    _p->execute_inv_batch(c, K, W, f);
+}
+
+const double *rtidgtreal_t::get_window() const { return _p->get_window(); }
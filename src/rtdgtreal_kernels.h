@@ -0,0 +1,135 @@
+#ifndef RTDGTREAL_KERNELS_H__
+#define RTDGTREAL_KERNELS_H__
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+#include "arrayutils.h"
+
+/**
+ * Per-frame DGT kernels, shared by rtdgtreal_priv and pv_engine. The Size
+ * parameters are int or fixed_size_t<N>, see rtpghi_kernels.h.
+ *
+ * For the painless case (gl <= M) with the zero phase convention, the
+ * circular shift is fused with the windowing, which gives the same samples
+ * as shifting the whole FFT buffer in place afterwards.
+ */
+
+/**
+ * Window one channel and arrange it in the FFT buffer.
+ *
+ * \param[in]   f          Frame, gl samples
+ * \param[in]   g          Window in frame order (fftshifted)
+ * \param[in]   gl         Window length
+ * \param[in]   M          FFT length
+ * \param[in]   zerophase  Zero phase convention, frame centered on 0
+ * \param[out]  buf        FFT input, max(gl, M) samples
+ */
+template <typename GlSize, typename MSize>
+inline void dgt_fwd_frame(const double *f, const double *g, GlSize gl,
+                          MSize M, bool zerophase, double *buf) {
+    const int half = gl / 2;
+
+    if (zerophase && gl <= M) {
+        for (int ii = 0; ii < half; ++ii) {
+            buf[M - half + ii] = f[ii] * g[ii];
+        }
+        for (int ii = half; ii < gl; ++ii) {
+            buf[ii - half] = f[ii] * g[ii];
+        }
+        std::fill(buf + (gl - half), buf + (M - half), 0);
+        return;
+    }
+
+    for (int ii = 0; ii < gl; ++ii) {
+        buf[ii] = f[ii] * g[ii];
+    }
+
+    if (M > gl) {
+        std::fill(buf + gl, buf + M, 0);
+    }
+
+    if (gl > M) {
+        fold_array(buf, gl, 0, M, buf);
+    }
+
+    if (zerophase) {
+        circshift(buf, M, -half, buf);
+    }
+}
+
+/**
+ * Arrange the FFT output of one channel into a frame, optionally windowed.
+ *
+ * \param[in,out]  buf        FFT output, max(gl, M) samples, overwritten
+ * \param[in]      g          Window in frame order, nullptr for none
+ * \param[in]      gl         Window length
+ * \param[in]      M          FFT length
+ * \param[in]      zerophase  Zero phase convention, frame centered on 0
+ * \param[out]     f          Frame, gl samples
+ */
+template <typename GlSize, typename MSize>
+inline void dgt_inv_frame(double *buf, const double *g, GlSize gl, MSize M,
+                          bool zerophase, double *f) {
+    const int half = gl / 2;
+
+    if (zerophase && gl <= M) {
+        if (g) {
+            for (int ii = 0; ii < half; ++ii) {
+                f[ii] = buf[M - half + ii] * g[ii];
+            }
+            for (int ii = half; ii < gl; ++ii) {
+                f[ii] = buf[ii - half] * g[ii];
+            }
+        } else {
+            std::copy(buf + (M - half), buf + M, f);
+            std::copy(buf, buf + (gl - half), f + half);
+        }
+        return;
+    }
+
+    if (zerophase) {
+        circshift(buf, M, half, buf);
+    }
+
+    if (gl > M) {
+        periodize_array(buf, M, gl, buf);
+    }
+
+    if (g) {
+        for (int ii = 0; ii < gl; ++ii) {
+            buf[ii] *= g[ii];
+        }
+    }
+
+    std::copy(buf, buf + gl, f);
+}
+
+/**
+ * Move W channels of coefficients later in time by frac samples, by a
+ * linear phase ramp. A frame read frac samples before its exact position
+ * then has the phase it would have had at that position.
+ *
+ * \param[in,out]  c     Coefficients, M/2 + 1 per channel
+ * \param[in]      M     FFT length
+ * \param[in]      W     Number of channels
+ * \param[in]      frac  Shift in samples
+ */
+template <typename MSize>
+inline void dgt_fractional_shift(std::complex<double> *c, MSize M, int W,
+                                 double frac) {
+    const int                  M2 = M / 2 + 1;
+    const std::complex<double> step = std::polar(1.0, 2.0 * M_PI * frac / M);
+
+    for (int w = 0; w < W; ++w) {
+        std::complex<double> rot = 1.0;
+
+        for (int m = 0; m < M2; ++m) {
+            c[w * M2 + m] *= rot;
+            rot *= step;
+        }
+    }
+}
+
+#endif  // RTDGTREAL_KERNELS_H__
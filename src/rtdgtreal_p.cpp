@@ -1,8 +1,7 @@
 #include "rtdgtreal_p.h"
 
-#include <fftw3.h>
-
 #include "arrayutils.h"
+#include "rtdgtreal_kernels.h"
 #include "rtpghi.h"
 
 rtdgtreal_priv::rtdgtreal_priv(const double *g, int gl, int M,
@@ -16,69 +15,91 @@ rtdgtreal_priv::rtdgtreal_priv(const double *g, int gl, int M,
     M2 = M / 2 + 1;
     _fftBufLen = gl > 2 * M2 ? gl : 2 * M2;
 
-    _g = fftw_alloc_real(gl);
-    _fftBuf = fftw_alloc_real(_fftBufLen);
-    _fftBuf_cpx = cpx_fftw2stl(fftw_alloc_complex(M2));
+    _g = static_cast<double *>(fft_alloc(gl * sizeof(double)));
+    _fftBuf = static_cast<double *>(fft_alloc(_fftBufLen * sizeof(double)));
+    _fftBuf_cpx = static_cast<std::complex<double> *>(
+        fft_alloc(M2 * sizeof(std::complex<double>)));
     _gl = gl;
     _M = M;
     _ptype = ptype;
+    _tradir = tradir;
+    _batchBuf = nullptr;
+    _batchBuf_cpx = nullptr;
+    _batchDist = 0;
+    _batchLen = 1;
 
     fftshift(g, gl, _g);
 
-    if (tradir == DGT_FORWARD) {
-        _pfft = fftw_plan_dft_r2c_1d(M, _fftBuf, cpx_stl2fftw(_fftBuf_cpx),
-                                     FFTW_MEASURE);
-    } else if (tradir == DGT_INVERSE) {
-        _pfft = fftw_plan_dft_c2r_1d(M, cpx_stl2fftw(_fftBuf_cpx), _fftBuf,
-                                     FFTW_MEASURE);
-    }
+    _pfft = fft_real_create(fft_default_backend(), M, tradir == DGT_INVERSE,
+                            _fftBuf, _fftBuf_cpx);
 }
 
 rtdgtreal_priv::~rtdgtreal_priv() {
-    fftw_destroy_plan(_pfft);
-    fftw_free(_g);
-    fftw_free(_fftBuf);
-    fftw_free(cpx_stl2fftw(_fftBuf_cpx));
+    free_batch();
+    _pfft.reset();
+    fft_free(_g);
+    fft_free(_fftBuf);
+    fft_free(_fftBuf_cpx);
 }
 
 void rtdgtreal_priv::execute_fwd(const double *f, int W,
                                  std::complex<double> *c) {
+    execute_fwd(f, _gl, W, c);
+}
+
+void rtdgtreal_priv::execute_fwd(const double *f, int fstride, int W,
+                                 std::complex<double> *c) {
     int M2;
 
     rtpghi_assert(W > 0, "W must be positive");
+    rtpghi_assert(fstride >= _gl, "fstride must be at least gl");
 
     M2 = _M / 2 + 1;
 
     for (int w = 0; w < W; ++w) {
-        const double         *fchan = f + w * _gl;
+        const double         *fchan = f + w * fstride;
         std::complex<double> *cchan = c + w * M2;
 
-        if (_g) {
-            for (int ii = 0; ii < _gl; ++ii) {
-                _fftBuf[ii] = fchan[ii] * _g[ii];
-            }
-        }
+        dgt_fwd_frame(fchan, _g, _gl, _M, _ptype == RTDGTPHASE_ZERO, _fftBuf);
 
-        if (_M > _gl) {
-            std::fill(_fftBuf + _gl, _fftBuf + _gl + (_M - _gl), 0);
-        }
+        _pfft->execute();
 
-        if (_gl > _M) {
-            fold_array(_fftBuf, _gl, _M, 0, _fftBuf);
-        }
+        std::copy(_fftBuf_cpx, _fftBuf_cpx + M2, cchan);
+    }
+}
+
+void rtdgtreal_priv::execute_fwd_batch(const double *const f[], int fstride,
+                                       int K, int W, std::complex<double> *c) {
+    int M2, n, t;
 
-        if (_ptype == RTDGTPHASE_ZERO) {
-            circshift(_fftBuf, _M, -(_gl / 2), _fftBuf);
+    rtpghi_assert(K >= 0, "K must be nonnegative");
+    rtpghi_assert(W > 0, "W must be positive");
+    rtpghi_assert(fstride >= _gl, "fstride must be at least gl");
+
+    M2 = _M / 2 + 1;
+    n = K * W;
+
+    // Transform t is channel t % W of frame t / W
+    for (t = 0; _pbatch && t + _batchLen <= n; t += _batchLen) {
+        for (int b = 0; b < _batchLen; ++b) {
+            const double *fchan = f[(t + b) / W] + (t + b) % W * fstride;
+
+            dgt_fwd_frame(fchan, _g, _gl, _M, _ptype == RTDGTPHASE_ZERO,
+                          _batchBuf + b * _batchDist);
         }
 
-        fftw_execute(_pfft);
+        _pbatch->execute();
 
-        std::copy(_fftBuf_cpx, _fftBuf_cpx + M2, cchan);
+        std::copy(_batchBuf_cpx, _batchBuf_cpx + _batchLen * M2, c + t * M2);
+    }
+
+    for (; t < n; ++t) {
+        execute_fwd(f[t / W] + t % W * fstride, fstride, 1, c + t * M2);
     }
 }
 
 void rtdgtreal_priv::execute_inv(const std::complex<double> *c, int W,
-                                 double *f) {
+                                 double *f, bool applyWindow) {
     int M2;
 
     rtpghi_assert(W > 0, "W must be positive");
@@ -91,22 +112,70 @@ void rtdgtreal_priv::execute_inv(const std::complex<double> *c, int W,
 
         std::copy(cchan, cchan + M2, _fftBuf_cpx);
 
-        fftw_execute(_pfft);
+        _pfft->execute();
 
-        if (_ptype == RTDGTPHASE_ZERO) {
-            circshift(_fftBuf, _M, _gl / 2, _fftBuf);
-        }
+        dgt_inv_frame(_fftBuf, applyWindow ? _g : nullptr, _gl, _M,
+                      _ptype == RTDGTPHASE_ZERO, fchan);
+    }
+}
 
-        if (_gl > _M) {
-            periodize_array(_fftBuf, _M, _gl, _fftBuf);
-        }
+void rtdgtreal_priv::execute_inv_batch(const std::complex<double> *c, int K,
+                                       int W, double *f) {
+    int M2, n, t;
+
+    rtpghi_assert(K >= 0, "K must be nonnegative");
+    rtpghi_assert(W > 0, "W must be positive");
+
+    M2 = _M / 2 + 1;
+    n = K * W;
+
+    for (t = 0; _pbatch && t + _batchLen <= n; t += _batchLen) {
+        std::copy(c + t * M2, c + (t + _batchLen) * M2, _batchBuf_cpx);
 
-        if (_g) {
-            for (int ii = 0; ii < _gl; ++ii) {
-                _fftBuf[ii] *= _g[ii];
-            }
+        _pbatch->execute();
+
+        for (int b = 0; b < _batchLen; ++b) {
+            dgt_inv_frame(_batchBuf + b * _batchDist, nullptr, _gl, _M,
+                          _ptype == RTDGTPHASE_ZERO, f + (t + b) * _gl);
         }
+    }
 
-        std::copy(_fftBuf, _fftBuf + _gl, fchan);
+    for (; t < n; ++t) {
+        execute_inv(c + t * M2, 1, f + t * _gl, false);
     }
-}
\ No newline at end of file
+}
+
+void rtdgtreal_priv::set_batch_len(int len) {
+    int M2;
+
+    rtpghi_assert(len > 0, "len must be positive");
+
+    free_batch();
+
+    M2 = _M / 2 + 1;
+    _batchLen = len;
+
+    if (len < 2) return;
+
+    // Whole cache lines per buffer, as fft_alloc() aligns the first one
+    _batchDist = (_fftBufLen + 7) / 8 * 8;
+    _batchBuf = static_cast<double *>(
+        fft_alloc(len * _batchDist * sizeof(double)));
+    _batchBuf_cpx = static_cast<std::complex<double> *>(
+        fft_alloc(len * M2 * sizeof(std::complex<double>)));
+
+    _pbatch = fft_real_create_batch(fft_default_backend(), _M, len,
+                                    _tradir == DGT_INVERSE, _batchBuf,
+                                    _batchDist, _batchBuf_cpx);
+}
+
+void rtdgtreal_priv::free_batch() {
+    _pbatch.reset();
+    fft_free(_batchBuf);
+    fft_free(_batchBuf_cpx);
+    _batchBuf = nullptr;
+    _batchBuf_cpx = nullptr;
+    _batchLen = 1;
+}
+
+const double *rtdgtreal_priv::get_window() const { return _g; }
\ No newline at end of file
@@ -1,8 +1,9 @@
 #ifndef RTPGHI_P_H__
 #define RTPGHI_P_H__
 
-#include <fftw3.h>
+#include <memory>
 
+#include "fft.h"
 #include "rtdgtreal.h"
 
 enum dgt_transformdirection_t {
@@ -20,18 +21,40 @@ class rtdgtreal_priv final {
     // forward
     void execute_fwd(const double *f, int W, std::complex<double> *c);
 
+    void execute_fwd(const double *f, int fstride, int W,
+                     std::complex<double> *c);
+
+    void execute_fwd_batch(const double *const f[], int fstride, int K, int W,
+                           std::complex<double> *c);
+
     // inverse
-    void execute_inv(const std::complex<double> *c, int W, double *f);
+    void execute_inv(const std::complex<double> *c, int W, double *f,
+                     bool applyWindow);
+
+    void execute_inv_batch(const std::complex<double> *c, int K, int W,
+                           double *f);
+
+    void set_batch_len(int len);
+
+    const double *get_window() const;
 
    private:
-    double               *_g;           //!< Window
-    int                   _gl;          //!< Window length
-    int                   _M;           //!< Number of FFT channels
-    rtdgt_phase_t         _ptype;       //!< Phase convention
-    double               *_fftBuf;      //!< Internal buffer
-    std::complex<double> *_fftBuf_cpx;  //!< Internal buffer
-    int                   _fftBufLen;   //!< Internal buffer length
-    fftw_plan             _pfft;        //!< FFTW plan
+    void free_batch();
+
+    double                     *_g;             //!< Window
+    int                         _gl;            //!< Window length
+    int                         _M;             //!< Number of FFT channels
+    rtdgt_phase_t               _ptype;         //!< Phase convention
+    dgt_transformdirection_t    _tradir;        //!< Direction
+    double                     *_fftBuf;        //!< Internal buffer
+    std::complex<double>       *_fftBuf_cpx;    //!< Internal buffer
+    int                         _fftBufLen;     //!< Internal buffer length
+    std::unique_ptr<fft_real_t> _pfft;          //!< FFT between the buffers
+    double                     *_batchBuf;      //!< Batch buffers
+    std::complex<double>       *_batchBuf_cpx;  //!< Batch buffers
+    int                         _batchDist;     //!< Batch buffer distance
+    int                         _batchLen;      //!< Transforms per batch
+    std::unique_ptr<fft_real_t> _pbatch;        //!< FFT between the batches
 };
 
 #endif  // RTPGHI_P_H__
\ No newline at end of file
@@ -9,11 +9,18 @@ rtdgtreal_processor_t::rtdgtreal_processor_t(firwin_t win, int gl, int a, int M,
                                       procDelay);
 }
 
+rtdgtreal_processor_t::rtdgtreal_processor_t(const double *g, int gl, int a,
+                                             int M, int numChans,
+                                             int bufLenMax, int procDelay) {
+    _p = new rtdgtreal_processor_priv(g, gl, a, M, numChans, bufLenMax,
+                                      procDelay);
+}
+
 rtdgtreal_processor_t::~rtdgtreal_processor_t() { delete _p; }
 
 void rtdgtreal_processor_t::reset() { _p->reset(); }
 
-void rtdgtreal_processor_t::set_anaa(int a) { _p->set_anaa(a); }
+void rtdgtreal_processor_t::set_anaa(double a) { _p->set_anaa(a); }
 
 void rtdgtreal_processor_t::set_syna(int a) { _p->set_syna(a); }
 
@@ -22,23 +29,81 @@ void rtdgtreal_processor_t::set_callback(rtdgtreal_processor_callback *callback,
     _p->set_callback(callback, userdata);
 }
 
-void rtdgtreal_processor_t::execute_compact(const double *in, int len,
-                                            int chanNo, double *out) {
-    _p->execute_compact(in, len, chanNo, out);
+void rtdgtreal_processor_t::set_pipeline_stages(int stages) {
+    _p->set_pipeline_stages(stages);
+}
+
+int rtdgtreal_processor_t::get_pipeline_stages() const {
+    return _p->get_pipeline_stages();
+}
+
+void rtdgtreal_processor_t::set_batch_frames(int frames) {
+    _p->set_batch_frames(frames);
+}
+
+int rtdgtreal_processor_t::get_batch_frames() const {
+    return _p->get_batch_frames();
+}
+
+void rtdgtreal_processor_t::set_dither(bool enable) { _p->set_dither(enable); }
+
+bool rtdgtreal_processor_t::get_dither() const { return _p->get_dither(); }
+
+int rtdgtreal_processor_t::execute_compact(const double *in, int len,
+                                           int chanNo, double *out) {
+    return _p->execute_compact(in, len, chanNo, out);
+}
+
+int rtdgtreal_processor_t::execute_gen_compact(const double *in, int inLen,
+                                               int chanNo, int outLen,
+                                               double *out) {
+    return _p->execute_gen_compact(in, inLen, chanNo, outLen, out);
+}
+
+int rtdgtreal_processor_t::execute(const double **in, int len, int chanNo,
+                                   double **out) {
+    return _p->execute(in, len, chanNo, out);
+}
+
+int rtdgtreal_processor_t::execute_gen(const double **in, int inLen,
+                                       int chanNo, int outLen, double **out) {
+    return _p->execute_gen(in, inLen, chanNo, outLen, out);
+}
+
+int rtdgtreal_processor_t::execute_gen_interleaved(const void  *in,
+                                                   pcm_format_t fmt, int inLen,
+                                                   int chanNo, int outLen,
+                                                   double **out) {
+    return _p->execute_gen_interleaved(in, fmt, inLen, chanNo, outLen, out);
 }
 
-void rtdgtreal_processor_t::execute_gen_compact(const double *in, int inLen,
-                                                int chanNo, int outLen,
-                                                double *out) {
-    _p->execute_gen_compact(in, inLen, chanNo, outLen, out);
+int rtdgtreal_processor_t::execute_gen_pcm(const void *const *in,
+                                           pcm_format_t fmt, int inLen,
+                                           int chanNo, int outLen,
+                                           void *const *out) {
+    return _p->execute_gen_pcm(in, fmt, inLen, chanNo, outLen, out);
 }
 
-void rtdgtreal_processor_t::execute(const double **in, int len, int chanNo,
-                                    double **out) {
-    _p->execute(in, len, chanNo, out);
+int rtdgtreal_processor_t::execute_pull(rtdgtreal_processor_reader *reader,
+                                        void *userdata, int chanNo, int outLen,
+                                        double **out, int *inLen) {
+    return _p->execute_pull(reader, userdata, chanNo, outLen, out, inLen);
 }
 
-void rtdgtreal_processor_t::execute_gen(const double **in, int inLen,
-                                        int chanNo, int outLen, double **out) {
-    _p->execute_gen(in, inLen, chanNo, outLen, out);
-}
\ No newline at end of file
+int rtdgtreal_processor_t::execute_discard(rtdgtreal_processor_reader *reader,
+                                           void *userdata, int chanNo,
+                                           int outLen, int *inLen) {
+    return _p->execute_discard(reader, userdata, chanNo, outLen, inLen);
+}
+
+size_t rtdgtreal_processor_t::get_state_size() const {
+    return _p->get_state_size();
+}
+
+void rtdgtreal_processor_t::save_state(void *buf) const {
+    _p->save_state(buf);
+}
+
+void rtdgtreal_processor_t::load_state(const void *buf) {
+    _p->load_state(buf);
+}
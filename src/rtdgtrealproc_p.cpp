@@ -1,29 +1,61 @@
 #include "rtdgtrealproc_p.h"
 
-#include <fftw3.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #include "circularbuf.h"
-#include "gabdual_painless.h"
+#include "fpenv.h"
+#include "gabdual_long.h"
 #include "rtdgtreal.h"
+#include "rtdgtreal_kernels.h"
 #include "rtpghi.h"
+#include "rtpghi_trace_p.h"
 
 rtdgtreal_processor_priv::rtdgtreal_processor_priv(firwin_t win, int gl, int a,
                                                    int M, int numChans,
                                                    int bufLenMax,
                                                    int procDelay) {
     rtpghi_assert(gl > 0, "gl must be positive");
-    rtpghi_assert(a > 0, "a must be positive");
-    rtpghi_assert(M > 0, "M must be positive");
     rtpghi_assert(numChans > 0, "numChans must be positive");
 
     _g = std::make_unique<double[]>(gl);
-    _gd = std::make_unique<double[]>(gl);
-
     firwin(win, gl, _g.get());
-    gabdual_painless(_g.get(), gl, a, M, _gd.get());
+
+    init_dual(gl, a, M);
+    init(_g.get(), gl, _gd.get(), gl, a, M, numChans, bufLenMax, procDelay);
+}
+
+rtdgtreal_processor_priv::rtdgtreal_processor_priv(const double *g, int gl,
+                                                   int a, int M, int numChans,
+                                                   int bufLenMax,
+                                                   int procDelay) {
+    rtpghi_assert(g != nullptr, "g must not be null");
+    rtpghi_assert(gl > 0, "gl must be positive");
+    rtpghi_assert(numChans > 0, "numChans must be positive");
+
+    _g = std::make_unique<double[]>(gl);
+    std::copy(g, g + gl, _g.get());
+
+    init_dual(gl, a, M);
     init(_g.get(), gl, _gd.get(), gl, a, M, numChans, bufLenMax, procDelay);
 }
 
+void rtdgtreal_processor_priv::init_dual(int gl, int a, int M) {
+    rtpghi_assert(a > 0, "a must be positive");
+    rtpghi_assert(M > 0, "M must be positive");
+
+    _gd = std::make_unique<double[]>(gl);
+
+    // Also for gl > M, with a dual supported on gl samples
+    // Without a dual, the output would silently be zero
+    if (!gabdual(_g.get(), gl, a, M, _gd.get())) {
+        fprintf(stderr, "No dual window with the support of the window\n");
+        abort();
+    }
+}
+
 void rtdgtreal_processor_priv::init(const double *ga, int gal, const double *gs,
                                     int gsl, int a, int M, int numChans,
                                     int bufLenMax, int procDelay) {
@@ -60,15 +92,25 @@ void rtdgtreal_processor_priv::init(const double *ga, int gal, const double *gs,
     _fwdplan = std::make_unique<rtdgtreal_t>(ga, gal, M, RTDGTPHASE_ZERO);
     _backplan = std::make_unique<rtidgtreal_t>(gs, gsl, M, RTDGTPHASE_ZERO);
 
+    _batchViews.resize(1);
+    _batchFracs.resize(1);
     _bufLenMax = bufLenMax;
+    _frameLen = gal;
+
+    _callback = nullptr;
+    _userdata = nullptr;
+    _discardLen = 0;
+    _pipelineCallback = nullptr;
+    _pipelineFlush = false;
 }
 
 void rtdgtreal_processor_priv::reset() {
     _fwdfifo->reset();
     _backfifo->reset();
+    _dither.state = 1;
 }
 
-void rtdgtreal_processor_priv::set_anaa(int a) { _fwdfifo->set_hop(a); }
+void rtdgtreal_processor_priv::set_anaa(double a) { _fwdfifo->set_hop(a); }
 
 void rtdgtreal_processor_priv::set_syna(int a) { _backfifo->set_hop(a); }
 
@@ -78,14 +120,98 @@ void rtdgtreal_processor_priv::set_callback(
     _userdata = userdata;
 }
 
-void rtdgtreal_processor_priv::execute_compact(const double *in, int len,
-                                               int chanNo, double *out) {
+void rtdgtreal_processor_priv::set_pipeline_stages(int stages) {
+    int M2 = _fwdplan->M / 2 + 1;
+    int W = _fwdfifo->get_numchans();
+
+    rtpghi_assert(stages >= 1 && stages <= 3, "stages must be 1, 2 or 3");
+
+    if (stages == get_pipeline_stages()) return;
+
+    _pipeline.reset();
+    _slots.clear();
+
+    if (stages < 2) return;
+
+    // Enough frames in flight for the stages not to wait on each other
+    _slots.resize(2 * stages);
+    for (frame_slot_t &slot : _slots) {
+        slot.scratch = std::make_unique<double[]>(W * _frameLen);
+        slot.cin = std::make_unique<std::complex<double>[]>(W * M2);
+        slot.cout = std::make_unique<std::complex<double>[]>(W * M2);
+        slot.frame = nullptr;
+        slot.frameStride = 0;
+    }
+
+    _pipeline = std::make_unique<frame_pipeline_t>(stages, _slots.size(),
+                                                   pipeline_stage, this);
+}
+
+int rtdgtreal_processor_priv::get_pipeline_stages() const {
+    return _pipeline ? _pipeline->get_numstages() : 1;
+}
+
+void rtdgtreal_processor_priv::set_batch_frames(int frames) {
+    int M2 = _fwdplan->M / 2 + 1;
+    int W = _fwdfifo->get_numchans();
+
+    rtpghi_assert(frames > 0, "frames must be positive");
+
+    if (frames == get_batch_frames()) return;
+
+    _batchViews.resize(frames);
+    _batchFracs.resize(frames);
+    _batchScratch.reset();
+    _batchIn.reset();
+    _batchOut.reset();
+    _batchBuf.reset();
+
+    // All channels of all frames in one batch
+    _fwdplan->set_batch_len(frames * W);
+    _backplan->set_batch_len(frames * W);
+
+    if (frames < 2) return;
+
+    _batchScratch = std::make_unique<double[]>(frames * W * _frameLen);
+    _batchIn = std::make_unique<std::complex<double>[]>(frames * W * M2);
+    _batchOut = std::make_unique<std::complex<double>[]>(frames * W * M2);
+    _batchBuf = std::make_unique<double[]>(frames * W * _frameLen);
+}
+
+int rtdgtreal_processor_priv::get_batch_frames() const {
+    return _batchViews.size();
+}
+
+void rtdgtreal_processor_priv::set_dither(bool enable) {
+    _dither.enabled = enable;
+}
+
+bool rtdgtreal_processor_priv::get_dither() const { return _dither.enabled; }
+
+void rtdgtreal_processor_priv::shift_frame(std::complex<double> *c,
+                                           double frac) {
+    if (frac == 0) return;
+
+    dgt_fractional_shift(c, _fwdplan->M, _fwdfifo->get_numchans(), frac);
+}
+
+rtdgtreal_processor_callback *rtdgtreal_processor_priv::get_callback() const {
+    if (_callback) return _callback;
+
+    return [](void *, const std::complex<double> *in, int M2, int W,
+              std::complex<double> *out) {
+        std::copy(in, in + W * M2, out);
+    };
+}
+
+int rtdgtreal_processor_priv::execute_compact(const double *in, int len,
+                                              int chanNo, double *out) {
     return execute_gen_compact(in, len, chanNo, len, out);
 }
 
-void rtdgtreal_processor_priv::execute_gen_compact(const double *in, int inLen,
-                                                   int chanNo, int outLen,
-                                                   double *out) {
+int rtdgtreal_processor_priv::execute_gen_compact(const double *in, int inLen,
+                                                  int chanNo, int outLen,
+                                                  double *out) {
     int chanLoc;
 
     chanLoc =
@@ -101,81 +227,434 @@ void rtdgtreal_processor_priv::execute_gen_compact(const double *in, int inLen,
         std::fill(out + chanLoc * outLen, out + chanNo * outLen, 0);
     }
 
-    execute_gen(_inTmp.data(), inLen, chanLoc, outLen, _outTmp.data());
+    return execute_gen(_inTmp.data(), inLen, chanLoc, outLen, _outTmp.data());
 }
 
-void rtdgtreal_processor_priv::execute(const double **in, int len, int chanNo,
-                                       double **out) {
-    execute_gen(in, len, chanNo, len, out);
+int rtdgtreal_processor_priv::execute(const double **in, int len, int chanNo,
+                                      double **out) {
+    return execute_gen(in, len, chanNo, len, out);
 }
 
-void rtdgtreal_processor_priv::execute_gen(const double **in, int inLen,
-                                           int chanNo, int outLen,
-                                           double **out) {
-    int samplesWritten = 0;
-    int samplesRead = 0;
-
-    rtdgtreal_processor_callback *callback = _callback;
+/**
+ * Zero samples [from, to[ of buf, whose samples are size bytes long. Zero
+ * has all bits clear in every sample format.
+ */
+static void zero_samples(void *buf, int from, int to, int size) {
+    std::memset(static_cast<unsigned char *>(buf) + from * size, 0,
+                (to - from) * size);
+}
 
-    rtpghi_assert(inLen >= 0 && outLen >= 0, "len must be nonnegative");
-    rtpghi_assert(chanNo >= 0, "chanNo must be nonnegative");
+template <typename T>
+bool rtdgtreal_processor_priv::clamp_lengths(int *inLen, int *chanNo,
+                                             int *outLen, T *const *out,
+                                             int sampleSize) {
+    rtpghi_assert(*inLen >= 0 && *outLen >= 0, "len must be nonnegative");
+    rtpghi_assert(*chanNo >= 0, "chanNo must be nonnegative");
 
-    if (chanNo == 0 || (inLen == 0 && outLen == 0)) return;
+    if (*chanNo == 0 || (*inLen == 0 && *outLen == 0)) return false;
 
-    if (chanNo > _fwdfifo->get_numchans()) {
-        for (int w = _fwdfifo->get_numchans(); w < chanNo; ++w) {
-            std::fill(out[w], out[w] + outLen, 0);
+    if (*chanNo > _fwdfifo->get_numchans()) {
+        for (int w = _fwdfifo->get_numchans(); w < *chanNo; ++w) {
+            zero_samples(out[w], 0, *outLen, sampleSize);
         }
-        chanNo = _fwdfifo->get_numchans();
+        *chanNo = _fwdfifo->get_numchans();
     }
 
-    if (inLen > _bufLenMax) {
-        inLen = _bufLenMax;
+    if (*inLen > _bufLenMax) {
+        *inLen = _bufLenMax;
     }
 
-    if (outLen > _bufLenMax) {
-        for (int w = 0; w < chanNo; ++w) {
-            std::fill(out[w] + _bufLenMax, out[w] + outLen, 0);
+    if (*outLen > _bufLenMax) {
+        for (int w = 0; w < *chanNo; ++w) {
+            zero_samples(out[w], _bufLenMax, *outLen, sampleSize);
         }
-        outLen = _bufLenMax;
+        *outLen = _bufLenMax;
     }
 
-    // Get default processor if none was set
-    if (!callback) {
-        callback = [](void *, const std::complex<double> *in, int M2, int W,
-                      std::complex<double> *out) {
-            std::copy(in, in + W * M2, out);
-        };
+    return true;
+}
+
+void rtdgtreal_processor_priv::process_frames() {
+    // Frames are only skipped one at a time
+    if (_pipeline && _discardLen == 0) {
+        process_frames_pipelined();
+        return;
     }
 
-    // Write new data
-    samplesWritten = _fwdfifo->write(in, inLen, chanNo);
+    if (get_batch_frames() > 1 && _discardLen == 0) {
+        process_frames_batched();
+        return;
+    }
+
+    rtdgtreal_processor_callback *callback = get_callback();
+    const double                 *frame;
+    int                           frameStride;
 
     // While there is new data in the input fifo
-    while (_fwdfifo->read(_buf.get()) > 0) {
-        // Transform
-        _fwdplan->execute(_buf.get(), _fwdfifo->get_numchans(),
-                          _fftBufIn.get());
+    while (_fwdfifo->read_view(&frame, &frameStride, _buf.get()) > 0) {
+        RTPGHI_TRACE_SCOPE("frame", 0);
+
+        // Transform, directly from the fifo storage if it is mirrored
+        {
+            RTPGHI_TRACE_SCOPE("analysis", 0);
+            _fwdplan->execute(frame, frameStride, _fwdfifo->get_numchans(),
+                              _fftBufIn.get());
+            shift_frame(_fftBufIn.get(), _fwdfifo->get_frame_frac());
+        }
 
         // Process
-        callback(_userdata, _fftBufIn.get(), _fwdplan->M / 2 + 1,
-                 _fwdfifo->get_numchans(), _fftBufOut.get());
+        {
+            RTPGHI_TRACE_SCOPE("process", 0);
+            callback(_userdata, _fftBufIn.get(), _fwdplan->M / 2 + 1,
+                     _fwdfifo->get_numchans(), _fftBufOut.get());
+        }
+
+        // Frames whose output is all discarded are not synthesized
+        if (_backfifo->get_write_end() <= _discardLen) {
+            _backfifo->write_zeros();
+            continue;
+        }
 
         // Reconstruct
-        _backplan->execute(_fftBufOut.get(), _backfifo->get_numchans(),
-                           _buf.get());
+        RTPGHI_TRACE_SCOPE("synthesis", 0);
+        _backplan->execute_unwindowed(_fftBufOut.get(),
+                                      _backfifo->get_numchans(), _buf.get());
+
+        // Window, write (and overlap) to out fifo
+        _backfifo->write(_buf.get(), _backplan->get_window());
+    }
+}
+
+void rtdgtreal_processor_priv::process_frames_batched() {
+    rtdgtreal_processor_callback *callback = get_callback();
+    int                           M2 = _fwdplan->M / 2 + 1;
+    int                           W = _fwdfifo->get_numchans();
+    int                           maxFrames = get_batch_frames();
+    int                           frameStride;
+    int                           K;
+
+    // Up to maxFrames frames at once. No input is written to the analysis
+    // fifo in between, so the mirrored views of all of them stay valid.
+    do {
+        for (K = 0; K < maxFrames; ++K) {
+            double *scratch = _batchScratch.get() + K * W * _frameLen;
+
+            if (_fwdfifo->read_view(&_batchViews[K], &frameStride,
+                                    scratch) <= 0) {
+                break;
+            }
+            _batchFracs[K] = _fwdfifo->get_frame_frac();
+        }
+
+        if (K == 0) break;
+
+        RTPGHI_TRACE_SCOPE("frames", K);
+
+        {
+            RTPGHI_TRACE_SCOPE("analysis", K);
+            _fwdplan->execute_batch(_batchViews.data(), frameStride, K, W,
+                                    _batchIn.get());
+            for (int k = 0; k < K; ++k) {
+                shift_frame(_batchIn.get() + k * W * M2, _batchFracs[k]);
+            }
+        }
+
+        // The frames depend on each other, one after the other
+        {
+            RTPGHI_TRACE_SCOPE("process", K);
+            for (int k = 0; k < K; ++k) {
+                callback(_userdata, _batchIn.get() + k * W * M2, M2, W,
+                         _batchOut.get() + k * W * M2);
+            }
+        }
+
+        RTPGHI_TRACE_SCOPE("synthesis", K);
+        _backplan->execute_batch_unwindowed(_batchOut.get(), K, W,
+                                            _batchBuf.get());
+
+        for (int k = 0; k < K; ++k) {
+            _backfifo->write(_batchBuf.get() + k * W * _frameLen,
+                             _backplan->get_window());
+        }
+    } while (K == maxFrames);
+}
+
+void rtdgtreal_processor_priv::process_frames_pipelined() {
+    int stages = _pipeline->get_numstages();
+    int W = _fwdfifo->get_numchans();
+
+    _pipelineCallback = get_callback();
+    _pipelineFlush = denormal_scope_t::active();
+
+    // Reading and analysis here, the callback (with 3 stages) and the
+    // synthesis on the workers. No input is written to the analysis fifo
+    // until the pipeline is drained, so the mirrored views stay valid.
+    while (true) {
+        frame_slot_t &slot = _slots[_pipeline->acquire()];
+
+        if (_fwdfifo->read_view(&slot.frame, &slot.frameStride,
+                                slot.scratch.get()) <= 0) {
+            break;
+        }
+
+        {
+            RTPGHI_TRACE_SCOPE("analysis", 0);
+            _fwdplan->execute(slot.frame, slot.frameStride, W,
+                              slot.cin.get());
+            shift_frame(slot.cin.get(), _fwdfifo->get_frame_frac());
+        }
+
+        if (stages == 2) {
+            RTPGHI_TRACE_SCOPE("process", 0);
+            _pipelineCallback(_userdata, slot.cin.get(), _fwdplan->M / 2 + 1,
+                              W, slot.cout.get());
+        }
+
+        _pipeline->submit();
+    }
 
-        // Write (and overlap) to out fifo
-        _backfifo->write(_buf.get());
+    _pipeline->drain();
+}
+
+void rtdgtreal_processor_priv::pipeline_stage(void *userdata, int stage,
+                                              int slotIdx) {
+    auto          p = static_cast<rtdgtreal_processor_priv *>(userdata);
+    frame_slot_t &slot = p->_slots[slotIdx];
+    int           W = p->_fwdfifo->get_numchans();
+
+    denormal_scope_t fpscope(p->_pipelineFlush);
+
+    if (stage < p->_pipeline->get_numstages() - 1) {
+        RTPGHI_TRACE_SCOPE("process", 0);
+        p->_pipelineCallback(p->_userdata, slot.cin.get(),
+                             p->_fwdplan->M / 2 + 1, W, slot.cout.get());
+    } else {
+        RTPGHI_TRACE_SCOPE("synthesis", 0);
+        p->_backplan->execute_unwindowed(slot.cout.get(), W, p->_buf.get());
+        p->_backfifo->write(p->_buf.get(), p->_backplan->get_window());
     }
+}
+
+int rtdgtreal_processor_priv::read_output(int samplesWritten, int inLen,
+                                          int chanNo, int outLen,
+                                          double **out) {
+    int samplesRead;
 
     // Read samples for output
-    samplesRead = _backfifo->read(outLen, chanNo, out);
+    {
+        RTPGHI_TRACE_SCOPE("fifo read", outLen);
+        samplesRead = _backfifo->read(outLen, chanNo, out);
+    }
+
+    // Do not leave stale data behind on a short read
+    for (int w = 0; w < chanNo; ++w) {
+        std::fill(out[w] + samplesRead, out[w] + outLen, 0);
+    }
+
+    trace_lengths(samplesWritten, inLen, samplesRead, outLen);
+
+    return samplesRead;
+}
 
+void rtdgtreal_processor_priv::trace_lengths(int samplesWritten, int inLen,
+                                             int samplesRead, int outLen) {
     if (samplesWritten != inLen) {
-        fprintf(stderr, "Samples written != input length\n");
+        RTPGHI_TRACE_INSTANT("short write", inLen - samplesWritten);
     }
     if (samplesRead != outLen) {
-        fprintf(stderr, "Samples read != output length\n");
+        RTPGHI_TRACE_INSTANT("short read", outLen - samplesRead);
+    }
+    (void)samplesWritten;
+    (void)inLen;
+    (void)samplesRead;
+    (void)outLen;
+}
+
+int rtdgtreal_processor_priv::execute_gen(const double **in, int inLen,
+                                          int chanNo, int outLen,
+                                          double **out) {
+    int samplesWritten;
+
+    if (!clamp_lengths(&inLen, &chanNo, &outLen, out, sizeof(double))) {
+        return 0;
+    }
+
+    // Write new data
+    {
+        RTPGHI_TRACE_SCOPE("fifo write", inLen);
+        samplesWritten = _fwdfifo->write(in, inLen, chanNo);
+    }
+
+    process_frames();
+
+    return read_output(samplesWritten, inLen, chanNo, outLen, out);
+}
+
+int rtdgtreal_processor_priv::execute_gen_interleaved(const void  *in,
+                                                      pcm_format_t fmt,
+                                                      int inLen, int chanNo,
+                                                      int      outLen,
+                                                      double **out) {
+    int samplesWritten;
+    int inStride = chanNo;
+
+    if (!clamp_lengths(&inLen, &chanNo, &outLen, out, sizeof(double))) {
+        return 0;
+    }
+
+    // Write new data, converting it on the way
+    {
+        RTPGHI_TRACE_SCOPE("fifo write", inLen);
+        samplesWritten =
+            _fwdfifo->write_interleaved(in, fmt, inLen, chanNo, inStride);
+    }
+
+    process_frames();
+
+    return read_output(samplesWritten, inLen, chanNo, outLen, out);
+}
+
+int rtdgtreal_processor_priv::execute_gen_pcm(const void *const *in,
+                                              pcm_format_t fmt, int inLen,
+                                              int chanNo, int outLen,
+                                              void *const *out) {
+    int samplesWritten, samplesRead;
+    int size = pcm_sample_size(fmt);
+
+    if (!clamp_lengths(&inLen, &chanNo, &outLen, out, size)) return 0;
+
+    // Write new data, converting it on the way
+    {
+        RTPGHI_TRACE_SCOPE("fifo write", inLen);
+        samplesWritten = _fwdfifo->write_planar(in, fmt, inLen, chanNo);
+    }
+
+    process_frames();
+
+    // Read samples for output, converting them back
+    {
+        RTPGHI_TRACE_SCOPE("fifo read", outLen);
+        samplesRead =
+            _backfifo->read_pcm(outLen, chanNo, fmt, &_dither, out);
+    }
+
+    // Do not leave stale data behind on a short read
+    for (int w = 0; w < chanNo; ++w) {
+        zero_samples(out[w], samplesRead, outLen, size);
+    }
+
+    trace_lengths(samplesWritten, inLen, samplesRead, outLen);
+
+    return samplesRead;
+}
+
+int rtdgtreal_processor_priv::execute_pull(rtdgtreal_processor_reader *reader,
+                                           void *userdata, int chanNo,
+                                           int outLen, double **out,
+                                           int *inLen) {
+    int samplesPulled = 0;
+    int samplesRead = 0;
+
+    rtpghi_assert(outLen >= 0, "len must be nonnegative");
+    rtpghi_assert(chanNo >= 0, "chanNo must be nonnegative");
+
+    if (inLen) *inLen = 0;
+
+    if (chanNo == 0 || outLen == 0) return 0;
+
+    if (chanNo > _fwdfifo->get_numchans()) {
+        for (int w = _fwdfifo->get_numchans(); w < chanNo; ++w) {
+            std::fill(out[w], out[w] + outLen, 0);
+        }
+        chanNo = _fwdfifo->get_numchans();
+    }
+
+    // The synthesis FIFO holds at most _bufLenMax samples beyond one frame
+    while (samplesRead < outLen) {
+        int len = std::min(outLen - samplesRead, _bufLenMax);
+
+        // One frame at a time, so that no more input than needed is pulled
+        while (_backfifo->get_available() < len) {
+            int needed = _fwdfifo->get_needed();
+
+            if (needed > 0) {
+                RTPGHI_TRACE_SCOPE("fifo write", needed);
+                samplesPulled +=
+                    _fwdfifo->write_from(reader, userdata, needed, chanNo);
+            }
+
+            process_frames();
+        }
+
+        for (int w = 0; w < chanNo; ++w) _outTmp[w] = out[w] + samplesRead;
+
+        RTPGHI_TRACE_SCOPE("fifo read", len);
+        samplesRead += _backfifo->read(len, chanNo, _outTmp.data());
     }
-}
\ No newline at end of file
+
+    if (inLen) *inLen = samplesPulled;
+
+    return samplesRead;
+}
+
+int rtdgtreal_processor_priv::execute_discard(
+    rtdgtreal_processor_reader *reader, void *userdata, int chanNo,
+    int outLen, int *inLen) {
+    int samplesPulled = 0;
+    int samplesDiscarded = 0;
+
+    rtpghi_assert(outLen >= 0, "len must be nonnegative");
+    rtpghi_assert(chanNo >= 0, "chanNo must be nonnegative");
+
+    chanNo = std::min(chanNo, _fwdfifo->get_numchans());
+
+    while (chanNo > 0 && samplesDiscarded < outLen) {
+        int len = std::min(outLen - samplesDiscarded, _bufLenMax);
+
+        _discardLen = outLen - samplesDiscarded;
+
+        while (_backfifo->get_available() < len) {
+            int needed = _fwdfifo->get_needed();
+
+            if (needed > 0) {
+                samplesPulled +=
+                    _fwdfifo->write_from(reader, userdata, needed, chanNo);
+            }
+
+            process_frames();
+        }
+
+        samplesDiscarded += _backfifo->discard(len);
+    }
+
+    _discardLen = 0;
+
+    if (inLen) *inLen = samplesPulled;
+
+    return samplesDiscarded;
+}
+
+void rtdgtreal_processor_priv::transfer_state(state_io_t *io) {
+    _fwdfifo->transfer_state(io);
+    _backfifo->transfer_state(io);
+    io->io(&_dither.state);
+}
+
+size_t rtdgtreal_processor_priv::get_state_size() {
+    state_io_t io(state_io_t::STATE_SIZE, nullptr);
+
+    transfer_state(&io);
+    return io.get_len();
+}
+
+void rtdgtreal_processor_priv::save_state(void *buf) {
+    state_io_t io(state_io_t::STATE_SAVE, buf);
+
+    transfer_state(&io);
+}
+
+void rtdgtreal_processor_priv::load_state(const void *buf) {
+    state_io_t io(state_io_t::STATE_LOAD, const_cast<void *>(buf));
+
+    transfer_state(&io);
+}
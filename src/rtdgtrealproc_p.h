@@ -5,6 +5,8 @@
 #include <vector>
 
 #include "circularbuf.h"
+#include "framepipeline.h"
+#include "pcmconv.h"
 #include "rtdgtreal.h"
 #include "rtdgtrealproc.h"
 
@@ -13,25 +15,82 @@ class rtdgtreal_processor_priv final {
     rtdgtreal_processor_priv(firwin_t win, int gl, int a, int M, int numChans,
                              int bufLenMax, int procDelay);
 
+    rtdgtreal_processor_priv(const double *g, int gl, int a, int M,
+                             int numChans, int bufLenMax, int procDelay);
+
     void reset();
-    void set_anaa(int a);
+    void set_anaa(double a);
     void set_syna(int a);
     void set_callback(rtdgtreal_processor_callback *callback, void *userdata);
+    void set_pipeline_stages(int stages);
+    int  get_pipeline_stages() const;
+    void set_batch_frames(int frames);
+    int  get_batch_frames() const;
+    void set_dither(bool enable);
+    bool get_dither() const;
 
-    void execute_compact(const double *in, int len, int chanNo, double *out);
+    int execute_compact(const double *in, int len, int chanNo, double *out);
 
-    void execute_gen_compact(const double *in, int inLen, int chanNo,
-                             int outLen, double *out);
+    int execute_gen_compact(const double *in, int inLen, int chanNo,
+                            int outLen, double *out);
 
-    void execute(const double **in, int len, int chanNo, double **out);
+    int execute(const double **in, int len, int chanNo, double **out);
 
-    void execute_gen(const double **in, int inLen, int chanNo, int outLen,
-                     double **out);
+    int execute_gen(const double **in, int inLen, int chanNo, int outLen,
+                    double **out);
+
+    int execute_gen_interleaved(const void *in, pcm_format_t fmt, int inLen,
+                                int chanNo, int outLen, double **out);
+
+    int execute_gen_pcm(const void *const *in, pcm_format_t fmt, int inLen,
+                        int chanNo, int outLen, void *const *out);
+
+    int execute_pull(rtdgtreal_processor_reader *reader, void *userdata,
+                     int chanNo, int outLen, double **out, int *inLen);
+
+    int execute_discard(rtdgtreal_processor_reader *reader, void *userdata,
+                        int chanNo, int outLen, int *inLen);
+
+    size_t get_state_size();
+    void   save_state(void *buf);
+    void   load_state(const void *buf);
 
    private:
+    /** Frame in flight through the pipeline */
+    struct frame_slot_t {
+        std::unique_ptr<double[]>               scratch;  //!< Non-mirrored
+        std::unique_ptr<std::complex<double>[]> cin;
+        std::unique_ptr<std::complex<double>[]> cout;
+        const double                           *frame;
+        int                                     frameStride;
+    };
+
+    void init_dual(int gl, int a, int M);
+
     void init(const double *ga, int gal, const double *gs, int gsl, int a,
               int M, int numChans, int bufLenMax, int procDelay);
 
+    /** Clamp the lengths, zeroing the outputs beyond them */
+    template <typename T>
+    bool clamp_lengths(int *inLen, int *chanNo, int *outLen, T *const *out,
+                       int sampleSize);
+    void process_frames();
+    void transfer_state(state_io_t *io);
+    int  read_output(int samplesWritten, int inLen, int chanNo, int outLen,
+                     double **out);
+    void trace_lengths(int samplesWritten, int inLen, int samplesRead,
+                       int outLen);
+
+    /** Move a frame read at a fractional position to it, see set_anaa() */
+    void shift_frame(std::complex<double> *c, double frac);
+
+    /** The callback, or one copying its input if none was set */
+    rtdgtreal_processor_callback *get_callback() const;
+
+    void        process_frames_batched();
+    void        process_frames_pipelined();
+    static void pipeline_stage(void *userdata, int stage, int slotIdx);
+
     std::unique_ptr<double[]>               _g;
     std::unique_ptr<double[]>               _gd;
     std::unique_ptr<std::complex<double>[]> _fftBufIn;
@@ -43,10 +102,25 @@ class rtdgtreal_processor_priv final {
     std::unique_ptr<synthesis_fifo_t>       _backfifo;
     std::unique_ptr<rtdgtreal_t>            _fwdplan;
     std::unique_ptr<rtidgtreal_t>           _backplan;
+    std::unique_ptr<frame_pipeline_t>       _pipeline;
+    std::vector<frame_slot_t>               _slots;
+    std::vector<const double *>             _batchViews;
+    std::vector<double>                     _batchFracs;  //!< Frame offsets
+    std::unique_ptr<double[]>               _batchScratch;
+    std::unique_ptr<std::complex<double>[]> _batchIn;
+    std::unique_ptr<std::complex<double>[]> _batchOut;
+    std::unique_ptr<double[]>               _batchBuf;
     int                                     _bufLenMax;
+    int                                     _frameLen;
+    int                                     _discardLen;  //!< Output to drop
 
     rtdgtreal_processor_callback *_callback;  //!< Custom processor callback
     void                         *_userdata;  //!< Callback data
+    pcm_dither_t                  _dither;    //!< Of integer PCM output
+
+    // Valid while the pipeline runs
+    rtdgtreal_processor_callback *_pipelineCallback;
+    bool                          _pipelineFlush;  //!< FTZ of the caller
 };
 
 #endif  // RTDGTREALPROC_P_H__
\ No newline at end of file
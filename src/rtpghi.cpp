@@ -12,8 +12,34 @@ void rtpghi_t::reset(const double** sinit) { _p->reset(sinit); }
 
 double rtpghi_t::get_stretch() const { return _p->get_stretch(); }
 
+size_t rtpghi_t::get_state_size() const { return _p->get_state_size(); }
+
+void rtpghi_t::save_state(void* buf) const { _p->save_state(buf); }
+
+void rtpghi_t::load_state(const void* buf) { _p->load_state(buf); }
+
 void rtpghi_t::set_tolerance(double tol) { _p->set_tolerance(tol); }
 
+void rtpghi_t::set_causal(bool causal) { _p->set_causal(causal); }
+
+bool rtpghi_t::get_causal() const { return _p->get_causal(); }
+
+void rtpghi_t::set_fractional_hop(bool fractional) {
+    _p->set_fractional_hop(fractional);
+}
+
+bool rtpghi_t::get_fractional_hop() const {
+    return _p->get_fractional_hop();
+}
+
+void rtpghi_t::set_channel_link(rtpghi_link_t link) {
+    _p->set_channel_link(link);
+}
+
+rtpghi_link_t rtpghi_t::get_channel_link() const {
+    return _p->get_channel_link();
+}
+
 void rtpghi_t::execute(const std::complex<double>* s, double stretch,
                        std::complex<double>* c) {
     _p->execute(s, stretch, c);
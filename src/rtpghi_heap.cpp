@@ -6,13 +6,17 @@ rtpghi_heap_t::rtpghi_heap_t(int initmaxsize, const double *s) : _s(s) {
 
 const double *rtpghi_heap_t::get_dataptr() const { return _s; }
 
-void rtpghi_heap_t::reset(const double *news) { _s = news; }
+void rtpghi_heap_t::reset(const double *news) {
+    // Keeps the capacity, so that push() never allocates.
+    _h.clear();
+    _s = news;
+}
 
 void rtpghi_heap_t::push(int key) {
     int pos, pos2;
 
     pos = _h.size();
-    _h.push_back(0);  // Let std::vector handle dynamic growth.
+    _h.push_back(0);  // Within the reserved size, see rtpghi_update_plan.
 
     double val = _s[key];
 
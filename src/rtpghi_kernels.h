@@ -0,0 +1,198 @@
+#ifndef RTPGHI_KERNELS_H__
+#define RTPGHI_KERNELS_H__
+
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <type_traits>
+
+#include "rtpghi_p.h"
+
+/**
+ * Per-frame RTPGHI kernels, shared by rtpghi_priv and pv_engine.
+ *
+ * The Size parameters are either int, or fixed_size_t<N> when the sizes are
+ * known at compile time; the arithmetic is the same in both cases, so the
+ * results are identical.
+ */
+
+template <int N>
+using fixed_size_t = std::integral_constant<int, N>;
+
+/** Number of coefficients of a real FFT of length M */
+inline int spectrum_size(int M) { return M / 2 + 1; }
+
+template <int M>
+inline fixed_size_t<M / 2 + 1> spectrum_size(fixed_size_t<M>) {
+    return {};
+}
+
+inline double princarg(double in) {
+    return (in - 2.0 * M_PI * std::round(in / (2.0 * M_PI)));
+}
+
+/**
+ * Shift N columns of height samples left by one column. The last column is
+ * left as it was, the callers overwrite it.
+ */
+template <typename Size>
+inline void shiftcolsleft(double *cols, Size height, int N) {
+    std::copy(cols + height, cols + N * height, cols);
+}
+
+template <typename Size>
+inline void rtpghi_abs(const std::complex<double> *in, Size height,
+                       double *out) {
+    for (int ii = 0; ii < height; ++ii) {
+        out[ii] = std::abs(in[ii]);
+    }
+}
+
+template <typename Size>
+inline void rtpghi_phase(const std::complex<double> *in, Size height,
+                         double *out) {
+    for (int ii = 0; ii < height; ++ii) {
+        out[ii] = std::arg(in[ii]);
+    }
+}
+
+/** Compute phase frequency gradient by differentiation in time */
+template <typename Size>
+inline void rtpghi_fgrad(const double *phase, Size M, double stretch,
+                         double *fgrad) {
+    const auto M2 = spectrum_size(M);
+
+    for (int m = 1; m < M2 - 1; ++m) {
+        fgrad[m] = (princarg(phase[m + 1] - phase[m]) +
+                    princarg(phase[m] - phase[m - 1])) /
+                   (2.0) * stretch;
+    }
+
+    fgrad[0] = phase[0] * stretch;
+    fgrad[M2 - 1] = phase[M2 - 1] * stretch;
+}
+
+/** Compute phase time gradient by differentiation in frequency */
+template <typename Size>
+inline void rtpghi_tgrad(const double *phase, double aanaprev,
+                         double aananext, Size M, double stretch,
+                         double *tgrad) {
+    const auto M2 = spectrum_size(M);
+    // a is asyn
+    double asyn = aanaprev * stretch;
+
+    double const1prev = 2.0 * M_PI * aanaprev / M;
+    double const1next = 2.0 * M_PI * aananext / M;
+    double const2 = 2.0 * M_PI * asyn / M;
+
+    const double *pcol0 = phase;
+    const double *pcol1 = phase + 1 * M2;
+    const double *pcol2 = phase + 2 * M2;
+
+    for (int m = 0; m < M2; ++m) {
+        tgrad[m] = asyn * (princarg(pcol2[m] - pcol1[m] - const1next * m) /
+                               (2.0 * aananext) +
+                           princarg(pcol1[m] - pcol0[m] - const1prev * m) /
+                               (2.0 * aanaprev)) +
+                   const2 * m;
+    }
+}
+
+/**
+ * Compute phase time gradient of the newest frame by backward differentiation
+ * in time, from the last analysis hop only.
+ */
+template <typename Size>
+inline void rtpghi_tgrad_causal(const double *phase, double aananext, Size M,
+                                double stretch, double *tgrad) {
+    const auto M2 = spectrum_size(M);
+    double     asyn = aananext * stretch;
+
+    double const1 = 2.0 * M_PI * aananext / M;
+    double const2 = 2.0 * M_PI * asyn / M;
+
+    const double *pcol1 = phase + 1 * M2;
+    const double *pcol2 = phase + 2 * M2;
+
+    for (int m = 0; m < M2; ++m) {
+        tgrad[m] = asyn * princarg(pcol2[m] - pcol1[m] - const1 * m) /
+                       aananext +
+                   const2 * m;
+    }
+}
+
+template <typename Size>
+inline void rtpghi_magphase(const double *s, const double *phase, Size L,
+                            std::complex<double> *c) {
+    for (int l = 0; l < L; ++l) {
+        c[l] = std::polar(s[l], phase[l]);
+    }
+}
+
+/**
+ * One channel of rtpghi_priv::execute(). The history columns are shifted
+ * left by one, the newest column is the last one.
+ *
+ * The default (centered) mode outputs the previous frame, whose time
+ * gradient is taken over the hops on both sides. The causal mode outputs the
+ * newest frame, with the time gradient of the hop before it; the magnitude
+ * and phase columns it works on are shifted by one.
+ *
+ * \param[in]      cin          Input coefficients, M/2+1
+ * \param[in,out]  sCol         Magnitude history, 3 columns
+ * \param[in,out]  tgradCol     Time gradient history, 2 columns
+ * \param[out]     fgradCol     Frequency gradient, 1 column
+ * \param[in,out]  phaseCol     Phase of the previous frame, then this one
+ * \param[in,out]  phaseinCol   Input phase history, 3 columns
+ * \param[in]      plan         Phase integration
+ * \param[in]      M            FFT length
+ * \param[in]      aanaprev     Analysis hop of the previous frame
+ * \param[in]      aananext     Analysis hop of this frame
+ * \param[in]      stretchprev  Stretch of the previous frame
+ * \param[in]      stretch      Stretch of this frame
+ * \param[in]      causal       Output this frame instead of the previous one
+ * \param[out]     cout         Output coefficients, M/2+1
+ */
+template <typename Size>
+inline void rtpghi_execute_channel(const std::complex<double> *cin,
+                                   double *sCol, double *tgradCol,
+                                   double *fgradCol, double *phaseCol,
+                                   double *phaseinCol, rtpghi_update_plan *plan,
+                                   Size M, double aanaprev, double aananext,
+                                   double stretchprev, double stretch,
+                                   bool causal, std::complex<double> *cout) {
+    const auto M2 = spectrum_size(M);
+    // Column of the output frame
+    const int  out = causal ? 2 : 1;
+
+    shiftcolsleft(sCol, M2, 3);
+    shiftcolsleft(tgradCol, M2, 2);
+    shiftcolsleft(phaseinCol, M2, 3);
+
+    rtpghi_abs(cin, M2, sCol + 2 * M2);
+    rtpghi_phase(cin, M2, phaseinCol + 2 * M2);
+
+    if (causal) {
+        rtpghi_tgrad_causal(phaseinCol, aananext, M, stretch, tgradCol + M2);
+    } else {
+        rtpghi_tgrad(phaseinCol, aanaprev, aananext, M, stretchprev,
+                     tgradCol + M2);
+    }
+
+    if (std::abs(stretch - 1.0) < 1e-4) {
+        // Bypass if no stretching is done
+        std::copy(phaseinCol + out * M2, phaseinCol + (out + 1) * M2,
+                  phaseCol);
+    } else {
+        rtpghi_fgrad(phaseinCol + out * M2, M, causal ? stretch : stretchprev,
+                     fgradCol);
+        plan->execute(sCol + (out - 1) * M2, tgradCol, fgradCol, phaseCol,
+                      phaseCol);
+    }
+
+    // Combine phase with amplitude
+    rtpghi_magphase(sCol + out * M2, phaseCol, M2, cout);
+}
+
+#endif  // RTPGHI_KERNELS_H__
@@ -2,52 +2,11 @@
 #include "rtpghi_p.h"
 
 #include <algorithm>
-#include <cmath>
-#include <complex>
 #include <cstdio>
 
 #include "rtpghi.h"
 #include "rtpghi_heap.h"
-
-static double princarg(double in) {
-    return (in - 2.0 * M_PI * std::round(in / (2.0 * M_PI)));
-}
-
-static void shiftcolsleft(double *cols, int height, int N,
-                          const double *newcol) {
-    // rotate left by 1*height is same as rotate left by 1 column
-    if (newcol) {
-        std::rotate(cols, cols + height, cols + (N - 1) * height);
-        std::copy(newcol, newcol + height, cols + (N - 1) * height);
-    } else {
-        std::rotate(cols, cols + height, cols + N * height);
-    }
-}
-
-static void rtpghi_abs(const std::complex<double> *in, int height,
-                       double *out) {
-    for (int ii = 0; ii < height; ++ii) {
-        out[ii] = std::abs(in[ii]);
-    }
-}
-
-static void rtpghi_phase(const std::complex<double> *in, int height,
-                         double *out) {
-    for (int ii = 0; ii < height; ++ii) {
-        out[ii] = std::arg(in[ii]);
-    }
-}
-
-/** Compute phase frequency gradient by differentiation in time */
-static void rtpghi_fgrad(const double *phase, int M, double stretch,
-                         double *fgrad);
-
-/** Compute phase time gradient by differentiation in frequency */
-static void rtpghi_tgrad(const double *phase, int aanaprev, int aananext, int M,
-                         double stretch, double *tgrad);
-
-static void rtpghi_magphase(const double *s, const double *phase, int L,
-                            std::complex<double> *c);
+#include "rtpghi_kernels.h"
 
 rtpghi_priv::rtpghi_priv(int W, int a, int M, double tol) {
     int M2;
@@ -60,16 +19,22 @@ rtpghi_priv::rtpghi_priv(int W, int a, int M, double tol) {
     M2 = M / 2 + 1;
 
     _p = new rtpghi_update_plan(M, W, tol);
-    _s.resize(3 * M2 * W);
-    _tgrad.resize(2 * M2 * W);
-    _fgrad.resize(1 * M2 * W);
-    _phase.resize(1 * M2 * W);
-    _phasein.resize(3 * M2 * W);
+    _s.resize(3 * M2 * (W + 1));
+    _tgrad.resize(2 * M2 * (W + 1));
+    _fgrad.resize(1 * M2 * (W + 1));
+    _phase.resize(1 * M2 * (W + 1));
+    _phasein.resize(3 * M2 * (W + 1));
+    _ref.resize(M2);
+    _cinhist.resize(W > 1 ? 2 * M2 * W : 0);
 
     _M = M;
     _a = a;
     _W = W;
     _stretch = 1.0;
+    _causal = false;
+    _fractionalHop = false;
+    _link = RTPGHI_LINK_NONE;
+    _linked = false;
 }
 
 rtpghi_priv::~rtpghi_priv() { delete _p; }
@@ -81,6 +46,20 @@ void rtpghi_priv::set_tolerance(double tol) {
     _p->_tol = tol;
 }
 
+void rtpghi_priv::set_causal(bool causal) { _causal = causal; }
+
+bool rtpghi_priv::get_causal() const { return _causal; }
+
+void rtpghi_priv::set_fractional_hop(bool fractional) {
+    _fractionalHop = fractional;
+}
+
+bool rtpghi_priv::get_fractional_hop() const { return _fractionalHop; }
+
+void rtpghi_priv::set_channel_link(rtpghi_link_t link) { _link = link; }
+
+rtpghi_link_t rtpghi_priv::get_channel_link() const { return _link; }
+
 void rtpghi_priv::reset(const double **sinit) {
     int M2 = _M / 2 + 1;
 
@@ -89,63 +68,230 @@ void rtpghi_priv::reset(const double **sinit) {
     std::fill(_fgrad.begin(), _fgrad.end(), 0);
     std::fill(_phase.begin(), _phase.end(), 0);
     std::fill(_phasein.begin(), _phasein.end(), 0);
+    std::fill(_ref.begin(), _ref.end(), 0);
+    std::fill(_cinhist.begin(), _cinhist.end(), 0);
+
+    _stretch = 1.0;
+    _linked = false;
+
+    // Same random phases as after construction
+    _p->reseed();
 
     if (sinit) {
+        double *sref = _s.data() + 3 * _W * M2;
+
         for (int w = 0; w < _W; ++w) {
             if (sinit[w]) {
                 std::copy(sinit[w], sinit[w] + 2 * M2, _s.begin() + 2 * w * M2);
+
+                // The largest magnitude for the reference
+                for (int m = 0; m < 2 * M2; ++m) {
+                    sref[m] = std::max(sref[m], sinit[w][m]);
+                }
             }
         }
     }
 }
 
+void rtpghi_priv::transfer_state(state_io_t *io) {
+    io->io(_s.data(), _s.size());
+    io->io(_tgrad.data(), _tgrad.size());
+    io->io(_fgrad.data(), _fgrad.size());
+    io->io(_phase.data(), _phase.size());
+    io->io(_phasein.data(), _phasein.size());
+    io->io(_ref.data(), _ref.size());
+    io->io(_cinhist.data(), _cinhist.size());
+    io->io(&_stretch);
+    io->io(&_linked);
+    io->io(&_p->_rand);
+    io->io(&_p->_dist);
+}
+
+size_t rtpghi_priv::get_state_size() {
+    state_io_t io(state_io_t::STATE_SIZE, nullptr);
+
+    transfer_state(&io);
+    return io.get_len();
+}
+
+void rtpghi_priv::save_state(void *buf) {
+    state_io_t io(state_io_t::STATE_SAVE, buf);
+
+    transfer_state(&io);
+}
+
+void rtpghi_priv::load_state(const void *buf) {
+    state_io_t io(state_io_t::STATE_LOAD, const_cast<void *>(buf));
+
+    transfer_state(&io);
+}
+
 void rtpghi_priv::execute(const std::complex<double> *cin, double stretch,
                           std::complex<double> *cout) {
     // n, n-1, n-2 frames
     // s is n-th
-    int M2, W, asyn, aanaprev, aananext;
+    int    M2, W, asyn;
+    double aanaprev, aananext;
 
     M2 = _M / 2 + 1;
     W = _W;
     asyn = _a;
-    aanaprev = std::round(asyn / _stretch);  // old stretch
-    aananext = std::round(asyn / stretch);   // new stretch
+    aanaprev = asyn / _stretch;  // old stretch
+    aananext = asyn / stretch;   // new stretch
 
-    for (int w = 0; w < W; ++w) {
-        double *sCol = _s.data() + 3 * w * M2;
-        double *tgradCol = _tgrad.data() + 2 * w * M2;
-        double *fgradCol = _fgrad.data() + 1 * w * M2;
-        double *phaseCol = _phase.data() + 1 * w * M2;
-        double *phaseinCol = _phasein.data() + 3 * w * M2;
+    // The analysis hops the processor actually used
+    if (!_fractionalHop) {
+        aanaprev = std::round(aanaprev);
+        aananext = std::round(aananext);
+    }
+
+    bool linked = _link != RTPGHI_LINK_NONE && W > 1;
+
+    if (linked && !_linked) link_state();
+    if (!linked && _linked) unlink_state();
+    _linked = linked;
+
+    if (linked) {
+        execute_linked(cin, aanaprev, aananext, stretch, cout);
+    } else {
+        for (int w = 0; w < W; ++w) {
+            rtpghi_execute_channel(
+                cin + w * M2, _s.data() + 3 * w * M2,
+                _tgrad.data() + 2 * w * M2, _fgrad.data() + 1 * w * M2,
+                _phase.data() + 1 * w * M2, _phasein.data() + 3 * w * M2, _p,
+                _M, aanaprev, aananext, _stretch, stretch, _causal,
+                cout + w * M2);
+        }
+    }
 
-        shiftcolsleft(sCol, M2, 3, nullptr);
-        shiftcolsleft(tgradCol, M2, 2, nullptr);
-        shiftcolsleft(phaseinCol, M2, 3, nullptr);
+    // Only update stretch for the next frame
+    _stretch = stretch;
+}
 
-        rtpghi_abs(cin + w * M2, M2, sCol + 2 * M2);
-        rtpghi_phase(cin + w * M2, M2, phaseinCol + 2 * M2);
+/**
+ * Reference spectrum of linked channels: their sum, or the coefficient of
+ * largest magnitude of each bin.
+ */
+static void link_channels(const std::complex<double> *cin, int M2, int W,
+                          rtpghi_link_t link, std::complex<double> *ref) {
+    std::copy(cin, cin + M2, ref);
 
-        rtpghi_tgrad(phaseinCol, aanaprev, aananext, _M, _stretch,
-                     tgradCol + M2);
+    for (int w = 1; w < W; ++w) {
+        const std::complex<double> *cchan = cin + w * M2;
 
-        if (std::abs(stretch - 1.0) < 1e-4) {
-            // Bypass if no stretching is done
-            std::copy(phaseinCol + M2, phaseinCol + 2 * M2, phaseCol);
+        if (link == RTPGHI_LINK_SUM) {
+            for (int m = 0; m < M2; ++m) ref[m] += cchan[m];
         } else {
-            rtpghi_fgrad(phaseinCol + M2, _M, _stretch, fgradCol);
-            _p->execute(sCol, tgradCol, fgradCol, phaseCol, phaseCol);
+            for (int m = 0; m < M2; ++m) {
+                if (std::norm(cchan[m]) > std::norm(ref[m])) ref[m] = cchan[m];
+            }
         }
+    }
+}
 
-        // Combine phase with amplitude
-        rtpghi_magphase(sCol + M2, phaseCol, M2, cout + w * M2);
+void rtpghi_priv::execute_linked(const std::complex<double> *cin,
+                                 double aanaprev, double aananext,
+                                 double stretch,
+                                 std::complex<double> *cout) {
+    int M2 = _M / 2 + 1;
+    int W = _W;
+    // Column of the output frame
+    int out = _causal ? 2 : 1;
+
+    const std::complex<double> *cinprev = _cinhist.data() + W * M2;
+    const std::complex<double> *cframe = _causal ? cin : cinprev;
+    const double               *phaseref = _phase.data() + W * M2;
+    const double *phaseinref = _phasein.data() + (3 * W + out) * M2;
+
+    link_channels(cin, M2, W, _link, _ref.data());
+    rtpghi_execute_channel(
+        _ref.data(), _s.data() + 3 * W * M2, _tgrad.data() + 2 * W * M2,
+        _fgrad.data() + 1 * W * M2, _phase.data() + 1 * W * M2,
+        _phasein.data() + 3 * W * M2, _p, _M, aanaprev, aananext, _stretch,
+        stretch, _causal, _ref.data());
+
+    // Rotate every channel by the phase change of the reference, which
+    // keeps their magnitudes and their phase offsets to it
+    for (int m = 0; m < M2; ++m) {
+        _ref[m] = std::polar(1.0, phaseref[m] - phaseinref[m]);
     }
 
-    // Only update stretch for the next frame
-    _stretch = stretch;
+    for (int w = 0; w < W; ++w) {
+        for (int m = 0; m < M2; ++m) {
+            cout[w * M2 + m] = cframe[w * M2 + m] * _ref[m];
+        }
+    }
+
+    std::copy(cinprev, cinprev + W * M2, _cinhist.begin());
+    std::copy(cin, cin + W * M2, _cinhist.begin() + W * M2);
+}
+
+void rtpghi_priv::link_state() {
+    int M2 = _M / 2 + 1;
+    int W = _W;
+    int out = _causal ? 2 : 1;
+
+    double *sref = _s.data() + 3 * W * M2;
+    double *phaseinref = _phasein.data() + 3 * W * M2;
+
+    // Input history of the channels (columns 1 and 2) and of the reference.
+    // Column 0 is only needed by the reference, it passes through the slot
+    // of column 2 first.
+    for (int c : {0, 2, 1}) {
+        std::complex<double> *hist = _cinhist.data() + (c == 1 ? 0 : W * M2);
+
+        for (int w = 0; w < W; ++w) {
+            rtpghi_magphase(_s.data() + (3 * w + c) * M2,
+                            _phasein.data() + (3 * w + c) * M2, M2,
+                            hist + w * M2);
+        }
+
+        link_channels(hist, M2, W, _link, _ref.data());
+        rtpghi_abs(_ref.data(), M2, sref + c * M2);
+        rtpghi_phase(_ref.data(), M2, phaseinref + c * M2);
+    }
+
+    // Continue the gradient and the phase of the first channel
+    std::copy(_tgrad.begin(), _tgrad.begin() + 2 * M2,
+              _tgrad.begin() + 2 * W * M2);
+
+    for (int m = 0; m < M2; ++m) {
+        _phase[W * M2 + m] =
+            _phase[m] + (phaseinref[out * M2 + m] - _phasein[out * M2 + m]);
+    }
+}
+
+void rtpghi_priv::unlink_state() {
+    int M2 = _M / 2 + 1;
+    int W = _W;
+
+    // Last output frame
+    const std::complex<double> *cframe =
+        _cinhist.data() + (_causal ? W * M2 : 0);
+
+    for (int w = 0; w < W; ++w) {
+        for (int c = 1; c < 3; ++c) {
+            const std::complex<double> *hist =
+                _cinhist.data() + ((c - 1) * W + w) * M2;
+
+            rtpghi_abs(hist, M2, _s.data() + (3 * w + c) * M2);
+            rtpghi_phase(hist, M2, _phasein.data() + (3 * w + c) * M2);
+        }
+
+        // Continue the gradient of the reference and the phase of the last
+        // output frame
+        std::copy(_tgrad.begin() + 2 * W * M2,
+                  _tgrad.begin() + 2 * (W + 1) * M2,
+                  _tgrad.begin() + 2 * w * M2);
+
+        for (int m = 0; m < M2; ++m) {
+            _phase[w * M2 + m] = std::arg(cframe[w * M2 + m] * _ref[m]);
+        }
+    }
 }
 
 rtpghi_update_plan::rtpghi_update_plan(int M, int W, double tol)
-    : _rand(_rd()), _dist(-2.0 * M_PI, 2.0 * M_PI) {
+    : _seed(_rd()), _rand(_seed), _dist(-2.0 * M_PI, 2.0 * M_PI) {
     int M2 = M / 2 + 1;
 
     _donemask.resize(M2);
@@ -265,48 +411,9 @@ void rtpghi_update_plan::execute_common(const double *s, const double *tgrad,
 
 double rtpghi_update_plan::random_phase() { return _dist(_rand); }
 
-static void rtpghi_fgrad(const double *phase, int M, double stretch,
-                         double *fgrad) {
-    int M2 = M / 2 + 1;
-
-    for (int m = 1; m < M2 - 1; ++m) {
-        fgrad[m] = (princarg(phase[m + 1] - phase[m]) +
-                    princarg(phase[m] - phase[m - 1])) /
-                   (2.0) * stretch;
-    }
-
-    fgrad[0] = phase[0] * stretch;
-    fgrad[M2 - 1] = phase[M2 - 1] * stretch;
-}
-
-static void rtpghi_tgrad(const double *phase, int aanaprev, int aananext, int M,
-                         double stretch, double *tgrad) {
-    int M2 = M / 2 + 1;
-    // a is asyn
-    double asyn = aanaprev * stretch;
-
-    double const1prev = 2.0 * M_PI * ((double)aanaprev) / M;
-    double const1next = 2.0 * M_PI * ((double)aananext) / M;
-    double const2 = 2.0 * M_PI * asyn / M;
-
-    const double *pcol0 = phase;
-    const double *pcol1 = phase + 1 * M2;
-    const double *pcol2 = phase + 2 * M2;
-
-    for (int m = 0; m < M2; ++m) {
-        tgrad[m] = asyn * (princarg(pcol2[m] - pcol1[m] - const1next * m) /
-                               (2.0 * aananext) -
-                           princarg(pcol1[m] - pcol0[m] - const1prev * m) /
-                               (2.0 * aanaprev)) +
-                   const2 * m;
-    }
-}
-
-static void rtpghi_magphase(const double *s, const double *phase, int L,
-                            std::complex<double> *c) {
-    for (int l = 0; l < L; ++l) {
-        c[l] = std::polar(s[l], phase[l]);
-    }
+void rtpghi_update_plan::reseed() {
+    _rand.seed(_seed);
+    _dist.reset();
 }
 
 #ifndef NDEBUG
@@ -7,6 +7,9 @@
 #include <random>
 #include <vector>
 
+#include "rtpghi.h"
+#include "statebuf.h"
+
 class rtpghi_update_plan;
 class rtpghi_heap_t;
 
@@ -17,23 +20,54 @@ class rtpghi_priv final {
 
     double get_stretch() const;
     void   set_tolerance(double tol);
+    void   set_causal(bool causal);
+    bool   get_causal() const;
+    void   set_fractional_hop(bool fractional);
+    bool   get_fractional_hop() const;
+
+    void          set_channel_link(rtpghi_link_t link);
+    rtpghi_link_t get_channel_link() const;
 
     void reset(const double **sinit);
 
     void execute(const std::complex<double> *cin, double stretch,
                  std::complex<double> *cout);
 
+    size_t get_state_size();
+    void   save_state(void *buf);
+    void   load_state(const void *buf);
+
    private:
-    rtpghi_update_plan *_p;
-    int                 _M;
-    int                 _a;
-    int                 _W;
-    std::vector<double> _s;
-    std::vector<double> _tgrad;  //!< Time gradient buffer
-    std::vector<double> _fgrad;  //!< Frequency gradient buffer
-    std::vector<double> _phase;
-    std::vector<double> _phasein;
-    double              _stretch;
+    void transfer_state(state_io_t *io);
+
+    void execute_linked(const std::complex<double> *cin, double aanaprev,
+                        double aananext, double stretch,
+                        std::complex<double> *cout);
+
+    /** Take the state of the reference from the one of the channels */
+    void link_state();
+
+    /** Take the state of the channels from the one of the reference */
+    void unlink_state();
+
+    // The buffers have W + 1 channels, the last one is the reference of
+    // linked channels
+    rtpghi_update_plan               *_p;
+    int                               _M;
+    int                               _a;
+    int                               _W;
+    std::vector<double>               _s;
+    std::vector<double>               _tgrad;  //!< Time gradient buffer
+    std::vector<double>               _fgrad;  //!< Frequency gradient buffer
+    std::vector<double>               _phase;
+    std::vector<double>               _phasein;
+    std::vector<std::complex<double>> _ref;      //!< Reference coefficients
+    std::vector<std::complex<double>> _cinhist;  //!< Last 2 input frames
+    double                            _stretch;
+    bool                              _causal;
+    bool                              _fractionalHop;
+    rtpghi_link_t                     _link;
+    bool                              _linked;  //!< Last frame was linked
 };
 
 class rtpghi_update_plan {
@@ -47,6 +81,11 @@ class rtpghi_update_plan {
     void execute(const double *s, const double *tgrad, const double *fgrad,
                  const double *startphase, double *phase);
 
+    /**
+     * Restart the random phases from the seed drawn at construction.
+     */
+    void reseed();
+
    private:
     void execute_common(const double *s, const double *tgrad,
                         const double *fgrad, const double *startphase,
@@ -55,6 +94,7 @@ class rtpghi_update_plan {
     double random_phase();
 
     std::random_device               _rd;
+    std::mt19937::result_type        _seed;
     std::mt19937                     _rand;
     std::uniform_real_distribution<> _dist;
 
@@ -0,0 +1,142 @@
+#include "rtpghi_trace_p.h"
+
+#ifdef RTPGHI_TRACE
+    #include <atomic>
+    #include <bit>
+    #include <chrono>
+    #include <cstdio>
+
+/**
+ * Maximum number of threads traced at once, the others are not recorded
+ * until a ring is given back
+ */
+static constexpr int TRACE_THREADS = 16;
+static_assert(TRACE_THREADS <= 32, "one bit per ring in g_usedRings");
+
+/** Events kept per thread, a power of two */
+static constexpr uint64_t TRACE_EVENTS = 1 << 14;
+
+struct trace_event_t {
+    const char *name;
+    uint64_t    ts;
+    uint64_t    dur;
+    long long   arg;
+    char        phase;
+};
+
+/**
+ * Single-producer ring: only the owning thread writes, count is published
+ * with release semantics after each event.
+ */
+struct alignas(64) trace_ring_t {
+    std::atomic<uint64_t> count;
+    trace_event_t         events[TRACE_EVENTS];
+};
+
+// Preallocated so that recording never allocates.
+static trace_ring_t          g_rings[TRACE_THREADS];
+static std::atomic<uint32_t> g_usedRings{0};  // Bit t: ring t has an owner
+static std::atomic<int>      g_numRings{0};   // Rings ever used
+static thread_local int      t_ring = -1;
+static const auto            g_epoch = std::chrono::steady_clock::now();
+
+/**
+ * Take the first free ring, -1 if there is none.
+ */
+static int acquire_ring() {
+    uint32_t used = g_usedRings.load(std::memory_order_relaxed);
+    int      ring;
+
+    do {
+        ring = std::countr_one(used);
+        if (ring >= TRACE_THREADS) return -1;
+    } while (!g_usedRings.compare_exchange_weak(used, used | (1u << ring),
+                                                std::memory_order_acquire,
+                                                std::memory_order_relaxed));
+
+    // Rings up to g_numRings are dumped
+    int num = g_numRings.load(std::memory_order_relaxed);
+    while (num <= ring) {
+        if (g_numRings.compare_exchange_weak(num, ring + 1,
+                                             std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    return ring;
+}
+
+uint64_t rtpghi_trace_now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - g_epoch)
+        .count();
+}
+
+void rtpghi_trace_record(const char *name, char phase, uint64_t ts,
+                         uint64_t dur, long long arg) {
+    if (t_ring == -1) t_ring = acquire_ring();
+    if (t_ring == -1) return;
+
+    trace_ring_t &r = g_rings[t_ring];
+    uint64_t      n = r.count.load(std::memory_order_relaxed);
+
+    r.events[n % TRACE_EVENTS] = trace_event_t{name, ts, dur, arg, phase};
+    r.count.store(n + 1, std::memory_order_release);
+}
+
+void rtpghi_trace_thread_exit() {
+    if (t_ring == -1) return;
+
+    // The events stay, the next owner appends to them
+    g_usedRings.fetch_and(~(1u << t_ring), std::memory_order_release);
+    t_ring = -1;
+}
+
+bool rtpghi_trace_enabled() { return true; }
+
+void rtpghi_trace_clear() {
+    for (auto &r : g_rings) r.count.store(0, std::memory_order_relaxed);
+}
+
+bool rtpghi_trace_dump(const char *path) {
+    FILE *f = fopen(path, "w");
+    bool  first = true;
+
+    if (!f) return false;
+
+    int numRings = g_numRings.load(std::memory_order_relaxed);
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    for (int t = 0; t < numRings; ++t) {
+        const trace_ring_t &r = g_rings[t];
+        uint64_t            end = r.count.load(std::memory_order_acquire);
+        uint64_t            begin = end > TRACE_EVENTS ? end - TRACE_EVENTS : 0;
+
+        for (uint64_t n = begin; n < end; ++n) {
+            const trace_event_t &e = r.events[n % TRACE_EVENTS];
+
+            fprintf(f, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,",
+                    first ? "" : ",", e.name, e.phase, e.ts * 1e-3);
+            if (e.phase == 'X') {
+                fprintf(f, "\"dur\":%.3f,", e.dur * 1e-3);
+            } else {
+                fprintf(f, "\"s\":\"t\",");
+            }
+            fprintf(f, "\"pid\":1,\"tid\":%d,\"args\":{\"n\":%lld}}", t,
+                    e.arg);
+            first = false;
+        }
+    }
+
+    fprintf(f, "\n]}\n");
+
+    return fclose(f) == 0;
+}
+#else
+bool rtpghi_trace_enabled() { return false; }
+
+void rtpghi_trace_clear() {}
+
+bool rtpghi_trace_dump(const char *) { return false; }
+#endif
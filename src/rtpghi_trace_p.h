@@ -0,0 +1,64 @@
+#ifndef RTPGHI_TRACE_P_H__
+#define RTPGHI_TRACE_P_H__
+
+#include "rtpghi_trace.h"
+
+#ifdef RTPGHI_TRACE
+    #include <cstdint>
+
+uint64_t rtpghi_trace_now();
+
+/**
+ * Record an event in the ring of the calling thread. Never blocks or
+ * allocates; the event is dropped if the thread has no ring.
+ *
+ * \param[in]  name   Event name, must be a string literal
+ * \param[in]  phase  Chrome trace phase, 'X' (complete) or 'i' (instant)
+ * \param[in]  ts     Start time in ns, see rtpghi_trace_now()
+ * \param[in]  dur    Duration in ns
+ * \param[in]  arg    Event argument
+ */
+void rtpghi_trace_record(const char *name, char phase, uint64_t ts,
+                         uint64_t dur, long long arg);
+
+/**
+ * Give the ring of the calling thread back, so that a thread created later
+ * can use it. Called by the threads of the library before they exit.
+ */
+void rtpghi_trace_thread_exit();
+
+/**
+ * Records the lifetime of the object as a complete event.
+ */
+class rtpghi_trace_scope_t final {
+   public:
+    rtpghi_trace_scope_t(const char *name, long long arg)
+        : _name(name), _arg(arg), _start(rtpghi_trace_now()) {}
+
+    ~rtpghi_trace_scope_t() {
+        rtpghi_trace_record(_name, 'X', _start, rtpghi_trace_now() - _start,
+                            _arg);
+    }
+
+   private:
+    const char *_name;
+    long long   _arg;
+    uint64_t    _start;
+};
+
+    #define RTPGHI_TRACE_CAT2(a, b) a##b
+    #define RTPGHI_TRACE_CAT(a, b) RTPGHI_TRACE_CAT2(a, b)
+
+    #define RTPGHI_TRACE_SCOPE(name, arg) \
+        rtpghi_trace_scope_t RTPGHI_TRACE_CAT(rtpghi_trace_scope_, \
+                                              __LINE__)(name, arg)
+    #define RTPGHI_TRACE_INSTANT(name, arg) \
+        rtpghi_trace_record(name, 'i', rtpghi_trace_now(), 0, arg)
+    #define RTPGHI_TRACE_THREAD_EXIT() rtpghi_trace_thread_exit()
+#else
+    #define RTPGHI_TRACE_SCOPE(name, arg)
+    #define RTPGHI_TRACE_INSTANT(name, arg)
+    #define RTPGHI_TRACE_THREAD_EXIT()
+#endif
+
+#endif  // RTPGHI_TRACE_P_H__
@@ -0,0 +1,62 @@
+#ifndef STATEBUF_H__
+#define STATEBUF_H__
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Sequential transfer of the state of an object to or from a snapshot
+ * buffer. The object lists its members once, in a transfer_state()
+ * function, and the same function measures, saves and loads the snapshot
+ * depending on the mode, so that the three cannot disagree.
+ *
+ * The values are copied as they are in memory: a snapshot can only be
+ * loaded by the same build, into an object of the same configuration.
+ */
+class state_io_t final {
+   public:
+    enum mode_t {
+        STATE_SIZE,  //!< Only count the bytes
+        STATE_SAVE,  //!< Copy the values to the buffer
+        STATE_LOAD   //!< Copy the values from the buffer
+    };
+
+    state_io_t(mode_t mode, void *buf)
+        : _mode(mode), _buf(static_cast<unsigned char *>(buf)), _len(0) {}
+
+    template <typename T>
+    void io(T *v, size_t n) {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "only plain values can be transferred");
+
+        // Empty members may have no storage, which memcpy() does not take
+        if (n == 0) return;
+        if (_mode == STATE_SAVE) std::memcpy(_buf + _len, v, n * sizeof(T));
+        if (_mode == STATE_LOAD) std::memcpy(v, _buf + _len, n * sizeof(T));
+        _len += n * sizeof(T);
+    }
+
+    template <typename T>
+    void io(T *v) {
+        io(v, 1);
+    }
+
+    mode_t get_mode() const { return _mode; }
+
+    /** Buffer at the current position, null when only counting */
+    unsigned char *cur() const { return _buf ? _buf + _len : nullptr; }
+
+    /** Skip len bytes, transferred by other means */
+    void skip(size_t len) { _len += len; }
+
+    /** Bytes transferred so far */
+    size_t get_len() const { return _len; }
+
+   private:
+    mode_t         _mode;
+    unsigned char *_buf;
+    size_t         _len;
+};
+
+#endif  // STATEBUF_H__
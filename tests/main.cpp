@@ -10,18 +10,32 @@
 #define DEFAULT_RATIO 0.5
 #define MAX_RATIO 10
 #define BUFFER_LEN 1024
-#define INOUT_BUFFER_LEN (BUFFER_LEN * MAX_RATIO)
 #define MAX_CHANNELS 1
 
+struct input_t {
+    SNDFILE *file;
+    bool     eof;
+};
+
+/**
+ * Reader of pv_t::pull(), reads straight into the analysis FIFO.
+ */
+static int read_input(void *userdata, double *buf[], int len, int chan) {
+    auto *in = static_cast<input_t *>(userdata);
+
+    // Mono only, so the channel is the interleaved buffer
+    int readcount = (int)sf_read_double(in->file, buf[0], len);
+    if (readcount < len) in->eof = true;
+
+    return readcount;
+}
+
 int main(int argc, char **argv) {
-    static double indata[INOUT_BUFFER_LEN];
-    static double outdata[INOUT_BUFFER_LEN];
+    static double outdata[BUFFER_LEN];
 
     SNDFILE *infile, *outfile;
 
     SF_INFO sfinfo;
-    int     readcount;
-    int     writecount;
 
     char  *end{};
     double ratio = (argc >= 2 ? std::strtod(argv[1], &end) : DEFAULT_RATIO);
@@ -29,8 +43,8 @@ int main(int argc, char **argv) {
         ratio = DEFAULT_RATIO;
     }
 
-    const char *infilename = (argc >= 3 ? argv[1] : "input.wav");
-    const char *outfilename = (argc >= 4 ? argv[2] : "output.wav");
+    const char *infilename = (argc >= 3 ? argv[2] : "input.wav");
+    const char *outfilename = (argc >= 4 ? argv[3] : "output.wav");
 
     printf("ratio:%.2f, infile:%s, outfile%s\n", ratio, infilename,
            outfilename);
@@ -61,17 +75,17 @@ int main(int argc, char **argv) {
 
     pv_t pv(MAX_RATIO, Wmax, bufLenMax);
 
+    input_t input{infile, false};
+    double *out[MAX_CHANNELS] = {outdata};
+
     do {
         int outlen = BUFFER_LEN;
-        int inlen = pv.next_inlen(outlen);
         int channels = sfinfo.channels;
 
-        readcount = (int)sf_read_double(infile, indata, inlen);
-
-        pv.execute_compact(indata, readcount, channels, ratio, outlen, outdata);
+        pv.pull(out, outlen, channels, ratio, read_input, &input);
 
         sf_write_double(outfile, outdata, outlen);
-    } while (readcount != 0);
+    } while (!input.eof);
 
     sf_close(infile);
     sf_close(outfile);
@@ -0,0 +1,108 @@
+#include <sndfile.h>
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "pipeline.h"
+
+#define SAMPLERATE 44100
+#define CHANNELS 2
+
+/**
+ * Write a float WAV file of frames frames of a tone.
+ */
+static bool write_input(const char *path, int frames) {
+    SF_INFO info = {};
+
+    info.samplerate = SAMPLERATE;
+    info.channels = CHANNELS;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+
+    SNDFILE *file = sf_open(path, SFM_WRITE, &info);
+    if (!file) return false;
+
+    std::vector<double> data(frames * CHANNELS);
+    for (int n = 0; n < frames; ++n) {
+        for (int w = 0; w < CHANNELS; ++w) {
+            data[n * CHANNELS + w] =
+                0.3 * std::sin(2 * M_PI * 440 * (w + 1) * n / SAMPLERATE);
+        }
+    }
+
+    sf_writef_double(file, data.data(), frames);
+    sf_close(file);
+    return true;
+}
+
+static long long file_frames(const char *path) {
+    SF_INFO  info = {};
+    SNDFILE *file = sf_open(path, SFM_READ, &info);
+
+    if (!file) return -1;
+    sf_close(file);
+    return info.frames;
+}
+
+/**
+ * Checks that every pipeline mode outputs round(frames * stretch) frames,
+ * for inputs from a single frame to several blocks, including inputs
+ * shorter than the processing latency.
+ *
+ * Usage: pipelinecheck [directory for the temporary files]
+ */
+int main(int argc, char **argv) {
+    std::string dir = argc > 1 ? argv[1] : ".";
+    std::string inPath = dir + "/pipelinecheck_in.wav";
+    std::string outPath = dir + "/pipelinecheck_out.wav";
+
+    const char *modes[] = {"threaded", "mapped", "serial"};
+    int         runs = 0, failed = 0;
+
+    for (int frames : {1, 100, 1000, 1500, 2500, 20000}) {
+        if (!write_input(inPath.c_str(), frames)) {
+            fprintf(stderr, "Cannot write %s\n", inPath.c_str());
+            return 1;
+        }
+
+        for (double stretch : {0.5, 1.0, 1.5, 2.0}) {
+            for (int mode = 0; mode < 3; ++mode) {
+                pipeline_opts_t  opts;
+                pipeline_stats_t stats;
+                pv_cache_t       cache;
+                bool             ok;
+
+                opts.stretch = stretch;
+                opts.mmapInput = mode == 1;
+
+                if (mode == 2) {
+                    ok = pipeline_run_serial(inPath.c_str(), outPath.c_str(),
+                                             opts, &cache, &stats);
+                } else {
+                    ok = pipeline_run(inPath.c_str(), outPath.c_str(), opts,
+                                      &stats);
+                }
+
+                long long expected = std::llround(frames * stretch);
+                long long written = file_frames(outPath.c_str());
+
+                ++runs;
+                if (!ok || stats.outFrames != expected ||
+                    written != expected) {
+                    printf("FAIL %-8s %6d frames, stretch %.2f: %lld frames "
+                           "out, %lld in the file, expected %lld\n",
+                           modes[mode], frames, stretch, stats.outFrames,
+                           written, expected);
+                    ++failed;
+                }
+            }
+        }
+    }
+
+    std::remove(inPath.c_str());
+    std::remove(outPath.c_str());
+
+    printf("%d of %d runs failed\n", failed, runs);
+    return failed > 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * Real-time safety audit of the processing path.
+ *
+ * Interposes the allocator, pthread mutexes and write(), then runs every
+ * pv_t processing entry point over a sweep of channel counts, block sizes
+ * and stretch changes. Any of those calls made by the library after
+ * construction is reported with its call stack, and makes the program exit
+ * with a failure status.
+ *
+ * Glibc only, and not usable together with AddressSanitizer, which also
+ * replaces the allocator.
+ */
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "pv.h"
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void  __libc_free(void *ptr);
+}
+
+static thread_local bool t_armed = false;      //!< Inside the audited path
+static thread_local bool t_reporting = false;  //!< Inside report()
+static std::atomic<int>  g_violations{0};
+
+/**
+ * printf to stderr through the raw syscall, bypassing the interposers.
+ */
+static void raw_printf(const char *fmt, ...) {
+    char    buf[256];
+    va_list args;
+
+    va_start(args, fmt);
+    int len = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    if (len > (int)sizeof(buf) - 1) len = sizeof(buf) - 1;
+    if (len > 0) syscall(SYS_write, 2, buf, len);
+}
+
+static void report(const char *call) {
+    if (!t_armed || t_reporting) return;
+
+    t_reporting = true;
+    ++g_violations;
+
+    void *frames[32];
+    int   numFrames = backtrace(frames, 32);
+
+    raw_printf("\nVIOLATION: %s called from the processing path\n", call);
+    backtrace_symbols_fd(frames, numFrames, 2);
+
+    t_reporting = false;
+}
+
+extern "C" {
+void *malloc(size_t size) {
+    report("malloc");
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+    report("calloc");
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    report("realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    report("memalign");
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    report("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+    report("posix_memalign");
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr ? 0 : ENOMEM;
+}
+
+void free(void *ptr) {
+    if (ptr) report("free");
+    __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex) {
+    using fn_t = int(pthread_mutex_t *);
+    static fn_t *real = (fn_t *)dlsym(RTLD_NEXT, "pthread_mutex_lock");
+
+    report("pthread_mutex_lock");
+    return real(mutex);
+}
+
+int pthread_mutex_trylock(pthread_mutex_t *mutex) {
+    using fn_t = int(pthread_mutex_t *);
+    static fn_t *real = (fn_t *)dlsym(RTLD_NEXT, "pthread_mutex_trylock");
+
+    report("pthread_mutex_trylock");
+    return real(mutex);
+}
+
+ssize_t write(int fd, const void *buf, size_t count) {
+    report("write");
+    return syscall(SYS_write, fd, buf, count);
+}
+}
+
+struct audit_config_t {
+    int    chans;    //!< Number of channels processed
+    int    Wmax;     //!< Channels pv_t was created for
+    int    block;    //!< Output block length
+    double stretch;  //!< Initial stretch
+};
+
+static int read_silence(void *, double *buf[], int len, int chan) {
+    for (int w = 0; w < chan; ++w) std::fill(buf[w], buf[w] + len, 0.1);
+    return len;
+}
+
+/**
+ * Run all entry points on one configuration, returns the violation count.
+ */
+static int audit(const audit_config_t &cfg) {
+    const int    iterations = 64;
+    const double stretchMax = 2.0;
+    const int    bufLenMax = (int)std::ceil(cfg.block * stretchMax) + 1;
+
+    // Everything allocated up front, as a real-time host would.
+    pv_t pv(stretchMax, cfg.Wmax, bufLenMax);
+
+    std::vector<double>         inbuf(cfg.chans * bufLenMax);
+    std::vector<double>         outbuf(cfg.chans * cfg.block);
+    std::vector<short>          pcmbuf(cfg.chans * bufLenMax);
+    std::vector<short>          pcmoutbuf(cfg.chans * cfg.block);
+    std::vector<const double *> in(cfg.chans);
+    std::vector<double *>       out(cfg.chans);
+    std::vector<const short *>  pcmin(cfg.chans);
+    std::vector<short *>        pcmout(cfg.chans);
+    std::vector<unsigned char>  snapshot(pv.get_state_size());
+
+    for (int w = 0; w < cfg.chans; ++w) {
+        in[w] = &inbuf[w * bufLenMax];
+        out[w] = &outbuf[w * cfg.block];
+        pcmin[w] = &pcmbuf[w * bufLenMax];
+        pcmout[w] = &pcmoutbuf[w * cfg.block];
+    }
+    for (size_t ii = 0; ii < inbuf.size(); ++ii) {
+        inbuf[ii] = std::sin(0.05 * ii);
+        pcmbuf[ii] = (short)(16000 * inbuf[ii]);
+    }
+
+    int before = g_violations;
+
+    t_armed = true;
+
+    for (int it = 0; it < iterations; ++it) {
+        // Stretch changes every block, in [0.5, 2]
+        double stretch = cfg.stretch * std::pow(2.0, std::sin(0.3 * it));
+        stretch = std::fmin(std::fmax(stretch, 0.5), stretchMax);
+
+        // pull() leaves the input/output bookkeeping of next_inlen() off
+        int Lin = std::clamp((int)pv.next_inlen(cfg.block), 0, bufLenMax);
+
+        switch (it % 5) {
+            case 0:
+                pv.execute(in.data(), Lin, cfg.chans, stretch, cfg.block,
+                           out.data());
+                break;
+            case 1:
+                pv.execute_compact(inbuf.data(), Lin, cfg.chans, stretch,
+                                   cfg.block, outbuf.data());
+                break;
+            case 2:
+                pv.execute_interleaved(pcmbuf.data(), PCM_S16, Lin, cfg.chans,
+                                       stretch, cfg.block, out.data());
+                break;
+            case 3:
+                pv.pull(out.data(), cfg.block, cfg.chans, stretch,
+                        read_silence, nullptr);
+                break;
+            case 4:
+                pv.execute(pcmin.data(), Lin, cfg.chans, stretch, cfg.block,
+                           pcmout.data());
+                break;
+        }
+
+        // A new stream on the same instance halfway, a seek and a jump
+        // back to a snapshot
+        if (it == iterations / 4) pv.save_state(snapshot.data());
+        if (it == iterations / 2) pv.reset();
+        if (it == iterations / 2 + 8) {
+            pv.seek(read_silence, nullptr, cfg.chans, stretch);
+        }
+        if (it == 3 * iterations / 4) pv.load_state(snapshot.data());
+    }
+
+    t_armed = false;
+
+    return g_violations - before;
+}
+
+int main() {
+    const int    chans[] = {1, 2, 3};
+    const int    blocks[] = {32, 256, 1000, 4096};
+    const double stretches[] = {0.7, 1.0, 1.6};
+
+    int failed = 0;
+    int total = 0;
+
+    // The first backtrace() loads the unwinder, do it outside the audit.
+    void *frame;
+    backtrace(&frame, 1);
+
+    for (int W : chans) {
+        for (int block : blocks) {
+            for (double stretch : stretches) {
+                // Also process less channels than pv_t was created for
+                for (int Wmax : {W, W + 1}) {
+                    audit_config_t cfg{W, Wmax, block, stretch};
+                    int            violations = audit(cfg);
+
+                    printf("chans %d/%d, block %4d, stretch %.1f: %s\n", W,
+                           Wmax, block, stretch, violations ? "FAIL" : "ok");
+
+                    failed += violations > 0;
+                    ++total;
+                }
+            }
+        }
+    }
+
+    printf("%d of %d configurations failed, %d violations\n", failed, total,
+           g_violations.load());
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "pv.h"
+
+#define BLOCK 256
+#define STRETCH 1.3
+
+struct tone_t {
+    long long pos;
+};
+
+static int read_tone(void *userdata, double *buf[], int len, int chan) {
+    tone_t *src = static_cast<tone_t *>(userdata);
+
+    for (int ii = 0; ii < len; ++ii, ++src->pos) {
+        for (int w = 0; w < chan; ++w) {
+            buf[w][ii] = 0.3 * std::sin(0.05 * (w + 1) * src->pos);
+        }
+    }
+    return len;
+}
+
+/**
+ * Pull blocks blocks of every channel into out.
+ */
+static void run(pv_t *pv, int chan, tone_t *src, int blocks,
+                std::vector<double> *out) {
+    std::vector<double> buf(chan * BLOCK);
+    double             *bufs[2] = {buf.data(), buf.data() + BLOCK};
+
+    out->clear();
+    for (int b = 0; b < blocks; ++b) {
+        pv->pull(bufs, BLOCK, chan, STRETCH, read_tone, src);
+        out->insert(out->end(), buf.begin(), buf.end());
+    }
+}
+
+/**
+ * Whether load_state() refuses snapshot and leaves pv unchanged.
+ */
+static bool refused(pv_t *pv, const std::vector<unsigned char> &snapshot) {
+    std::vector<unsigned char> before(pv->get_state_size());
+    std::vector<unsigned char> after(pv->get_state_size());
+
+    pv->save_state(before.data());
+    if (pv->load_state(snapshot.data())) return false;
+    pv->save_state(after.data());
+    return before == after;
+}
+
+/**
+ * Checks that pv_t::load_state() refuses snapshots of an instance with
+ * another number of channels and buffers that are not snapshots, without
+ * touching the instance, and that a matching snapshot replays the same
+ * output.
+ */
+int main() {
+    pv_t mono(2.0, 1, BLOCK);
+    pv_t stereo(2.0, 2, BLOCK);
+
+    tone_t              monoSrc = {0}, src = {0};
+    std::vector<double> out, replay;
+    int                 failed = 0;
+
+    std::vector<unsigned char> monoSnapshot(mono.get_state_size());
+    std::vector<unsigned char> snapshot(stereo.get_state_size());
+    std::vector<unsigned char> garbage(stereo.get_state_size(), 0x5a);
+
+    run(&mono, 1, &monoSrc, 20, &out);
+    mono.save_state(monoSnapshot.data());
+    run(&stereo, 2, &src, 20, &out);
+
+    // The mono snapshot is the shorter one, only its header may be read
+    if (!refused(&stereo, monoSnapshot)) {
+        printf("FAIL loaded the snapshot of a mono instance\n");
+        ++failed;
+    }
+    if (!refused(&mono, snapshot)) {
+        printf("FAIL loaded the snapshot of a stereo instance\n");
+        ++failed;
+    }
+    if (!refused(&stereo, garbage)) {
+        printf("FAIL loaded a buffer without a snapshot header\n");
+        ++failed;
+    }
+
+    stereo.save_state(snapshot.data());
+    tone_t saved = src;
+    run(&stereo, 2, &src, 20, &out);
+
+    src = saved;
+    if (!stereo.load_state(snapshot.data())) {
+        printf("FAIL refused its own snapshot\n");
+        ++failed;
+    }
+    run(&stereo, 2, &src, 20, &replay);
+    if (out != replay) {
+        printf("FAIL the output after load_state() differs\n");
+        ++failed;
+    }
+
+    printf("%d checks failed\n", failed);
+    return failed > 0;
+}